@@ -0,0 +1,171 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <memory/page.h>
+
+#include "acpi.h"
+
+#define ACPI_RSDP_SIGNATURE "RSD PTR "
+#define ACPI_XSDT_SIGNATURE "XSDT"
+#define ACPI_RSDT_SIGNATURE "RSDT"
+
+/** Size of the RSDP of ACPI 1.0, which covers the fields up to `rsdt_address`. */
+#define ACPI_RSDP_VERSION1_LENGTH (20)
+
+/**
+ * Root System Description Pointer.
+ *
+ * @see Section 5.2.5.3, ACPI Specification
+ */
+struct acpi_rsdp {
+    char     signature[8];
+    uint8_t  checksum;
+    char     oem_id[6];
+    /** 0 for ACPI 1.0, 2 for ACPI 2.0 and later. */
+    uint8_t  revision;
+    uint32_t rsdt_address;
+    /** Fields below are only present from ACPI 2.0. */
+    uint32_t length;
+    uint64_t xsdt_address;
+    uint8_t  extended_checksum;
+    uint8_t  reserved[3];
+} __attribute__((packed));
+
+struct acpi_data {
+    const struct acpi_table_header *root;
+    /** Entries of the XSDT are 64-bit addresses, those of the RSDT are 32-bit. */
+    uint64_t entry_size;
+};
+
+static struct acpi_data global_acpi_data;
+
+static bool is_checksum_valid(const void *const table, uint64_t length)
+{
+    const uint8_t *const bytes = table;
+    uint8_t sum = 0;
+
+    for (uint64_t i = 0; i < length; ++i) {
+        sum += bytes[i];
+    }
+
+    return sum == 0;
+}
+
+static bool is_signature_equal(const char *const a, const char *const b, uint64_t length)
+{
+    for (uint64_t i = 0; i < length; ++i) {
+        if (a[i] != b[i]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Map the pages of `size` bytes from `address` identically.
+ *
+ * The kernel map only covers the RAM, and the firmware may put the tables anywhere.
+ */
+static int map_table(address_t address, uint64_t size)
+{
+    struct page_data page_data = page_get_loaded();
+
+    const address_t start = address & ~(PAGE_SIZE - 1);
+    for (address_t page = start; page < address + size; page += PAGE_SIZE) {
+        if (page_map(&page_data, page, page) != 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/** Map the table at `address` and check its checksum. */
+static const struct acpi_table_header *get_table(address_t address)
+{
+    if (map_table(address, sizeof(struct acpi_table_header)) != 0) {
+        return NULL;
+    }
+
+    const struct acpi_table_header *const table = (const struct acpi_table_header *)address;
+    if (map_table(address, table->length) != 0) {
+        return NULL;
+    }
+
+    if (!is_checksum_valid(table, table->length)) {
+        return NULL;
+    }
+
+    return table;
+}
+
+int acpi_initialize(address_t rsdp_address)
+{
+    global_acpi_data.root = NULL;
+    global_acpi_data.entry_size = 0;
+
+    if (rsdp_address == 0) {
+        return -1;
+    }
+
+    if (map_table(rsdp_address, sizeof(struct acpi_rsdp)) != 0) {
+        return -3;
+    }
+
+    const struct acpi_rsdp *const rsdp = (const struct acpi_rsdp *)rsdp_address;
+    if (!is_signature_equal(rsdp->signature, ACPI_RSDP_SIGNATURE, sizeof(rsdp->signature))
+            || !is_checksum_valid(rsdp, ACPI_RSDP_VERSION1_LENGTH)) {
+        return -2;
+    }
+
+    const struct acpi_table_header *root = NULL;
+    if (rsdp->revision >= 2 && rsdp->xsdt_address != 0) {
+        if (!is_checksum_valid(rsdp, rsdp->length)) {
+            return -2;
+        }
+
+        root = get_table(rsdp->xsdt_address);
+        if (root == NULL || !is_signature_equal(root->signature, ACPI_XSDT_SIGNATURE, 4)) {
+            return -2;
+        }
+        global_acpi_data.entry_size = sizeof(uint64_t);
+    } else {
+        root = get_table(rsdp->rsdt_address);
+        if (root == NULL || !is_signature_equal(root->signature, ACPI_RSDT_SIGNATURE, 4)) {
+            return -2;
+        }
+        global_acpi_data.entry_size = sizeof(uint32_t);
+    }
+
+    global_acpi_data.root = root;
+
+    return 0;
+}
+
+const struct acpi_table_header *acpi_find_table(const char *const signature)
+{
+    const struct acpi_table_header *const root = global_acpi_data.root;
+    if (root == NULL) {
+        return NULL;
+    }
+
+    const uint8_t *const entries = (const uint8_t *)(root + 1);
+    const uint64_t entry_number =
+        (root->length - sizeof(*root)) / global_acpi_data.entry_size;
+
+    for (uint64_t i = 0; i < entry_number; ++i) {
+        // Entries are not aligned on their size in the XSDT.
+        const uint8_t *const entry = entries + i * global_acpi_data.entry_size;
+        address_t address = 0;
+        for (uint64_t j = 0; j < global_acpi_data.entry_size; ++j) {
+            address |= (address_t)entry[j] << (j * 8);
+        }
+
+        const struct acpi_table_header *const table = get_table(address);
+        if (table != NULL && is_signature_equal(table->signature, signature, 4)) {
+            return table;
+        }
+    }
+
+    return NULL;
+}
@@ -0,0 +1,43 @@
+#ifndef _ACPI_ACPI_H
+#define _ACPI_ACPI_H
+
+#include <stdint.h>
+#include <general/address.h>
+
+/**
+ * The header every ACPI system description table starts with.
+ *
+ * @see Section 5.2.6, ACPI Specification
+ */
+struct acpi_table_header {
+    char     signature[4];
+    /** Length of the whole table in bytes, including the header. */
+    uint32_t length;
+    uint8_t  revision;
+    /** All bytes of the table add up to 0. */
+    uint8_t  checksum;
+    char     oem_id[6];
+    char     oem_table_id[8];
+    uint32_t oem_revision;
+    uint32_t creator_id;
+    uint32_t creator_revision;
+} __attribute__((packed));
+
+/**
+ * Find the root table from the RSDP given by the boot loader.
+ *
+ * The XSDT is used if the RSDP is of ACPI 2.0 or later, the RSDT otherwise.
+ *
+ * @return 0 on success, -1 if there is no RSDP, -2 if a checksum is wrong, -3 if the tables can't
+ * be mapped.
+ */
+int acpi_initialize(address_t rsdp_address);
+
+/**
+ * Return the first table with `signature`, such as "APIC" for the MADT.
+ *
+ * @return The table, or NULL if there is no valid table with the signature.
+ */
+const struct acpi_table_header *acpi_find_table(const char *const signature);
+
+#endif
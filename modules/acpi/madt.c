@@ -0,0 +1,68 @@
+#include <stddef.h>
+
+#include "acpi.h"
+#include "madt.h"
+
+/**
+ * Multiple APIC Description Table.
+ *
+ * Variable length entries describing interrupt controllers follow the fixed fields.
+ *
+ * @see Section 5.2.12, ACPI Specification
+ */
+struct madt {
+    struct acpi_table_header header;
+    uint32_t local_apic_address;
+    uint32_t flags;
+} __attribute__((packed));
+
+struct madt_entry_header {
+    uint8_t type;
+    uint8_t length;
+} __attribute__((packed));
+
+#define MADT_ENTRY_TYPE_LOCAL_APIC (0)
+
+struct madt_local_apic {
+    struct madt_entry_header header;
+    uint8_t  processor_id;
+    uint8_t  local_apic_id;
+    uint32_t flags;
+} __attribute__((packed));
+
+/** The processor is ready to use. */
+#define MADT_LOCAL_APIC_ENABLED        (1 << 0)
+/** The processor is disabled but may be enabled at runtime. We don't support it. */
+#define MADT_LOCAL_APIC_ONLINE_CAPABLE (1 << 1)
+
+int madt_get_local_apic_ids(uint8_t *const local_apic_ids, uint32_t max_number)
+{
+    const struct madt *const madt = (const struct madt *)acpi_find_table("APIC");
+    if (madt == NULL || madt->header.length < sizeof(*madt)) {
+        return -1;
+    }
+
+    const uint8_t *entry = (const uint8_t *)(madt + 1);
+    const uint8_t *const end = (const uint8_t *)madt + madt->header.length;
+    uint32_t number = 0;
+
+    while (entry + sizeof(struct madt_entry_header) <= end && number < max_number) {
+        const struct madt_entry_header *const header = (const struct madt_entry_header *)entry;
+        if (header->length < sizeof(*header) || entry + header->length > end) {
+            break;
+        }
+
+        if (header->type == MADT_ENTRY_TYPE_LOCAL_APIC
+                && header->length >= sizeof(struct madt_local_apic)) {
+            const struct madt_local_apic *const local_apic = (const struct madt_local_apic *)entry;
+
+            if (local_apic->flags & MADT_LOCAL_APIC_ENABLED) {
+                local_apic_ids[number++] = local_apic->local_apic_id;
+            }
+        }
+
+        entry += header->length;
+    }
+
+    return number;
+}
@@ -0,0 +1,21 @@
+#ifndef _ACPI_MADT_H
+#define _ACPI_MADT_H
+
+#include <stdint.h>
+
+/**
+ * Read the local APIC IDs of usable processors from the MADT, in the order the firmware lists
+ * them.
+ *
+ * Only processor local APIC entries are read. Processors described by x2APIC entries have IDs the
+ * local APIC in xAPIC mode can't address.
+ *
+ * Parsing stops at the first entry that runs past the end of the table, keeping the IDs read
+ * before it.
+ *
+ * @return Number of IDs written to `local_apic_ids`, at most `max_number`, or -1 if there is no
+ * MADT or its header is truncated.
+ */
+int madt_get_local_apic_ids(uint8_t *const local_apic_ids, uint32_t max_number);
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef _ASM_KERNEL_TRAMPOLINE_H
+#define _ASM_KERNEL_TRAMPOLINE_H
+
+#include <stdint.h>
+#include <general/address.h>
+
+/**
+ * The data block at `smp_trampoline_data` in the copy of the startup code.
+ *
+ * Addresses and selectors of the far jumps are filled by the assembler, the rest by the bootstrap
+ * processor. Keep this in sync with `trampoline_data` in trampoline.S.
+ */
+struct smp_trampoline_data {
+    uint16_t gdt_limit;
+    uint32_t gdt_address;
+    uint32_t protected_mode_address;
+    uint16_t protected_mode_selector;
+    uint32_t long_mode_address;
+    uint16_t long_mode_selector;
+    uint16_t reserved0;
+    uint32_t reserved1;
+    uint64_t control_register0;
+    /** Must be below 4 GB as it's loaded in protected mode. */
+    uint64_t control_register3;
+    uint64_t control_register4;
+    uint64_t efer;
+    /** The stack the entry runs on. */
+    uint64_t stack_pointer;
+    /** A `void entry(uint64_t argument)` function that never returns. */
+    uint64_t entry_address;
+    uint64_t argument;
+} __attribute__((packed));
+
+/*
+ * Note that these prototypes are meant to be used for linking.
+ *
+ * Do not invoke these functions directly.
+ */
+void smp_trampoline_start(void);
+void smp_trampoline_data(void);
+void smp_trampoline_end(void);
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef _ASM_TASK_CONTEXT_SWITCH_H
+#define _ASM_TASK_CONTEXT_SWITCH_H
+
+#include <stdint.h>
+#include <general/address.h>
+
+void context_switch(uint64_t *const previous_stack_pointer, uint64_t next_stack_pointer);
+
+void context_switch_entry(void);
+
+/**
+ * Build the initial stack of a new thread and return its stack pointer.
+ *
+ * The first switch to the thread pops `function` into R12 and `argument` into R13, then returns
+ * to `context_switch_entry`.
+ */
+static inline uint64_t context_switch_initialize_stack(address_t top_address, address_t function,
+        address_t argument)
+{
+    uint64_t *stack = (uint64_t *)top_address;
+
+    // `top_address` is page aligned, so the stack is 16-byte aligned in `context_switch_entry`.
+    *--stack = (uint64_t)context_switch_entry;
+    *--stack = 0;        // RBP
+    *--stack = 0;        // RBX
+    *--stack = function; // R12
+    *--stack = argument; // R13
+    *--stack = 0;        // R14
+    *--stack = 0;        // R15
+
+    return (uint64_t)stack;
+}
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef _CPU_CPUID_H
+#define _CPU_CPUID_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define CPUID_LEAF_FEATURE          (0x00000001)
+#define CPUID_LEAF_MONITOR          (0x00000005)
+#define CPUID_LEAF_EXTENDED_MAXIMUM (0x80000000)
+#define CPUID_LEAF_POWER_MANAGEMENT (0x80000007)
+
+/** CPUID.01H:ECX bits. */
+#define CPUID_FEATURE_ECX_MONITOR      (1 << 3)
+#define CPUID_FEATURE_ECX_TSC_DEADLINE (1 << 24)
+/** CPUID.01H:EDX bits. */
+#define CPUID_FEATURE_EDX_APIC         (1 << 9)
+/** CPUID.05H:ECX bits. */
+#define CPUID_MONITOR_ECX_EXTENSIONS      (1 << 0)
+#define CPUID_MONITOR_ECX_INTERRUPT_BREAK (1 << 1)
+/** CPUID.80000007H:EDX bits. */
+#define CPUID_POWER_MANAGEMENT_EDX_INVARIANT_TSC (1 << 8)
+
+struct cpuid_result {
+    uint32_t eax;
+    uint32_t ebx;
+    uint32_t ecx;
+    uint32_t edx;
+};
+
+static inline struct cpuid_result cpuid(uint32_t leaf, uint32_t subleaf)
+{
+    struct cpuid_result result;
+
+    asm __volatile__("cpuid"
+            : "=a"(result.eax), "=b"(result.ebx), "=c"(result.ecx), "=d"(result.edx)
+            : "a"(leaf), "c"(subleaf));
+
+    return result;
+}
+
+static inline bool cpuid_has_tsc_deadline(void)
+{
+    return (cpuid(CPUID_LEAF_FEATURE, 0).ecx & CPUID_FEATURE_ECX_TSC_DEADLINE) != 0;
+}
+
+/**
+ * Return whether MWAIT can be woken up by interrupts even while they are disabled.
+ *
+ * That lets a processor check its wait condition and sleep without a window for a lost wakeup.
+ */
+static inline bool cpuid_has_monitor_interrupt_break(void)
+{
+    if ((cpuid(CPUID_LEAF_FEATURE, 0).ecx & CPUID_FEATURE_ECX_MONITOR) == 0) {
+        return false;
+    }
+
+    const uint32_t extensions = CPUID_MONITOR_ECX_EXTENSIONS | CPUID_MONITOR_ECX_INTERRUPT_BREAK;
+
+    return (cpuid(CPUID_LEAF_MONITOR, 0).ecx & extensions) == extensions;
+}
+
+static inline bool cpuid_has_invariant_tsc(void)
+{
+    if (cpuid(CPUID_LEAF_EXTENDED_MAXIMUM, 0).eax < CPUID_LEAF_POWER_MANAGEMENT) {
+        return false;
+    }
+
+    return (cpuid(CPUID_LEAF_POWER_MANAGEMENT, 0).edx & CPUID_POWER_MANAGEMENT_EDX_INVARIANT_TSC)
+        != 0;
+}
+
+#endif
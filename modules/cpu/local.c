@@ -0,0 +1,15 @@
+#include <general/address.h>
+
+#include "local.h"
+#include "model_specific_register.h"
+
+static struct cpu_local_data global_cpu_local_data[CPU_MAX_NUMBER];
+
+void cpu_local_initialize(uint32_t index)
+{
+    global_cpu_local_data[index].index = index;
+    global_cpu_local_data[index].rcu_read_depth = 0;
+
+    model_specific_register_write(MODEL_SPECIFIC_REGISTER_GS_BASE,
+            (address_t)&global_cpu_local_data[index]);
+}
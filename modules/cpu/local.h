@@ -0,0 +1,50 @@
+#ifndef _CPU_LOCAL_H
+#define _CPU_LOCAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** Maximum number of processors the kernel manages. */
+#define CPU_MAX_NUMBER (16)
+
+/**
+ * Data private to each processor.
+ *
+ * The base address of the GS segment of each processor points to its own entry, so a field is
+ * read with a single GS-relative load wherever the current thread happens to run.
+ */
+struct cpu_local_data {
+    uint32_t index;
+    /** Nesting depth of RCU read-side critical sections. See `sync/rcu.h`. */
+    uint32_t rcu_read_depth;
+};
+
+/**
+ * Point the GS base of the current processor to the per-processor data of `index`.
+ *
+ * Call this before anything else on each processor. Nothing may load the GS selector afterwards,
+ * as it resets the base.
+ */
+void cpu_local_initialize(uint32_t index);
+
+/**
+ * Return the index of the current processor.
+ *
+ * Per-processor data is kept in arrays of `CPU_MAX_NUMBER` entries indexed by this value, so each
+ * processor only ever writes to its own entry.
+ *
+ * The thread may be moved to another processor right after this returns unless interrupts are
+ * disabled.
+ */
+static inline uint32_t cpu_local_index(void)
+{
+    uint32_t index;
+
+    asm __volatile__("movl %%gs:%c1, %0"
+            : "=r"(index)
+            : "i"(offsetof(struct cpu_local_data, index)));
+
+    return index;
+}
+
+#endif
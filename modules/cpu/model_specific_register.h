@@ -0,0 +1,32 @@
+#ifndef _CPU_MODEL_SPECIFIC_REGISTER_H
+#define _CPU_MODEL_SPECIFIC_REGISTER_H
+
+#include <stdint.h>
+
+#define MODEL_SPECIFIC_REGISTER_APIC_BASE    (0x0000001B)
+#define MODEL_SPECIFIC_REGISTER_TSC_DEADLINE (0x000006E0)
+#define MODEL_SPECIFIC_REGISTER_EFER         (0xC0000080)
+#define MODEL_SPECIFIC_REGISTER_GS_BASE      (0xC0000101)
+
+/** Long mode active bit of the EFER register. It's read-only. */
+#define MODEL_SPECIFIC_REGISTER_EFER_LMA (1 << 10)
+
+static inline uint64_t model_specific_register_read(uint32_t index)
+{
+    uint32_t low;
+    uint32_t high;
+
+    asm __volatile__("rdmsr" : "=a"(low), "=d"(high) : "c"(index));
+
+    return ((uint64_t)high << 32) | low;
+}
+
+static inline void model_specific_register_write(uint32_t index, uint64_t value)
+{
+    asm __volatile__("wrmsr"
+            :
+            : "c"(index), "a"((uint32_t)value), "d"((uint32_t)(value >> 32))
+            : "memory");
+}
+
+#endif
@@ -12,7 +12,26 @@ enum port {
     pic_master0 = 0x20,
     pic_master1 = 0x21,
     pic_slave0  = 0xA0,
-    pic_slave1  = 0xA1
+    pic_slave1  = 0xA1,
+
+    // The 8254 programmable interval timer. `pit3` is the mode/command register.
+    pit0 = 0x40,
+    pit2 = 0x42,
+    pit3 = 0x43,
+    // System control port B. Gates the PIT channel 2 and reports its output.
+    system_control = 0x61,
+
+    // The CMOS memory holding the real time clock. Select a register through `cmos0`.
+    cmos0 = 0x70,
+    cmos1 = 0x71,
+
+    // The first serial port (COM1) driven by a 16550 compatible UART.
+    serial0 = 0x3F8,
+    serial1 = 0x3F9,
+    serial2 = 0x3FA,
+    serial3 = 0x3FB,
+    serial4 = 0x3FC,
+    serial5 = 0x3FD
 };
 
 static inline void port_wait(void)
@@ -28,7 +47,7 @@ static inline uint8_t port_read(enum port port)
     asm __volatile__(
         "mov %1, %%dx \n\t"
         "in  %%dx, %0 \n\t"
-        : "=r"(result)
+        : "=a"(result)
         : "m"(port)
         : "dx"
     );
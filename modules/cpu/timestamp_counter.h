@@ -0,0 +1,22 @@
+#ifndef _CPU_TIMESTAMP_COUNTER_H
+#define _CPU_TIMESTAMP_COUNTER_H
+
+#include <stdint.h>
+
+/**
+ * Read the time-stamp counter of the current processor.
+ *
+ * The counter increases on every clock cycle of the processor, or at a constant rate if the
+ * processor supports invariant TSC.
+ */
+static inline uint64_t timestamp_counter_read(void)
+{
+    uint32_t low;
+    uint32_t high;
+
+    asm __volatile__("rdtsc" : "=a"(low), "=d"(high));
+
+    return ((uint64_t)high << 32) | low;
+}
+
+#endif
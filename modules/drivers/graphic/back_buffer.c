@@ -0,0 +1,228 @@
+#include <stdbool.h>
+#include <general/memory.h>
+
+#include "back_buffer.h"
+
+static inline uint64_t min(uint64_t a, uint64_t b)
+{
+    return a < b ? a : b;
+}
+
+static inline uint64_t max(uint64_t a, uint64_t b)
+{
+    return a > b ? a : b;
+}
+
+int back_buffer_initialize(struct back_buffer *const back_buffer,
+        const struct graphic_frame_buffer_data *const front)
+{
+    const uint64_t size = front->width * front->height * sizeof(pixel_value_t);
+    const uint64_t frame_number = (size + MEMORY_FRAME_SIZE - 1) / MEMORY_FRAME_SIZE;
+
+    const frame_t frame = frame_allcoator_request(frame_number);
+    if (frame == MEMORY_FRAME_NULL) {
+        return -1;
+    }
+
+    back_buffer->front = *front;
+    back_buffer->back = *front;
+    back_buffer->back.address = (address_t)frame;
+    back_buffer->back.size = size;
+    back_buffer->back.pixel_per_scanline = front->width;
+    back_buffer->frame = frame;
+    back_buffer->frame_number = frame_number;
+    back_buffer->dirty_rectangle_number = 0;
+    back_buffer->flush_number = 0;
+    back_buffer->flushed_pixel_number = 0;
+
+    // The only read of the frame buffer, so whatever is on the screen survives the switch.
+    const pixel_value_t *source = (const pixel_value_t *)front->address;
+    pixel_value_t *destination = (pixel_value_t *)back_buffer->back.address;
+    for (uint64_t y = 0; y < front->height; ++y) {
+        for (uint64_t x = 0; x < front->width; ++x) {
+            destination[x] = source[x];
+        }
+        source += front->pixel_per_scanline;
+        destination += back_buffer->back.pixel_per_scanline;
+    }
+
+    return 0;
+}
+
+static inline bool is_touching(const struct back_buffer_rectangle *const a,
+        const struct back_buffer_rectangle *const b)
+{
+    return a->x <= b->x + b->width && b->x <= a->x + a->width
+        && a->y <= b->y + b->height && b->y <= a->y + a->height;
+}
+
+static inline void merge(struct back_buffer_rectangle *const destination,
+        const struct back_buffer_rectangle *const source)
+{
+    const uint64_t right = max(destination->x + destination->width, source->x + source->width);
+    const uint64_t bottom = max(destination->y + destination->height,
+            source->y + source->height);
+
+    destination->x = min(destination->x, source->x);
+    destination->y = min(destination->y, source->y);
+    destination->width = right - destination->x;
+    destination->height = bottom - destination->y;
+}
+
+static inline uint64_t get_merged_area(const struct back_buffer_rectangle *const a,
+        const struct back_buffer_rectangle *const b)
+{
+    struct back_buffer_rectangle merged = *a;
+    merge(&merged, b);
+
+    return merged.width * merged.height;
+}
+
+void back_buffer_add_damage(struct back_buffer *const back_buffer, uint64_t x, uint64_t y,
+        uint64_t width, uint64_t height)
+{
+    if (x >= back_buffer->back.width || y >= back_buffer->back.height
+            || width == 0 || height == 0) {
+        return;
+    }
+
+    const struct back_buffer_rectangle rectangle = {
+        .x = x,
+        .y = y,
+        .width = min(width, back_buffer->back.width - x),
+        .height = min(height, back_buffer->back.height - y)
+    };
+
+    // Glyphs printed one after another touch each other, so a line of text ends up as one area.
+    for (uint64_t i = 0; i < back_buffer->dirty_rectangle_number; ++i) {
+        if (is_touching(&back_buffer->dirty_rectangles[i], &rectangle)) {
+            merge(&back_buffer->dirty_rectangles[i], &rectangle);
+            return;
+        }
+    }
+
+    if (back_buffer->dirty_rectangle_number < BACK_BUFFER_MAX_DIRTY_RECTANGLE_NUMBER) {
+        back_buffer->dirty_rectangles[back_buffer->dirty_rectangle_number++] = rectangle;
+        return;
+    }
+
+    // Out of rectangles. Grow the one that takes in the new area with the least extra pixels.
+    uint64_t best_index = 0;
+    uint64_t best_growth = UINT64_MAX;
+
+    for (uint64_t i = 0; i < back_buffer->dirty_rectangle_number; ++i) {
+        const struct back_buffer_rectangle *const dirty = &back_buffer->dirty_rectangles[i];
+        const uint64_t growth = get_merged_area(dirty, &rectangle) - dirty->width * dirty->height;
+
+        if (growth < best_growth) {
+            best_index = i;
+            best_growth = growth;
+        }
+    }
+
+    merge(&back_buffer->dirty_rectangles[best_index], &rectangle);
+}
+
+/**
+ * Copy pixels 8 bytes at a time with a single string move. Overlapping is fine as long as
+ * `destination` comes first, as the move goes upward.
+ */
+static inline void move_pixels(pixel_value_t *destination, const pixel_value_t *source,
+        uint64_t size)
+{
+    uint64_t count = size / 2;
+
+    asm __volatile__("rep movsq"
+            : "+D"(destination), "+S"(source), "+c"(count)
+            :
+            : "memory");
+
+    if (size % 2 != 0) {
+        *destination = *source;
+    }
+}
+
+void back_buffer_move_rows(struct back_buffer *const back_buffer, uint64_t destination_y,
+        uint64_t source_y, uint64_t height)
+{
+    const struct graphic_frame_buffer_data *const back = &back_buffer->back;
+
+    if (destination_y >= back->height || source_y >= back->height || destination_y == source_y) {
+        return;
+    }
+
+    height = min(height, back->height - max(destination_y, source_y));
+
+    pixel_value_t *const pixels = (pixel_value_t *)back->address;
+    const uint64_t row_size = back->pixel_per_scanline;
+
+    if (destination_y < source_y) {
+        // Scanlines have no padding, so the rows are one block.
+        move_pixels(&pixels[destination_y * row_size], &pixels[source_y * row_size],
+                height * row_size);
+    } else {
+        // Moving down overlaps the wrong way for an upward move, so go a row at a time from the
+        // bottom. The direction flag stays clear, as interrupt handlers expect.
+        for (uint64_t row = height; row > 0; --row) {
+            move_pixels(&pixels[(destination_y + row - 1) * row_size],
+                    &pixels[(source_y + row - 1) * row_size], row_size);
+        }
+    }
+
+    back_buffer_add_damage(back_buffer, 0, destination_y, back->width, height);
+}
+
+/**
+ * Copy a span of pixels, 2 at a time where the destination is 8-byte aligned.
+ *
+ * Non-temporal stores go around the cache, which would only be filled with frame buffer lines
+ * nobody reads, and are combined into full bus writes.
+ */
+static void copy_span(pixel_value_t *destination, const pixel_value_t *source, uint64_t size)
+{
+    if (size > 0 && (address_t)destination % sizeof(uint64_t) != 0) {
+        memory_store_non_temporal_32(destination++, *source++);
+        --size;
+    }
+
+    for (; size >= 2; size -= 2) {
+        const uint64_t value = (uint64_t)source[0] | ((uint64_t)source[1] << 32);
+        memory_store_non_temporal_64((uint64_t *)destination, value);
+        destination += 2;
+        source += 2;
+    }
+
+    if (size > 0) {
+        memory_store_non_temporal_32(destination, *source);
+    }
+}
+
+void back_buffer_flush(struct back_buffer *const back_buffer)
+{
+    if (back_buffer->dirty_rectangle_number == 0) {
+        return;
+    }
+
+    for (uint64_t i = 0; i < back_buffer->dirty_rectangle_number; ++i) {
+        const struct back_buffer_rectangle *const dirty = &back_buffer->dirty_rectangles[i];
+
+        const pixel_value_t *source = (const pixel_value_t *)back_buffer->back.address
+            + dirty->x + (dirty->y * back_buffer->back.pixel_per_scanline);
+        pixel_value_t *destination = (pixel_value_t *)back_buffer->front.address
+            + dirty->x + (dirty->y * back_buffer->front.pixel_per_scanline);
+
+        for (uint64_t row = 0; row < dirty->height; ++row) {
+            copy_span(destination, source, dirty->width);
+            source += back_buffer->back.pixel_per_scanline;
+            destination += back_buffer->front.pixel_per_scanline;
+        }
+
+        back_buffer->flushed_pixel_number += dirty->width * dirty->height;
+    }
+
+    // Non-temporal stores are weakly ordered. Make them visible before anything that follows.
+    memory_fence_stores();
+
+    back_buffer->dirty_rectangle_number = 0;
+    ++back_buffer->flush_number;
+}
@@ -0,0 +1,62 @@
+#ifndef _DRIVERS_GRAPHIC_BACK_BUFFER_H
+#define _DRIVERS_GRAPHIC_BACK_BUFFER_H
+
+#include <stdint.h>
+#include <memory/frame_allocator.h>
+
+#include "screen.h"
+
+#define BACK_BUFFER_MAX_DIRTY_RECTANGLE_NUMBER (16)
+
+struct back_buffer_rectangle {
+    uint64_t x;
+    uint64_t y;
+    uint64_t width;
+    uint64_t height;
+};
+
+/**
+ * An off-screen copy of a frame buffer in normal memory.
+ *
+ * Frame buffer memory is slow to write and much slower to read, so drawing goes to `back`, each
+ * draw adds the area it touched as damage, and a flush copies only the damaged areas to `front`.
+ *
+ * Not locked, so only one thread may use a back buffer at a time.
+ */
+struct back_buffer {
+    /** Frame buffer of the screen. */
+    struct graphic_frame_buffer_data front;
+    /** Drawing target, laid out like `front` without padding after scanlines. */
+    struct graphic_frame_buffer_data back;
+    frame_t frame;
+    uint64_t frame_number;
+    /** Damaged areas. Touching areas are merged, so they rarely overlap. */
+    struct back_buffer_rectangle dirty_rectangles[BACK_BUFFER_MAX_DIRTY_RECTANGLE_NUMBER];
+    uint64_t dirty_rectangle_number;
+    uint64_t flush_number;
+    uint64_t flushed_pixel_number;
+};
+
+/**
+ * Allocate a back buffer for `front` and copy the screen into it.
+ *
+ * @return 0 on success, -1 if there is no memory for it.
+ */
+int back_buffer_initialize(struct back_buffer *const back_buffer,
+        const struct graphic_frame_buffer_data *const front);
+
+/** Mark an area of the back buffer as changed. Parts outside the screen are ignored. */
+void back_buffer_add_damage(struct back_buffer *const back_buffer, uint64_t x, uint64_t y,
+        uint64_t width, uint64_t height);
+
+/**
+ * Move `height` rows of pixels starting at `source_y` to `destination_y`, and mark where they went
+ * as damaged. Rows that would fall off the screen are not moved.
+ */
+void back_buffer_move_rows(struct back_buffer *const back_buffer, uint64_t destination_y,
+        uint64_t source_y, uint64_t height);
+
+/** Copy damaged areas to the screen with non-temporal stores and forget them. */
+void back_buffer_flush(struct back_buffer *const back_buffer);
+
+#endif
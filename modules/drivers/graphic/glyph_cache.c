@@ -0,0 +1,175 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <general/address.h>
+#include <general/linked_list.h>
+
+#include "glyph_cache.h"
+
+#define GLYPH_CACHE_ENTRY_NUMBER     (256)
+#define GLYPH_CACHE_BUCKET_NUMBER    (512)
+#define GLYPH_CACHE_MAX_GLYPH_HEIGHT (16)
+#define GLYPH_CACHE_MAX_BLOCK_SIZE   (2)
+#define GLYPH_CACHE_TILE_SIZE \
+    (SCREEN_GLYPH_WIDTH * GLYPH_CACHE_MAX_GLYPH_HEIGHT \
+     * GLYPH_CACHE_MAX_BLOCK_SIZE * GLYPH_CACHE_MAX_BLOCK_SIZE)
+
+struct glyph_cache_entry {
+    /** Links the entry into the LRU list, most recently drawn first. */
+    struct linked_list_node lru_node;
+    /** Links the entry into its hash bucket while it holds a tile. */
+    struct linked_list_node bucket_node;
+    bool is_used;
+    const uint8_t *glyph;
+    uint64_t height;
+    pixel_value_t foreground;
+    pixel_value_t background;
+    uint64_t block_size;
+};
+
+/**
+ * Unused entries sit at the tail of the LRU list, so a miss always takes the tail, evicting the
+ * least recently drawn tile once the cache is full.
+ *
+ * Keys use pixel values rather than colors, so changing the console colors only makes new tiles,
+ * and the tiles of the old colors age out.
+ */
+struct glyph_cache_data {
+    struct glyph_cache_entry entries[GLYPH_CACHE_ENTRY_NUMBER];
+    pixel_value_t tiles[GLYPH_CACHE_ENTRY_NUMBER][GLYPH_CACHE_TILE_SIZE];
+    struct linked_list_node buckets[GLYPH_CACHE_BUCKET_NUMBER];
+    struct linked_list_node lru;
+    struct glyph_cache_statistics statistics;
+};
+
+static struct glyph_cache_data global_glyph_cache_data;
+
+void glyph_cache_initialize(void)
+{
+    struct glyph_cache_data *const data = &global_glyph_cache_data;
+
+    linked_list_initialize(&data->lru);
+
+    for (uint64_t i = 0; i < GLYPH_CACHE_BUCKET_NUMBER; ++i) {
+        linked_list_initialize(&data->buckets[i]);
+    }
+
+    for (uint64_t i = 0; i < GLYPH_CACHE_ENTRY_NUMBER; ++i) {
+        data->entries[i].is_used = false;
+        linked_list_append(&data->lru, &data->entries[i].lru_node);
+    }
+
+    data->statistics.hit_number = 0;
+    data->statistics.miss_number = 0;
+    data->statistics.eviction_number = 0;
+    data->statistics.bypass_number = 0;
+}
+
+static inline uint64_t get_bucket_index(const uint8_t *const glyph, pixel_value_t foreground,
+        pixel_value_t background, uint64_t block_size)
+{
+    uint64_t hash = (uint64_t)glyph;
+
+    hash = (hash ^ foreground) * 0x9E3779B97F4A7C15ULL;
+    hash = (hash ^ background) * 0x9E3779B97F4A7C15ULL;
+    hash = (hash ^ block_size) * 0x9E3779B97F4A7C15ULL;
+
+    return (hash >> 32) % GLYPH_CACHE_BUCKET_NUMBER;
+}
+
+static struct glyph_cache_entry *find_entry(struct linked_list_node *const bucket,
+        const uint8_t *const glyph, uint64_t height, pixel_value_t foreground,
+        pixel_value_t background, uint64_t block_size)
+{
+    struct linked_list_node *cursor = NULL;
+
+    linked_list_for_each_node(cursor, bucket) {
+        struct glyph_cache_entry *const entry =
+            container_of(cursor, struct glyph_cache_entry, bucket_node);
+
+        if (entry->glyph == glyph && entry->height == height
+                && entry->foreground == foreground && entry->background == background
+                && entry->block_size == block_size) {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+static inline pixel_value_t *get_tile(struct glyph_cache_entry *const entry)
+{
+    struct glyph_cache_data *const data = &global_glyph_cache_data;
+
+    return data->tiles[entry - data->entries];
+}
+
+void glyph_cache_draw(const struct graphic_frame_buffer_data *const buffer_data,
+        uint64_t x, uint64_t y, const uint8_t *const glyph, uint64_t height,
+        const struct pixel_color foreground, const struct pixel_color background,
+        const uint64_t block_size)
+{
+    struct glyph_cache_data *const data = &global_glyph_cache_data;
+
+    if (height > GLYPH_CACHE_MAX_GLYPH_HEIGHT || block_size > GLYPH_CACHE_MAX_BLOCK_SIZE
+            || block_size == 0) {
+        ++data->statistics.bypass_number;
+        screen_draw_glyph(buffer_data, x, y, glyph, height, foreground, background, block_size);
+        return;
+    }
+
+    const pixel_value_t foreground_value = screen_get_pixel_value(buffer_data, foreground);
+    const pixel_value_t background_value = screen_get_pixel_value(buffer_data, background);
+    struct linked_list_node *const bucket = &data->buckets[get_bucket_index(glyph,
+            foreground_value, background_value, block_size)];
+
+    struct glyph_cache_entry *entry = find_entry(bucket, glyph, height, foreground_value,
+            background_value, block_size);
+
+    if (entry != NULL) {
+        ++data->statistics.hit_number;
+    } else {
+        ++data->statistics.miss_number;
+
+        entry = container_of(data->lru.previous, struct glyph_cache_entry, lru_node);
+        if (entry->is_used) {
+            ++data->statistics.eviction_number;
+            linked_list_remove(&entry->bucket_node);
+        }
+
+        entry->is_used = true;
+        entry->glyph = glyph;
+        entry->height = height;
+        entry->foreground = foreground_value;
+        entry->background = background_value;
+        entry->block_size = block_size;
+        linked_list_append(bucket, &entry->bucket_node);
+
+        screen_render_glyph(get_tile(entry), glyph, height, foreground_value, background_value,
+                block_size);
+    }
+
+    linked_list_remove(&entry->lru_node);
+    linked_list_insert_before(data->lru.next, &entry->lru_node);
+
+    screen_draw_tile(buffer_data, x, y, get_tile(entry), SCREEN_GLYPH_WIDTH * block_size,
+            height * block_size);
+}
+
+void glyph_cache_get_statistics(struct glyph_cache_statistics *const out)
+{
+    *out = global_glyph_cache_data.statistics;
+}
+
+void glyph_cache_print(string_print_t print)
+{
+    struct glyph_cache_statistics statistics;
+    glyph_cache_get_statistics(&statistics);
+
+    const uint64_t lookup_number = statistics.hit_number + statistics.miss_number;
+
+    print("Glyph cache: %u tiles, %lu hits, %lu misses (%lu percent hit), %lu evictions, "
+            "%lu bypassed\n", GLYPH_CACHE_ENTRY_NUMBER, statistics.hit_number,
+            statistics.miss_number,
+            lookup_number == 0 ? 0 : statistics.hit_number * 100 / lookup_number,
+            statistics.eviction_number, statistics.bypass_number);
+}
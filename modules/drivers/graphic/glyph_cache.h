@@ -0,0 +1,40 @@
+#ifndef _DRIVERS_GRAPHIC_GLYPH_CACHE_H
+#define _DRIVERS_GRAPHIC_GLYPH_CACHE_H
+
+#include <stdint.h>
+#include <general/string.h>
+
+#include "screen.h"
+
+struct glyph_cache_statistics {
+    uint64_t hit_number;
+    uint64_t miss_number;
+    uint64_t eviction_number;
+    /** Glyphs too large for a tile, drawn without the cache. */
+    uint64_t bypass_number;
+};
+
+/**
+ * Drop every tile. Call this before the first draw.
+ *
+ * The cache is not locked, so only one thread may draw through it at a time.
+ */
+void glyph_cache_initialize(void);
+
+/**
+ * Draw a glyph like `screen_draw_glyph`, copying a tile rendered for the same glyph, colors and
+ * scale before if there is one.
+ *
+ * Tiles are keyed by the address of `glyph`, so glyphs must not change once drawn. A full cache
+ * replaces the least recently drawn tile.
+ */
+void glyph_cache_draw(const struct graphic_frame_buffer_data *const buffer_data,
+        uint64_t x, uint64_t y, const uint8_t *const glyph, uint64_t height,
+        const struct pixel_color foreground, const struct pixel_color background,
+        const uint64_t block_size);
+
+void glyph_cache_get_statistics(struct glyph_cache_statistics *const out);
+
+void glyph_cache_print(string_print_t print);
+
+#endif
@@ -0,0 +1,316 @@
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "pixel_format.h"
+
+#define PIXEL_FORMAT_ALPHA_OPAQUE (0xFF)
+
+/** Every 16-bit lane's low byte, one lane per color of a spread pixel. */
+#define PIXEL_FORMAT_LANE_MASK (0x00FF00FF00FF00FF)
+/** Half of 255 in every lane, to round when dividing by 255. */
+#define PIXEL_FORMAT_LANE_HALF (0x0080008000800080)
+
+struct pixel_format_data {
+    struct pixel_format formats[PIXEL_FORMAT_NUMBER];
+    bool is_bit_mask_supported;
+};
+
+static struct pixel_format_data global_pixel_format_data;
+
+/**
+ * Define the encoder and decoder of a format with a byte for each color at fixed positions, so
+ * they compile to a few shifts with no look at the format.
+ */
+#define DEFINE_BYTE_FORMAT(name, red_position, green_position, blue_position) \
+static inline pixel_value_t encode_##name(const struct pixel_format *const format, \
+        const struct pixel_color color) \
+{ \
+    (void)format; \
+    return ((pixel_value_t)color.red << (red_position)) \
+        | ((pixel_value_t)color.green << (green_position)) \
+        | ((pixel_value_t)color.blue << (blue_position)); \
+} \
+\
+static inline struct pixel_color decode_##name(const struct pixel_format *const format, \
+        pixel_value_t value) \
+{ \
+    (void)format; \
+    return (struct pixel_color){ \
+        .red = (uint8_t)(value >> (red_position)), \
+        .green = (uint8_t)(value >> (green_position)), \
+        .blue = (uint8_t)(value >> (blue_position)), \
+    }; \
+}
+
+DEFINE_BYTE_FORMAT(rgb8, 0, 8, 16)
+DEFINE_BYTE_FORMAT(bgr8, 16, 8, 0)
+
+static inline pixel_value_t encode_channel(uint8_t value, uint8_t shift, uint8_t size)
+{
+    return (pixel_value_t)(value >> (8 - size)) << shift;
+}
+
+/** Widen a channel to 8 bits by repeating its bits, so its largest value becomes 0xFF. */
+static inline uint8_t decode_channel(pixel_value_t value, uint8_t shift, uint8_t size)
+{
+    const uint32_t channel = (value >> shift) & ((1U << size) - 1);
+    uint32_t result = 0;
+
+    for (int64_t position = 8 - size; position > -(int64_t)size; position -= size) {
+        result |= position >= 0 ? channel << position : channel >> -position;
+    }
+
+    return (uint8_t)result;
+}
+
+static inline pixel_value_t encode_bit_mask(const struct pixel_format *const format,
+        const struct pixel_color color)
+{
+    return encode_channel(color.red, format->red_shift, format->red_size)
+        | encode_channel(color.green, format->green_shift, format->green_size)
+        | encode_channel(color.blue, format->blue_shift, format->blue_size);
+}
+
+static inline struct pixel_color decode_bit_mask(const struct pixel_format *const format,
+        pixel_value_t value)
+{
+    return (struct pixel_color){
+        .red = decode_channel(value, format->red_shift, format->red_size),
+        .green = decode_channel(value, format->green_shift, format->green_size),
+        .blue = decode_channel(value, format->blue_shift, format->blue_size),
+    };
+}
+
+/** Pixels of the same format only need copying, two at a time where `out` is 8-byte aligned. */
+static void copy_row(pixel_value_t *out, const struct pixel_format *const out_format,
+        const pixel_value_t *in, const struct pixel_format *const in_format, uint64_t size)
+{
+    (void)out_format;
+    (void)in_format;
+
+    if (size > 0 && (address_t)out % sizeof(pixel_pair_t) != 0) {
+        *out++ = *in++;
+        --size;
+    }
+
+    for (; size >= 2; size -= 2) {
+        *(pixel_pair_t *)out = (uint64_t)in[0] | ((uint64_t)in[1] << 32);
+        out += 2;
+        in += 2;
+    }
+
+    if (size > 0) {
+        *out = *in;
+    }
+}
+
+/**
+ * Define a converter between two formats. The decoder and encoder are inlined into the loop, so
+ * between byte formats it is a few shifts and masks for a pixel.
+ */
+#define DEFINE_CONVERT_ROW(source, destination) \
+static void convert_row_##source##_to_##destination(pixel_value_t *const out, \
+        const struct pixel_format *const out_format, const pixel_value_t *const in, \
+        const struct pixel_format *const in_format, uint64_t size) \
+{ \
+    for (uint64_t i = 0; i < size; ++i) { \
+        out[i] = encode_##destination(out_format, decode_##source(in_format, in[i])) \
+            | (in[i] & PIXEL_FORMAT_ALPHA_MASK); \
+    } \
+}
+
+DEFINE_CONVERT_ROW(rgb8, bgr8)
+DEFINE_CONVERT_ROW(rgb8, bit_mask)
+DEFINE_CONVERT_ROW(bgr8, rgb8)
+DEFINE_CONVERT_ROW(bgr8, bit_mask)
+DEFINE_CONVERT_ROW(bit_mask, rgb8)
+DEFINE_CONVERT_ROW(bit_mask, bgr8)
+
+/** Put the three low bytes of a pixel in 16-bit lanes, with room to multiply. */
+static inline uint64_t spread_bytes(pixel_value_t value)
+{
+    return (value & 0xFF) | ((uint64_t)(value & 0xFF00) << 8)
+        | ((uint64_t)(value & 0xFF0000) << 16);
+}
+
+static inline pixel_value_t gather_bytes(uint64_t lanes)
+{
+    return (lanes & 0xFF) | ((lanes >> 8) & 0xFF00) | ((lanes >> 16) & 0xFF0000);
+}
+
+/**
+ * Blend pixels whose colors are whole bytes, wherever they are.
+ *
+ * Vector registers are not saved on interrupts or thread switches, so instead of SSE the colors
+ * are spread into 16-bit lanes of a general purpose register. A product of two bytes fits a lane,
+ * so one multiply weighs all three colors and one add mixes them. Dividing by 255 is done in every
+ * lane at once with x / 255 = (x + 128 + ((x + 128) >> 8)) >> 8, exact for x < 65536.
+ */
+static void blend_row_bytes(pixel_value_t *const out, const pixel_value_t *const in,
+        const struct pixel_format *const format, uint64_t size)
+{
+    (void)format;
+
+    for (uint64_t i = 0; i < size; ++i) {
+        const uint64_t alpha = in[i] >> PIXEL_FORMAT_ALPHA_SHIFT;
+
+        if (alpha == PIXEL_FORMAT_ALPHA_OPAQUE) {
+            out[i] = (in[i] & ~PIXEL_FORMAT_ALPHA_MASK) | (out[i] & PIXEL_FORMAT_ALPHA_MASK);
+            continue;
+        }
+        if (alpha == 0) {
+            continue;
+        }
+
+        uint64_t lanes = spread_bytes(in[i]) * alpha
+            + spread_bytes(out[i]) * (PIXEL_FORMAT_ALPHA_OPAQUE - alpha) + PIXEL_FORMAT_LANE_HALF;
+        lanes = ((lanes + ((lanes >> 8) & PIXEL_FORMAT_LANE_MASK)) >> 8) & PIXEL_FORMAT_LANE_MASK;
+
+        out[i] = gather_bytes(lanes) | (out[i] & PIXEL_FORMAT_ALPHA_MASK);
+    }
+}
+
+static inline uint8_t mix(uint8_t top, uint8_t bottom, uint32_t alpha)
+{
+    return (uint8_t)((top * alpha + bottom * (PIXEL_FORMAT_ALPHA_OPAQUE - alpha) + 127) / 255);
+}
+
+/** Blend pixels of a bit mask format with colors narrower than a byte, a color at a time. */
+static void blend_row_bit_mask(pixel_value_t *const out, const pixel_value_t *const in,
+        const struct pixel_format *const format, uint64_t size)
+{
+    for (uint64_t i = 0; i < size; ++i) {
+        const uint32_t alpha = in[i] >> PIXEL_FORMAT_ALPHA_SHIFT;
+
+        if (alpha == 0) {
+            continue;
+        }
+
+        const struct pixel_color top = decode_bit_mask(format, in[i]);
+        const struct pixel_color bottom = decode_bit_mask(format, out[i]);
+        const struct pixel_color color = {
+            .red = mix(top.red, bottom.red, alpha),
+            .green = mix(top.green, bottom.green, alpha),
+            .blue = mix(top.blue, bottom.blue, alpha),
+        };
+
+        out[i] = encode_bit_mask(format, color) | (out[i] & PIXEL_FORMAT_ALPHA_MASK);
+    }
+}
+
+/**
+ * Find where a color mask starts and how wide it is.
+ *
+ * @return 0 on success, -1 if the mask isn't a single run of at most 8 bits below the top byte.
+ */
+static int parse_mask(uint32_t mask, uint8_t *const shift, uint8_t *const size)
+{
+    if (mask == 0 || (mask & PIXEL_FORMAT_ALPHA_MASK) != 0) {
+        return -1;
+    }
+
+    uint8_t position = 0;
+    for (; (mask & 1) == 0; mask >>= 1) {
+        ++position;
+    }
+
+    uint8_t width = 0;
+    for (; (mask & 1) != 0; mask >>= 1) {
+        ++width;
+    }
+
+    if (mask != 0 || width > 8) {
+        return -1;
+    }
+
+    *shift = position;
+    *size = width;
+
+    return 0;
+}
+
+static void set_layout(struct pixel_format *const format, EFI_GRAPHICS_PIXEL_FORMAT type,
+        uint8_t red_shift, uint8_t green_shift, uint8_t blue_shift)
+{
+    format->type = type;
+    format->red_shift = red_shift;
+    format->red_size = 8;
+    format->green_shift = green_shift;
+    format->green_size = 8;
+    format->blue_shift = blue_shift;
+    format->blue_size = 8;
+}
+
+static int set_bit_mask_layout(struct pixel_format *const format,
+        const EFI_PIXEL_BITMASK *const mask)
+{
+    if ((mask->RedMask & mask->GreenMask) != 0 || (mask->RedMask & mask->BlueMask) != 0
+            || (mask->GreenMask & mask->BlueMask) != 0) {
+        return -1;
+    }
+
+    if (parse_mask(mask->RedMask, &format->red_shift, &format->red_size) != 0
+            || parse_mask(mask->GreenMask, &format->green_shift, &format->green_size) != 0
+            || parse_mask(mask->BlueMask, &format->blue_shift, &format->blue_size) != 0) {
+        return -1;
+    }
+
+    return 0;
+}
+
+static inline bool is_byte_layout(const struct pixel_format *const format)
+{
+    return format->red_size == 8 && format->red_shift % 8 == 0
+        && format->green_size == 8 && format->green_shift % 8 == 0
+        && format->blue_size == 8 && format->blue_shift % 8 == 0;
+}
+
+int pixel_format_initialize(const struct graphic_frame_buffer_data *const buffer_data)
+{
+    struct pixel_format *const formats = global_pixel_format_data.formats;
+    struct pixel_format *const rgb8 = &formats[PixelRedGreenBlueReserved8BitPerColor];
+    struct pixel_format *const bgr8 = &formats[PixelBlueGreenRedReserved8BitPerColor];
+    struct pixel_format *const bit_mask = &formats[PixelBitMask];
+
+    set_layout(rgb8, PixelRedGreenBlueReserved8BitPerColor, 0, 8, 16);
+    rgb8->encode = encode_rgb8;
+    rgb8->decode = decode_rgb8;
+    rgb8->blend_row = blend_row_bytes;
+    rgb8->convert_row_to[PixelRedGreenBlueReserved8BitPerColor] = copy_row;
+    rgb8->convert_row_to[PixelBlueGreenRedReserved8BitPerColor] = convert_row_rgb8_to_bgr8;
+    rgb8->convert_row_to[PixelBitMask] = convert_row_rgb8_to_bit_mask;
+
+    set_layout(bgr8, PixelBlueGreenRedReserved8BitPerColor, 16, 8, 0);
+    bgr8->encode = encode_bgr8;
+    bgr8->decode = decode_bgr8;
+    bgr8->blend_row = blend_row_bytes;
+    bgr8->convert_row_to[PixelRedGreenBlueReserved8BitPerColor] = convert_row_bgr8_to_rgb8;
+    bgr8->convert_row_to[PixelBlueGreenRedReserved8BitPerColor] = copy_row;
+    bgr8->convert_row_to[PixelBitMask] = convert_row_bgr8_to_bit_mask;
+
+    // The screen's masks are the only bit mask layout, so it always copies to itself.
+    set_layout(bit_mask, PixelBitMask, 0, 8, 16);
+    global_pixel_format_data.is_bit_mask_supported =
+        buffer_data->pixel_format == PixelBitMask
+        && set_bit_mask_layout(bit_mask, &buffer_data->pixel_mask) == 0;
+    bit_mask->encode = encode_bit_mask;
+    bit_mask->decode = decode_bit_mask;
+    bit_mask->blend_row = is_byte_layout(bit_mask) ? blend_row_bytes : blend_row_bit_mask;
+    bit_mask->convert_row_to[PixelRedGreenBlueReserved8BitPerColor] =
+        convert_row_bit_mask_to_rgb8;
+    bit_mask->convert_row_to[PixelBlueGreenRedReserved8BitPerColor] =
+        convert_row_bit_mask_to_bgr8;
+    bit_mask->convert_row_to[PixelBitMask] = copy_row;
+
+    return pixel_format_get(buffer_data->pixel_format) == NULL ? -1 : 0;
+}
+
+const struct pixel_format *pixel_format_get(EFI_GRAPHICS_PIXEL_FORMAT type)
+{
+    if ((uint64_t)type >= PIXEL_FORMAT_NUMBER
+            || (type == PixelBitMask && !global_pixel_format_data.is_bit_mask_supported)) {
+        return NULL;
+    }
+
+    return &global_pixel_format_data.formats[type];
+}
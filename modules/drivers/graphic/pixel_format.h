@@ -0,0 +1,72 @@
+#ifndef _DRIVERS_GRAPHIC_PIXEL_FORMAT_H
+#define _DRIVERS_GRAPHIC_PIXEL_FORMAT_H
+
+#include <stdint.h>
+#include <uefi/uefi.h>
+
+#include "screen.h"
+
+/** Formats with pixels in memory, indexed by `EFI_GRAPHICS_PIXEL_FORMAT`. */
+#define PIXEL_FORMAT_NUMBER (PixelBitMask + 1)
+
+/** The top byte of a pixel is never a color. Surfaces keep alpha there. */
+#define PIXEL_FORMAT_ALPHA_SHIFT (24)
+#define PIXEL_FORMAT_ALPHA_MASK  (0xFF000000)
+
+struct pixel_format;
+
+typedef pixel_value_t (*pixel_encode_t)(const struct pixel_format *const format,
+        const struct pixel_color color);
+
+typedef struct pixel_color (*pixel_decode_t)(const struct pixel_format *const format,
+        pixel_value_t value);
+
+/**
+ * Convert `size` pixels of `in` to the format of `out`, keeping alpha.
+ */
+typedef void (*pixel_convert_row_t)(pixel_value_t *const out,
+        const struct pixel_format *const out_format, const pixel_value_t *const in,
+        const struct pixel_format *const in_format, uint64_t size);
+
+/**
+ * Mix `size` pixels of `in` over `out` by their alpha. Both are in `format`, and `out` keeps its
+ * own alpha.
+ */
+typedef void (*pixel_blend_row_t)(pixel_value_t *const out, const pixel_value_t *const in,
+        const struct pixel_format *const format, uint64_t size);
+
+/**
+ * How colors are laid out in a pixel, with routines specialized for the layout.
+ *
+ * Formats are resolved once, when a surface or frame buffer is set up, so drawing calls through
+ * the routines and never tests the format for a pixel.
+ */
+struct pixel_format {
+    EFI_GRAPHICS_PIXEL_FORMAT type;
+    /** Lowest bit and width of each color. Only bit mask formats read them per pixel. */
+    uint8_t red_shift;
+    uint8_t red_size;
+    uint8_t green_shift;
+    uint8_t green_size;
+    uint8_t blue_shift;
+    uint8_t blue_size;
+    pixel_encode_t encode;
+    pixel_decode_t decode;
+    pixel_blend_row_t blend_row;
+    /** Converters to every other format, indexed by the type of the destination. */
+    pixel_convert_row_t convert_row_to[PIXEL_FORMAT_NUMBER];
+};
+
+/**
+ * Bind the routines of every format. A screen in a bit mask format also gives the layout of
+ * `PixelBitMask`, from the masks the firmware reported for it.
+ *
+ * @return 0 on success, -1 if the screen's format can't be drawn in, such as a bit mask format
+ *         with a color that isn't a single run of at most 8 bits below the top byte.
+ */
+int pixel_format_initialize(const struct graphic_frame_buffer_data *const buffer_data);
+
+/** @return The format of `type`, or NULL if pixels can't be drawn in it. */
+const struct pixel_format *pixel_format_get(EFI_GRAPHICS_PIXEL_FORMAT type);
+
+#endif
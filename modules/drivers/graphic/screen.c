@@ -1,38 +1,227 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <general/memory.h>
+
+#include "pixel_format.h"
 #include "screen.h"
 
-typedef uint32_t pixel_value;
+/**
+ * Masks picking the foreground for four pixels, indexed by a nibble of a glyph row. The most
+ * significant bit is the leftmost pixel.
+ */
+static const uint32_t global_nibble_masks[16][4] = {
+    { 0x00000000, 0x00000000, 0x00000000, 0x00000000 },
+    { 0x00000000, 0x00000000, 0x00000000, 0xFFFFFFFF },
+    { 0x00000000, 0x00000000, 0xFFFFFFFF, 0x00000000 },
+    { 0x00000000, 0x00000000, 0xFFFFFFFF, 0xFFFFFFFF },
+    { 0x00000000, 0xFFFFFFFF, 0x00000000, 0x00000000 },
+    { 0x00000000, 0xFFFFFFFF, 0x00000000, 0xFFFFFFFF },
+    { 0x00000000, 0xFFFFFFFF, 0xFFFFFFFF, 0x00000000 },
+    { 0x00000000, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF },
+    { 0xFFFFFFFF, 0x00000000, 0x00000000, 0x00000000 },
+    { 0xFFFFFFFF, 0x00000000, 0x00000000, 0xFFFFFFFF },
+    { 0xFFFFFFFF, 0x00000000, 0xFFFFFFFF, 0x00000000 },
+    { 0xFFFFFFFF, 0x00000000, 0xFFFFFFFF, 0xFFFFFFFF },
+    { 0xFFFFFFFF, 0xFFFFFFFF, 0x00000000, 0x00000000 },
+    { 0xFFFFFFFF, 0xFFFFFFFF, 0x00000000, 0xFFFFFFFF },
+    { 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0x00000000 },
+    { 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF },
+};
+
+pixel_value_t screen_get_pixel_value(const struct graphic_frame_buffer_data *const buffer_data,
+        const struct pixel_color color)
+{
+    const struct pixel_format *const format = pixel_format_get(buffer_data->pixel_format);
+
+    return format == NULL ? 0 : format->encode(format, color);
+}
+
+static inline uint64_t min(uint64_t a, uint64_t b)
+{
+    return a < b ? a : b;
+}
 
-static inline pixel_value get_pixel_value(EFI_GRAPHICS_PIXEL_FORMAT pixel_format, struct pixel_color pixel)
+void screen_fill_span(pixel_value_t *out, uint64_t size, pixel_value_t value,
+        bool is_non_temporal)
 {
-    switch (pixel_format) {
-    case PixelRedGreenBlueReserved8BitPerColor:
-        return (0x00 << 24) + (pixel.blue << 16) + (pixel.green << 8) + pixel.red;
-    case PixelBlueGreenRedReserved8BitPerColor:
-        return (0x00 << 24) + (pixel.red << 16) + (pixel.green << 8) + pixel.blue;
-    default:
-        return 0;
+    const uint64_t pair = ((uint64_t)value << 32) | value;
+
+    if (size > 0 && (address_t)out % sizeof(pixel_pair_t) != 0) {
+        *out++ = value;
+        --size;
+    }
+
+    if (is_non_temporal) {
+        for (; size >= 2; size -= 2) {
+            memory_store_non_temporal_64((uint64_t *)out, pair);
+            out += 2;
+        }
+    } else {
+        for (; size >= 2; size -= 2) {
+            *(pixel_pair_t *)out = pair;
+            out += 2;
+        }
+    }
+
+    if (size > 0) {
+        *out = value;
     }
 }
 
-static inline void draw_pixel(const struct graphic_frame_buffer_data *const buffer_data,
-        uint64_t x, uint64_t y, struct pixel_color pixel)
+void screen_fill_rectangle(const struct graphic_frame_buffer_data *const buffer_data,
+        uint64_t x, uint64_t y, uint64_t width, uint64_t height, const struct pixel_color color)
 {
     if (x >= buffer_data->width || y >= buffer_data->height) {
         return;
     }
 
-    pixel_value *const frame_buffer = (pixel_value *)buffer_data->address;
+    const uint64_t visible_width = min(width, buffer_data->width - x);
+    const uint64_t visible_height = min(height, buffer_data->height - y);
+    const pixel_value_t value = screen_get_pixel_value(buffer_data, color);
+    const bool is_non_temporal = visible_width * visible_height * sizeof(pixel_value_t)
+        >= SCREEN_NON_TEMPORAL_FILL_SIZE;
 
-    frame_buffer[x + (y * buffer_data->pixel_per_scanline)]
-        = get_pixel_value(buffer_data->pixel_format, pixel);
+    pixel_value_t *out = (pixel_value_t *)buffer_data->address
+        + x + (y * buffer_data->pixel_per_scanline);
+
+    for (uint64_t row = 0; row < visible_height; ++row) {
+        screen_fill_span(out, visible_width, value, is_non_temporal);
+        out += buffer_data->pixel_per_scanline;
+    }
+
+    if (is_non_temporal) {
+        memory_fence_stores();
+    }
+}
+
+void screen_draw_horizontal_line(const struct graphic_frame_buffer_data *const buffer_data,
+        uint64_t x, uint64_t y, uint64_t width, const struct pixel_color color)
+{
+    screen_fill_rectangle(buffer_data, x, y, width, 1, color);
+}
+
+void screen_draw_vertical_line(const struct graphic_frame_buffer_data *const buffer_data,
+        uint64_t x, uint64_t y, uint64_t height, const struct pixel_color color)
+{
+    if (x >= buffer_data->width || y >= buffer_data->height) {
+        return;
+    }
+
+    const uint64_t visible_height = min(height, buffer_data->height - y);
+    const pixel_value_t value = screen_get_pixel_value(buffer_data, color);
+
+    pixel_value_t *out = (pixel_value_t *)buffer_data->address
+        + x + (y * buffer_data->pixel_per_scanline);
+
+    for (uint64_t row = 0; row < visible_height; ++row) {
+        *out = value;
+        out += buffer_data->pixel_per_scanline;
+    }
+}
+
+void screen_clear(const struct graphic_frame_buffer_data *const buffer_data,
+        const struct pixel_color color)
+{
+    screen_fill_rectangle(buffer_data, 0, 0, buffer_data->width, buffer_data->height, color);
 }
 
 void screen_draw_block(const struct graphic_frame_buffer_data *const buffer_data,
         uint64_t x, uint64_t y, const struct pixel_color color, const uint64_t block_size)
 {
-    for (uint64_t i = 0; i < block_size; ++i) {
-        for (uint64_t j = 0; j < block_size; ++j) {
-            draw_pixel(buffer_data, x + j, y + i, color);
+    screen_fill_rectangle(buffer_data, x, y, block_size, block_size, color);
+}
+
+static inline void expand_glyph_row(pixel_value_t *const out, uint8_t bits,
+        pixel_value_t foreground, pixel_value_t background)
+{
+    const pixel_value_t difference = foreground ^ background;
+    const uint32_t *const high = global_nibble_masks[bits >> 4];
+    const uint32_t *const low = global_nibble_masks[bits & 0x0F];
+
+    for (uint64_t i = 0; i < 4; ++i) {
+        out[i] = background ^ (difference & high[i]);
+        out[i + 4] = background ^ (difference & low[i]);
+    }
+}
+
+/**
+ * Render the top-left `width` by `height` pixels of a scaled glyph into `out`, which is `stride`
+ * pixels wide.
+ */
+static void render_glyph(pixel_value_t *out, uint64_t stride, uint64_t width, uint64_t height,
+        const uint8_t *const glyph, pixel_value_t foreground, pixel_value_t background,
+        uint64_t block_size)
+{
+    pixel_value_t values[SCREEN_GLYPH_WIDTH];
+
+    if (block_size == 1 && width == SCREEN_GLYPH_WIDTH) {
+        for (uint64_t row = 0; row < height; ++row) {
+            expand_glyph_row(out, glyph[row], foreground, background);
+            out += stride;
+        }
+        return;
+    }
+
+    for (uint64_t line = 0; line < height; ++line) {
+        if (line % block_size == 0) {
+            expand_glyph_row(values, glyph[line / block_size], foreground, background);
+        }
+
+        for (uint64_t i = 0; i < width; ++i) {
+            out[i] = values[i / block_size];
+        }
+        out += stride;
+    }
+}
+
+void screen_draw_glyph(const struct graphic_frame_buffer_data *const buffer_data,
+        uint64_t x, uint64_t y, const uint8_t *const glyph, uint64_t height,
+        const struct pixel_color foreground, const struct pixel_color background,
+        const uint64_t block_size)
+{
+    if (x >= buffer_data->width || y >= buffer_data->height || block_size == 0) {
+        return;
+    }
+
+    // Clip once for the whole glyph instead of every pixel.
+    const uint64_t visible_width = min(SCREEN_GLYPH_WIDTH * block_size, buffer_data->width - x);
+    const uint64_t visible_height = min(height * block_size, buffer_data->height - y);
+
+    pixel_value_t *const out = (pixel_value_t *)buffer_data->address
+        + x + (y * buffer_data->pixel_per_scanline);
+
+    render_glyph(out, buffer_data->pixel_per_scanline, visible_width, visible_height, glyph,
+            screen_get_pixel_value(buffer_data, foreground),
+            screen_get_pixel_value(buffer_data, background), block_size);
+}
+
+void screen_render_glyph(pixel_value_t *const tile, const uint8_t *const glyph, uint64_t height,
+        pixel_value_t foreground, pixel_value_t background, uint64_t block_size)
+{
+    const uint64_t width = SCREEN_GLYPH_WIDTH * block_size;
+
+    render_glyph(tile, width, width, height * block_size, glyph, foreground, background,
+            block_size);
+}
+
+void screen_draw_tile(const struct graphic_frame_buffer_data *const buffer_data,
+        uint64_t x, uint64_t y, const pixel_value_t *tile, uint64_t width, uint64_t height)
+{
+    if (x >= buffer_data->width || y >= buffer_data->height) {
+        return;
+    }
+
+    const uint64_t visible_width = min(width, buffer_data->width - x);
+    const uint64_t visible_height = min(height, buffer_data->height - y);
+
+    pixel_value_t *out = (pixel_value_t *)buffer_data->address
+        + x + (y * buffer_data->pixel_per_scanline);
+
+    for (uint64_t row = 0; row < visible_height; ++row) {
+        for (uint64_t i = 0; i < visible_width; ++i) {
+            out[i] = tile[i];
         }
+        out += buffer_data->pixel_per_scanline;
+        tile += width;
     }
 }
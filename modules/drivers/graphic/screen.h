@@ -1,10 +1,23 @@
 #ifndef _DRIVERS_GRAPHIC_SCREEN_H
 #define _DRIVERS_GRAPHIC_SCREEN_H
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <general/address.h>
 #include <uefi/uefi.h>
 
+/** Glyph rows are a byte each, so glyphs are 8 pixels wide. */
+#define SCREEN_GLYPH_WIDTH (8)
+
+/** Fills larger than this go around the cache, which they would only flush. */
+#define SCREEN_NON_TEMPORAL_FILL_SIZE (256 * 1024)
+
+/** A pixel in the format of the frame buffer. */
+typedef uint32_t pixel_value_t;
+
+/** Two pixels stored at once. It may alias the pixels it covers. */
+typedef uint64_t __attribute__((may_alias)) pixel_pair_t;
+
 struct pixel_color {
     uint8_t red;
     uint8_t green;
@@ -18,9 +31,64 @@ struct graphic_frame_buffer_data {
     uint64_t height;
     uint64_t pixel_per_scanline;
     EFI_GRAPHICS_PIXEL_FORMAT pixel_format;
+    /** Where each color is, for `PixelBitMask`. */
+    EFI_PIXEL_BITMASK pixel_mask;
 };
 
 void screen_draw_block(const struct graphic_frame_buffer_data *const buffer_data,
         uint64_t x, uint64_t y, const struct pixel_color pixel, const uint64_t block_size);
 
+/**
+ * Fill a rectangle, clipped to the screen.
+ *
+ * The pixel value is worked out once, and rows are filled 8 bytes at a time. Large fills use
+ * non-temporal stores so they don't flush the cache.
+ */
+void screen_fill_rectangle(const struct graphic_frame_buffer_data *const buffer_data,
+        uint64_t x, uint64_t y, uint64_t width, uint64_t height, const struct pixel_color color);
+
+void screen_draw_horizontal_line(const struct graphic_frame_buffer_data *const buffer_data,
+        uint64_t x, uint64_t y, uint64_t width, const struct pixel_color color);
+
+void screen_draw_vertical_line(const struct graphic_frame_buffer_data *const buffer_data,
+        uint64_t x, uint64_t y, uint64_t height, const struct pixel_color color);
+
+/**
+ * Fill `size` pixels from `out`, two at a time where the span is 8-byte aligned. Non-temporal
+ * stores have to be followed by `memory_fence_stores`.
+ */
+void screen_fill_span(pixel_value_t *out, uint64_t size, pixel_value_t value,
+        bool is_non_temporal);
+
+void screen_clear(const struct graphic_frame_buffer_data *const buffer_data,
+        const struct pixel_color color);
+
+/** Encode `color` through the routines bound for the format, or 0 if it can't be drawn in. */
+pixel_value_t screen_get_pixel_value(const struct graphic_frame_buffer_data *const buffer_data,
+        const struct pixel_color color);
+
+/**
+ * Draw a glyph with its top-left corner at (`x`, `y`), scaling each of its pixels to a square of
+ * `block_size`.
+ *
+ * `glyph` has a byte for each of the `height` rows, with the leftmost pixel in the most
+ * significant bit. Set bits are drawn in `foreground` and the others in `background`. Parts of the
+ * glyph outside the screen are clipped.
+ */
+void screen_draw_glyph(const struct graphic_frame_buffer_data *const buffer_data,
+        uint64_t x, uint64_t y, const uint8_t *const glyph, uint64_t height,
+        const struct pixel_color foreground, const struct pixel_color background,
+        const uint64_t block_size);
+
+/**
+ * Render a whole glyph like `screen_draw_glyph` into `tile`, which has to hold
+ * `SCREEN_GLYPH_WIDTH * block_size` by `height * block_size` pixels.
+ */
+void screen_render_glyph(pixel_value_t *const tile, const uint8_t *const glyph, uint64_t height,
+        pixel_value_t foreground, pixel_value_t background, uint64_t block_size);
+
+/** Copy a `width` by `height` tile of pixels to (`x`, `y`), clipped to the screen. */
+void screen_draw_tile(const struct graphic_frame_buffer_data *const buffer_data,
+        uint64_t x, uint64_t y, const pixel_value_t *tile, uint64_t width, uint64_t height);
+
 #endif
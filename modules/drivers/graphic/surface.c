@@ -0,0 +1,494 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <general/memory.h>
+
+#include "surface.h"
+
+/** Source pixels converted at once before they are scaled or blended. */
+#define SURFACE_CONVERT_CHUNK_SIZE (64)
+
+/** The part of a blit left after clipping. */
+struct blit_area {
+    pixel_value_t *destination;
+    const pixel_value_t *source;
+    uint64_t width;
+    uint64_t height;
+};
+
+static inline int64_t min(int64_t a, int64_t b)
+{
+    return a < b ? a : b;
+}
+
+static inline int64_t max(int64_t a, int64_t b)
+{
+    return a > b ? a : b;
+}
+
+static inline int64_t absolute(int64_t value)
+{
+    return value < 0 ? -value : value;
+}
+
+int surface_create(struct surface *const surface, uint64_t width, uint64_t height,
+        EFI_GRAPHICS_PIXEL_FORMAT pixel_format)
+{
+    const struct pixel_format *const format = pixel_format_get(pixel_format);
+    if (format == NULL) {
+        return -1;
+    }
+
+    const uint64_t size = width * height * sizeof(pixel_value_t);
+    const uint64_t frame_number = (size + MEMORY_FRAME_SIZE - 1) / MEMORY_FRAME_SIZE;
+
+    const frame_t frame = frame_allcoator_request(frame_number);
+    if (frame == MEMORY_FRAME_NULL) {
+        return -1;
+    }
+
+    surface->pixels = (pixel_value_t *)frame;
+    surface->width = width;
+    surface->height = height;
+    surface->stride = width;
+    surface->format = format;
+    surface->frame = frame;
+    surface->frame_number = frame_number;
+
+    return 0;
+}
+
+void surface_destroy(struct surface *const surface)
+{
+    if (surface->frame != MEMORY_FRAME_NULL) {
+        frame_allocator_free(surface->frame, surface->frame_number);
+    }
+
+    surface->pixels = NULL;
+    surface->width = 0;
+    surface->height = 0;
+    surface->frame = MEMORY_FRAME_NULL;
+    surface->frame_number = 0;
+}
+
+struct surface surface_from_frame_buffer(const struct graphic_frame_buffer_data *const buffer_data)
+{
+    return (struct surface){
+        .pixels = (pixel_value_t *)buffer_data->address,
+        .width = buffer_data->width,
+        .height = buffer_data->height,
+        .stride = buffer_data->pixel_per_scanline,
+        .format = pixel_format_get(buffer_data->pixel_format),
+        .frame = MEMORY_FRAME_NULL,
+        .frame_number = 0,
+    };
+}
+
+pixel_value_t surface_get_pixel_value(const struct surface *const surface,
+        const struct pixel_color color, uint8_t alpha)
+{
+    return surface->format->encode(surface->format, color)
+        | ((pixel_value_t)alpha << PIXEL_FORMAT_ALPHA_SHIFT);
+}
+
+static inline pixel_value_t *get_pixel(const struct surface *const surface, int64_t x, int64_t y)
+{
+    return surface->pixels + x + (y * surface->stride);
+}
+
+void surface_fill_rectangle(const struct surface *const surface, int64_t x, int64_t y,
+        uint64_t width, uint64_t height, pixel_value_t value)
+{
+    const int64_t left = max(x, 0);
+    const int64_t top = max(y, 0);
+    const int64_t right = min(x + (int64_t)width, (int64_t)surface->width);
+    const int64_t bottom = min(y + (int64_t)height, (int64_t)surface->height);
+
+    if (left >= right || top >= bottom) {
+        return;
+    }
+
+    const uint64_t visible_width = right - left;
+    const bool is_non_temporal = visible_width * (bottom - top) * sizeof(pixel_value_t)
+        >= SCREEN_NON_TEMPORAL_FILL_SIZE;
+
+    pixel_value_t *out = get_pixel(surface, left, top);
+    for (int64_t row = top; row < bottom; ++row) {
+        screen_fill_span(out, visible_width, value, is_non_temporal);
+        out += surface->stride;
+    }
+
+    if (is_non_temporal) {
+        memory_fence_stores();
+    }
+}
+
+void surface_draw_rectangle(const struct surface *const surface, int64_t x, int64_t y,
+        uint64_t width, uint64_t height, pixel_value_t value)
+{
+    if (width == 0 || height == 0) {
+        return;
+    }
+
+    surface_fill_rectangle(surface, x, y, width, 1, value);
+    surface_fill_rectangle(surface, x, y + height - 1, width, 1, value);
+    if (height > 2) {
+        surface_fill_rectangle(surface, x, y + 1, 1, height - 2, value);
+        surface_fill_rectangle(surface, x + width - 1, y + 1, 1, height - 2, value);
+    }
+}
+
+/**
+ * Offsets from `start` in `direction` that stay in [0, `size`), from `*low` to `*high` included.
+ * `*low` may be above `*high` when none does.
+ */
+static void get_visible_offsets(int64_t start, int64_t direction, int64_t size,
+        int64_t *const low, int64_t *const high)
+{
+    if (direction > 0) {
+        *low = -start;
+        *high = size - 1 - start;
+    } else {
+        *low = start - (size - 1);
+        *high = start;
+    }
+}
+
+void surface_draw_line(const struct surface *const surface, int64_t x0, int64_t y0, int64_t x1,
+        int64_t y1, pixel_value_t value)
+{
+    // Straight lines are spans, filled without stepping.
+    if (y0 == y1 || x0 == x1) {
+        surface_fill_rectangle(surface, min(x0, x1), min(y0, y1), absolute(x1 - x0) + 1,
+                absolute(y1 - y0) + 1, value);
+        return;
+    }
+
+    /*
+     * Bresenham's algorithm, taking a step along the major axis for each pixel. Step `k` moves
+     * `k * minor_length / major_length` along the minor axis, rounded with halves up, which
+     * is `(2 * k * minor_length + major_length) / (2 * major_length)`.
+     */
+    const bool is_x_major = absolute(x1 - x0) >= absolute(y1 - y0);
+    const int64_t major_start = is_x_major ? x0 : y0;
+    const int64_t minor_start = is_x_major ? y0 : x0;
+    const int64_t major_length = is_x_major ? absolute(x1 - x0) : absolute(y1 - y0);
+    const int64_t minor_length = is_x_major ? absolute(y1 - y0) : absolute(x1 - x0);
+    const int64_t major_direction = (is_x_major ? x0 < x1 : y0 < y1) ? 1 : -1;
+    const int64_t minor_direction = (is_x_major ? y0 < y1 : x0 < x1) ? 1 : -1;
+    const int64_t major_size = is_x_major ? surface->width : surface->height;
+    const int64_t minor_size = is_x_major ? surface->height : surface->width;
+
+    // Clip the steps to the surface first, so lines from far outside cost only what is drawn.
+    int64_t low;
+    int64_t high;
+
+    get_visible_offsets(major_start, major_direction, major_size, &low, &high);
+    int64_t first = max(low, 0);
+    int64_t last = min(high, major_length);
+
+    get_visible_offsets(minor_start, minor_direction, minor_size, &low, &high);
+    if (high < 0) {
+        return;
+    }
+    // The first step reaching `low` and the last one before passing `high`.
+    if (low > 0) {
+        first = max(first, (2 * major_length * low - major_length + 2 * minor_length - 1)
+                / (2 * minor_length));
+    }
+    last = min(last, (2 * major_length * (high + 1) - major_length - 1) / (2 * minor_length));
+
+    if (first > last) {
+        return;
+    }
+
+    const int64_t error_limit = 2 * major_length;
+    const int64_t numerator = 2 * first * minor_length + major_length;
+    int64_t error = numerator % error_limit;
+    int64_t major = major_start + major_direction * first;
+    int64_t minor = minor_start + minor_direction * (numerator / error_limit);
+
+    for (int64_t k = first; k <= last; ++k) {
+        if (is_x_major) {
+            *get_pixel(surface, major, minor) = value;
+        } else {
+            *get_pixel(surface, minor, major) = value;
+        }
+
+        major += major_direction;
+        error += 2 * minor_length;
+        if (error >= error_limit) {
+            error -= error_limit;
+            minor += minor_direction;
+        }
+    }
+}
+
+void surface_fill_circle(const struct surface *const surface, int64_t center_x, int64_t center_y,
+        uint64_t radius, pixel_value_t value)
+{
+    // Rounds the edge the way a midpoint circle does, without the flat spots of r^2.
+    const int64_t limit = (int64_t)(radius * radius + radius);
+    int64_t half_width = radius;
+
+    // Half widths only shrink moving away from the center, so each row starts from the last.
+    for (int64_t offset = 0; offset <= (int64_t)radius; ++offset) {
+        while (half_width > 0 && half_width * half_width + offset * offset > limit) {
+            --half_width;
+        }
+
+        const uint64_t width = 2 * half_width + 1;
+        surface_fill_rectangle(surface, center_x - half_width, center_y + offset, width, 1, value);
+        if (offset > 0) {
+            surface_fill_rectangle(surface, center_x - half_width, center_y - offset, width, 1,
+                    value);
+        }
+    }
+}
+
+/**
+ * Clip a span of `size` pixels at `position` on a destination `destination_size` long and at
+ * `source_position` on a source `source_size` long.
+ *
+ * @return false if nothing is left.
+ */
+static bool clip_span(int64_t *const position, int64_t *const source_position,
+        int64_t *const size, uint64_t destination_size, uint64_t source_size)
+{
+    if (*position < 0) {
+        *source_position -= *position;
+        *size += *position;
+        *position = 0;
+    }
+    if (*source_position < 0) {
+        *position -= *source_position;
+        *size += *source_position;
+        *source_position = 0;
+    }
+
+    if (*size <= 0 || *position >= (int64_t)destination_size
+            || *source_position >= (int64_t)source_size) {
+        return false;
+    }
+
+    *size = min(*size, min((int64_t)destination_size - *position,
+                (int64_t)source_size - *source_position));
+
+    return true;
+}
+
+static bool clip_blit(struct blit_area *const out, const struct surface *const destination,
+        int64_t x, int64_t y, const struct surface *const source, int64_t source_x,
+        int64_t source_y, uint64_t width, uint64_t height)
+{
+    int64_t visible_width = width;
+    int64_t visible_height = height;
+
+    if (!clip_span(&x, &source_x, &visible_width, destination->width, source->width)
+            || !clip_span(&y, &source_y, &visible_height, destination->height,
+                source->height)) {
+        return false;
+    }
+
+    out->destination = get_pixel(destination, x, y);
+    out->source = get_pixel(source, source_x, source_y);
+    out->width = visible_width;
+    out->height = visible_height;
+
+    return true;
+}
+
+/** The routine converting rows of `source` to the format of `destination`. */
+static inline pixel_convert_row_t get_converter(const struct surface *const destination,
+        const struct surface *const source)
+{
+    return source->format->convert_row_to[destination->format->type];
+}
+
+void surface_blit(const struct surface *const destination, int64_t x, int64_t y,
+        const struct surface *const source, int64_t source_x, int64_t source_y,
+        uint64_t width, uint64_t height)
+{
+    struct blit_area area;
+
+    if (!clip_blit(&area, destination, x, y, source, source_x, source_y, width, height)) {
+        return;
+    }
+
+    // Surfaces of one format get a plain copy.
+    const pixel_convert_row_t convert_row = get_converter(destination, source);
+    pixel_value_t *out = area.destination;
+    const pixel_value_t *in = area.source;
+
+    for (uint64_t row = 0; row < area.height; ++row) {
+        convert_row(out, destination->format, in, source->format, area.width);
+        out += destination->stride;
+        in += source->stride;
+    }
+}
+
+/** Fill a destination row from source pixels each `scale` wide, starting `phase` into the first. */
+static inline void scale_row(pixel_value_t *out, const pixel_value_t *in, uint64_t size,
+        uint64_t scale, uint64_t phase)
+{
+    while (size > 0) {
+        const pixel_value_t value = *in;
+        const uint64_t run = min(scale - phase, size);
+
+        for (uint64_t i = 0; i < run; ++i) {
+            out[i] = value;
+        }
+
+        out += run;
+        size -= run;
+        ++in;
+        phase = 0;
+    }
+}
+
+/** Scale a row of source pixels in another format, converting a chunk of them at a time. */
+static void scale_converted_row(pixel_value_t *out, const struct surface *const destination,
+        const pixel_value_t *in, const struct surface *const source, uint64_t size,
+        uint64_t scale, uint64_t phase)
+{
+    const pixel_convert_row_t convert_row = get_converter(destination, source);
+    pixel_value_t values[SURFACE_CONVERT_CHUNK_SIZE];
+
+    while (size > 0) {
+        const uint64_t count = min(SURFACE_CONVERT_CHUNK_SIZE, (phase + size + scale - 1) / scale);
+        const uint64_t chunk_size = min(count * scale - phase, size);
+
+        convert_row(values, destination->format, in, source->format, count);
+        scale_row(out, values, chunk_size, scale, phase);
+
+        out += chunk_size;
+        size -= chunk_size;
+        in += count;
+        phase = 0;
+    }
+}
+
+static void scale_rows(pixel_value_t *out, const struct surface *const destination,
+        const pixel_value_t *in, const struct surface *const source, uint64_t width,
+        uint64_t height, uint64_t scale, uint64_t column_phase, uint64_t row_phase)
+{
+    const pixel_convert_row_t copy_row = get_converter(destination, destination);
+    const bool is_converted = destination->format != source->format;
+
+    for (uint64_t row = 0; row < height; ++row) {
+        // Only the first row of a block is scaled, the rest copy it.
+        if (row == 0 || row_phase == 0) {
+            if (is_converted) {
+                scale_converted_row(out, destination, in, source, width, scale, column_phase);
+            } else {
+                scale_row(out, in, width, scale, column_phase);
+            }
+        } else {
+            copy_row(out, destination->format, out - destination->stride, destination->format,
+                    width);
+        }
+
+        out += destination->stride;
+        if (++row_phase == scale) {
+            row_phase = 0;
+            in += source->stride;
+        }
+    }
+}
+
+/**
+ * Clip a scaled span, first to the source so the destination moves by whole blocks, then to the
+ * destination which may cut a block. `size` becomes destination pixels and `phase` is how far the
+ * span starts into its first block.
+ *
+ * @return false if nothing is left.
+ */
+static bool clip_scaled_span(int64_t *const position, int64_t *const source_position,
+        int64_t *const size, uint64_t *const phase, uint64_t destination_size,
+        uint64_t source_size, uint64_t scale)
+{
+    if (*source_position < 0) {
+        *position -= *source_position * (int64_t)scale;
+        *size += *source_position;
+        *source_position = 0;
+    }
+    if (*size <= 0 || *source_position >= (int64_t)source_size) {
+        return false;
+    }
+
+    *size = min(*size, (int64_t)source_size - *source_position) * scale;
+    *phase = 0;
+
+    if (*position < 0) {
+        *size += *position;
+        *source_position += -*position / (int64_t)scale;
+        *phase = -*position % (int64_t)scale;
+        *position = 0;
+    }
+    if (*size <= 0 || *position >= (int64_t)destination_size) {
+        return false;
+    }
+
+    *size = min(*size, (int64_t)destination_size - *position);
+
+    return true;
+}
+
+void surface_blit_scaled(const struct surface *const destination, int64_t x, int64_t y,
+        const struct surface *const source, int64_t source_x, int64_t source_y,
+        uint64_t width, uint64_t height, uint64_t scale)
+{
+    if (scale <= 1) {
+        if (scale == 1) {
+            surface_blit(destination, x, y, source, source_x, source_y, width, height);
+        }
+        return;
+    }
+
+    int64_t visible_width = width;
+    int64_t visible_height = height;
+    uint64_t column_phase;
+    uint64_t row_phase;
+
+    if (!clip_scaled_span(&x, &source_x, &visible_width, &column_phase, destination->width,
+                source->width, scale)
+            || !clip_scaled_span(&y, &source_y, &visible_height, &row_phase,
+                destination->height, source->height, scale)) {
+        return;
+    }
+
+    scale_rows(get_pixel(destination, x, y), destination, get_pixel(source, source_x, source_y),
+            source, visible_width, visible_height, scale, column_phase, row_phase);
+}
+
+void surface_blend(const struct surface *const destination, int64_t x, int64_t y,
+        const struct surface *const source, int64_t source_x, int64_t source_y,
+        uint64_t width, uint64_t height)
+{
+    struct blit_area area;
+
+    if (!clip_blit(&area, destination, x, y, source, source_x, source_y, width, height)) {
+        return;
+    }
+
+    const struct pixel_format *const format = destination->format;
+    const pixel_convert_row_t convert_row = get_converter(destination, source);
+    pixel_value_t *out = area.destination;
+    const pixel_value_t *in = area.source;
+    pixel_value_t values[SURFACE_CONVERT_CHUNK_SIZE];
+
+    for (uint64_t row = 0; row < area.height; ++row) {
+        if (format == source->format) {
+            format->blend_row(out, in, format, area.width);
+        } else {
+            // Blending needs both in one format, so convert a chunk of the source at a time.
+            for (uint64_t i = 0; i < area.width; i += SURFACE_CONVERT_CHUNK_SIZE) {
+                const uint64_t count = min(SURFACE_CONVERT_CHUNK_SIZE, area.width - i);
+
+                convert_row(values, format, &in[i], source->format, count);
+                format->blend_row(&out[i], values, format, count);
+            }
+        }
+        out += destination->stride;
+        in += source->stride;
+    }
+}
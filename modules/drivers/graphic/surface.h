@@ -0,0 +1,94 @@
+#ifndef _DRIVERS_GRAPHIC_SURFACE_H
+#define _DRIVERS_GRAPHIC_SURFACE_H
+
+#include <stdint.h>
+#include <memory/frame_allocator.h>
+
+#include "pixel_format.h"
+#include "screen.h"
+
+/** Alpha of a pixel that covers whatever is under it. */
+#define SURFACE_ALPHA_OPAQUE (0xFF)
+
+/**
+ * A rectangle of pixels to draw into or copy from, either a frame buffer or memory of its own.
+ *
+ * Pixels are in `format`, with the reserved byte on top holding alpha for blending. Drawing takes
+ * signed positions and clips to the surface, so shapes may hang over any edge.
+ */
+struct surface {
+    pixel_value_t *pixels;
+    uint64_t width;
+    uint64_t height;
+    /** Pixels from the start of a row to the start of the next one. */
+    uint64_t stride;
+    /** Resolved once, so blits and blends call its routines without testing the format. */
+    const struct pixel_format *format;
+    /** Frames holding the pixels, or `MEMORY_FRAME_NULL` if the surface doesn't own them. */
+    frame_t frame;
+    uint64_t frame_number;
+};
+
+/**
+ * Allocate a `width` by `height` surface in `pixel_format`. Its pixels are not cleared.
+ *
+ * @return 0 on success, -1 if the format can't be drawn in or there is no memory for it.
+ */
+int surface_create(struct surface *const surface, uint64_t width, uint64_t height,
+        EFI_GRAPHICS_PIXEL_FORMAT pixel_format);
+
+/** Free the pixels of a surface made by `surface_create`. */
+void surface_destroy(struct surface *const surface);
+
+/**
+ * A surface drawing straight into a frame buffer, which it doesn't own. The frame buffer has to be
+ * in a format `pixel_format_get` knows.
+ */
+struct surface surface_from_frame_buffer(const struct graphic_frame_buffer_data *const buffer_data);
+
+pixel_value_t surface_get_pixel_value(const struct surface *const surface,
+        const struct pixel_color color, uint8_t alpha);
+
+void surface_fill_rectangle(const struct surface *const surface, int64_t x, int64_t y,
+        uint64_t width, uint64_t height, pixel_value_t value);
+
+void surface_draw_rectangle(const struct surface *const surface, int64_t x, int64_t y,
+        uint64_t width, uint64_t height, pixel_value_t value);
+
+/**
+ * Draw a line from (`x0`, `y0`) to (`x1`, `y1`), both ends included. Only the part on the surface
+ * is stepped over, so the ends may lie anywhere within 2^30 pixels of it.
+ */
+void surface_draw_line(const struct surface *const surface, int64_t x0, int64_t y0, int64_t x1,
+        int64_t y1, pixel_value_t value);
+
+void surface_fill_circle(const struct surface *const surface, int64_t center_x, int64_t center_y,
+        uint64_t radius, pixel_value_t value);
+
+/**
+ * Copy a `width` by `height` area at (`source_x`, `source_y`) of `source` to (`x`, `y`) of
+ * `destination`, clipped to both. Pixels are converted if the surfaces differ in format.
+ *
+ * The surfaces must not overlap.
+ */
+void surface_blit(const struct surface *const destination, int64_t x, int64_t y,
+        const struct surface *const source, int64_t source_x, int64_t source_y,
+        uint64_t width, uint64_t height);
+
+/**
+ * Blit like `surface_blit`, drawing each source pixel as a `scale` by `scale` block, the way the
+ * console scales glyphs by its pixel block size. `width` and `height` are in source pixels.
+ */
+void surface_blit_scaled(const struct surface *const destination, int64_t x, int64_t y,
+        const struct surface *const source, int64_t source_x, int64_t source_y,
+        uint64_t width, uint64_t height, uint64_t scale);
+
+/**
+ * Blit like `surface_blit`, mixing each source pixel over the destination by its alpha. The
+ * destination is treated as opaque and keeps its own alpha.
+ */
+void surface_blend(const struct surface *const destination, int64_t x, int64_t y,
+        const struct surface *const source, int64_t source_x, int64_t source_y,
+        uint64_t width, uint64_t height);
+
+#endif
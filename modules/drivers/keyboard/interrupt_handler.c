@@ -1,46 +1,143 @@
+#include <stddef.h>
 #include <cpu/port.h>
-#include <general/circular_queue.h>
-#include <interrupts/control_register.h>
-#include <interrupts/controller.h>
+#include <cpu/timestamp_counter.h>
+#include <interrupts/deferred_work.h>
 #include <interrupts/exception_vector_size.h>
+#include <interrupts/handler.h>
+#include <sync/spsc_ring.h>
+#include <task/wait_queue.h>
+#include <time/clock.h>
 
 #include "interrupt_handler.h"
 #include "port.h"
 
 #define GLOBAL_KEYBOARD_QUEUE_BUFFER_SIZE (64)
 
-static struct circular_queue_data global_keyboard_queue_data;
-static scancode_t global_keyboard_queue_buffer[GLOBAL_KEYBOARD_QUEUE_BUFFER_SIZE];
+#define KEYBOARD_INTERRUPT_VECTOR (EXCEPTION_VECTOR_SIZE + 1)
 
-void keyboard_interrupt_handler_initialize(void)
+/**
+ * The deferred work gets the scancode in the low byte and the time-stamp of the interrupt above
+ * it. The time-stamp loses its top bits, which only matters across a wraparound every few hundred
+ * days, and latencies are computed modulo the same width.
+ */
+#define KEYBOARD_TIMESTAMP_SHIFT (8)
+#define KEYBOARD_TIMESTAMP_MASK  ((1ULL << (64 - KEYBOARD_TIMESTAMP_SHIFT)) - 1)
+
+struct keyboard_event {
+    scancode_t scancode;
+    /** Time-stamp counter value read by the interrupt handler. */
+    uint64_t timestamp;
+};
+
+struct keyboard_interrupt_handler_data {
+    /**
+     * Deferred work on the processor getting keyboard interrupts is the only producer, as
+     * deferred work never nests, and the thread reading input is the only consumer, so the ring
+     * needs no lock.
+     */
+    struct spsc_ring queue;
+    struct keyboard_event queue_buffer[GLOBAL_KEYBOARD_QUEUE_BUFFER_SIZE];
+    /** Threads waiting for a scancode. */
+    struct wait_queue wait_queue;
+    keyboard_interrupt_handler_callback_t callback;
+    /** Nanoseconds from the interrupt to the consumer, recorded by the consumer. */
+    struct histogram latency;
+};
+
+static struct keyboard_interrupt_handler_data global_keyboard_interrupt_handler_data;
+
+int keyboard_interrupt_handler_initialize(void)
 {
-    circular_queue_initialize(&global_keyboard_queue_data,
-            global_keyboard_queue_buffer, sizeof(global_keyboard_queue_buffer), sizeof(scancode_t));
+    struct keyboard_interrupt_handler_data *const data = &global_keyboard_interrupt_handler_data;
+
+    if (spsc_ring_initialize(&data->queue, data->queue_buffer,
+                GLOBAL_KEYBOARD_QUEUE_BUFFER_SIZE, sizeof(struct keyboard_event)) != 0) {
+        return -1;
+    }
+
+    wait_queue_initialize(&data->wait_queue);
+    data->callback = NULL;
+    histogram_initialize(&data->latency);
+
+    return interrupt_register(KEYBOARD_INTERRUPT_VECTOR, keyboard_interrupt_handler, NULL);
 }
 
-void keyboard_interrupt_handler(const uint8_t interrupt_number)
+static void push_scancode(uint64_t data)
 {
-    if (is_output_buffer_full() == false) {
+    struct keyboard_interrupt_handler_data *const handler_data =
+        &global_keyboard_interrupt_handler_data;
+    const struct keyboard_event event = {
+        .scancode = (scancode_t)data,
+        .timestamp = data >> KEYBOARD_TIMESTAMP_SHIFT
+    };
+
+    if (spsc_ring_push(&handler_data->queue, &event) != 0) {
         return;
     }
 
-    /*
-     * TODO: Note that internal state of the queue might be invalid because of additional interrupt
-     * occured while processing code below.
-     */
+    wait_queue_wake_all(&handler_data->wait_queue);
+
+    const keyboard_interrupt_handler_callback_t callback = handler_data->callback;
+    if (callback != NULL) {
+        callback();
+    }
+}
+
+int keyboard_interrupt_handler(const struct interrupt_frame *const frame, void *const context)
+{
+    (void)frame;
+    (void)context;
+
+    if (is_output_buffer_full() == false) {
+        return INTERRUPT_UNHANDLED;
+    }
+
+    // Reading the scancode acknowledges the keyboard. Queuing it is left to the deferred work.
     const scancode_t scancode = port_read(keyboard0);
-    circular_queue_push(&global_keyboard_queue_data, &scancode);
-    interrupt_controller_notify_end(interrupt_number - EXCEPTION_VECTOR_SIZE);
+    deferred_work_queue(push_scancode,
+            (timestamp_counter_read() << KEYBOARD_TIMESTAMP_SHIFT) | scancode);
+
+    return INTERRUPT_HANDLED;
 }
 
 bool keyboard_interrupt_handler_is_queue_empty(void)
 {
-    return global_keyboard_queue_data.entry_number == 0;
+    return spsc_ring_is_empty(&global_keyboard_interrupt_handler_data.queue);
+}
+
+static bool has_scancode(void *const context)
+{
+    (void)context;
+
+    return !keyboard_interrupt_handler_is_queue_empty();
+}
+
+void keyboard_interrupt_handler_wait(void)
+{
+    wait_queue_wait(&global_keyboard_interrupt_handler_data.wait_queue, has_scancode, NULL);
 }
 
 scancode_t keyboard_interrupt_handler_get_scancode(void)
 {
-    scancode_t scancode;
-    circular_queue_pop(&global_keyboard_queue_data, &scancode);
-    return scancode;
+    struct keyboard_interrupt_handler_data *const data = &global_keyboard_interrupt_handler_data;
+    struct keyboard_event event;
+
+    spsc_ring_pop(&data->queue, &event);
+
+    const uint64_t cycles =
+        ((timestamp_counter_read() & KEYBOARD_TIMESTAMP_MASK) - event.timestamp)
+        & KEYBOARD_TIMESTAMP_MASK;
+    histogram_record(&data->latency, clock_convert_cycles_to_nanoseconds(cycles));
+
+    return event.scancode;
+}
+
+void keyboard_interrupt_handler_set_callback(keyboard_interrupt_handler_callback_t callback)
+{
+    global_keyboard_interrupt_handler_data.callback = callback;
+}
+
+void keyboard_interrupt_handler_get_latency(struct histogram *const out)
+{
+    *out = global_keyboard_interrupt_handler_data.latency;
 }
@@ -3,15 +3,37 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <general/histogram.h>
+#include <interrupts/handler.h>
 
 typedef uint8_t scancode_t;
 
-void keyboard_interrupt_handler_initialize(void);
+/**
+ * A function called when a scancode is queued.
+ *
+ * It runs as deferred work on the processor getting keyboard interrupts, so it must not block.
+ */
+typedef void (*keyboard_interrupt_handler_callback_t)(void);
 
-void keyboard_interrupt_handler(const uint8_t interrupt_number);
+int keyboard_interrupt_handler_initialize(void);
+
+int keyboard_interrupt_handler(const struct interrupt_frame *const frame, void *const context);
 
 bool keyboard_interrupt_handler_is_queue_empty(void);
 
+/** Block the current thread until a scancode is queued. */
+void keyboard_interrupt_handler_wait(void);
+
+/**
+ * Pop a scancode and record how long it took to get here from the interrupt.
+ *
+ * Only a single thread may consume scancodes.
+ */
 scancode_t keyboard_interrupt_handler_get_scancode(void);
 
+void keyboard_interrupt_handler_set_callback(keyboard_interrupt_handler_callback_t callback);
+
+/** Copy the histogram of nanoseconds from keyboard interrupts to the consumer. */
+void keyboard_interrupt_handler_get_latency(struct histogram *const out);
+
 #endif
@@ -1,3 +1,4 @@
+#include <stddef.h>
 #include <cpu/port.h>
 
 #include "port.h"
@@ -30,7 +31,7 @@ static inline void wait_while_input_buffer_is_full(void)
 
 static inline void wait_while_keyboard_interrupt_handler_is_queue_empty(void)
 {
-    while (keyboard_interrupt_handler_is_queue_empty() == true);
+    keyboard_interrupt_handler_wait();
 }
 
 static inline void write_command_on_port0(uint8_t command)
@@ -108,7 +109,9 @@ int keyboard_initialize(void)
     global_keyboard_data.is_scroll_lock_on = false;
     global_keyboard_data.is_shift_down = false;
 
-    keyboard_interrupt_handler_initialize();
+    if (keyboard_interrupt_handler_initialize() != 0) {
+        return -1;
+    }
 
     port_write(keyboard1, KEYBOARD_COMMAND_ACTIVATE_CONTROLLER);
     write_command_on_port0(KEYBOARD_COMMAND_ACTIVATE_KEYBOARD);
@@ -171,6 +174,16 @@ bool keyboard_is_buffer_empty(void)
     return keyboard_interrupt_handler_is_queue_empty();
 }
 
+void keyboard_set_handler(keyboard_handler_t handler)
+{
+    keyboard_interrupt_handler_set_callback(handler);
+}
+
+void keyboard_get_latency(struct histogram *const out)
+{
+    keyboard_interrupt_handler_get_latency(out);
+}
+
 bool keyboard_is_capslock_on(void)
 {
     return global_keyboard_data.is_capslock_on;
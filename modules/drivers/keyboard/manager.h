@@ -2,9 +2,18 @@
 #define _DRIVERS_KEYBOARD_MANAGER_H
 
 #include <stdbool.h>
+#include <general/histogram.h>
 
 #include "ascii.h"
 
+/**
+ * A function called when input arrives, for consumers that don't want to block in
+ * `keyboard_get_input`.
+ *
+ * It runs as deferred work, so it must not block. It should wake up the thread reading the input.
+ */
+typedef void (*keyboard_handler_t)(void);
+
 struct keyboard_data {
     bool is_capslock_on;
     bool is_numlock_on;
@@ -18,10 +27,20 @@ void keyboard_enable_a20(void);
 
 void keyboard_reset_processor(void);
 
+/**
+ * Read a key, blocking the current thread until one is pressed.
+ *
+ * @return 0 on success, -1 if the scancode was not a key press.
+ */
 int keyboard_get_input(char *const out);
 
 bool keyboard_is_buffer_empty(void);
 
+void keyboard_set_handler(keyboard_handler_t handler);
+
+/** Copy the histogram of nanoseconds from keyboard interrupts to the reader of the input. */
+void keyboard_get_latency(struct histogram *const out);
+
 bool keyboard_is_capslock_on(void);
 
 bool keyboard_is_numlock_on(void);
@@ -0,0 +1,194 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <cpu/port.h>
+#include <interrupts/control_register.h>
+#include <interrupts/exception_vector_size.h>
+#include <interrupts/handler.h>
+
+#include "rtc.h"
+
+/**
+ * A driver for the MC146818 compatible real time clock in the CMOS memory.
+ *
+ * A register is selected by writing its index to `cmos0`, then read or written through `cmos1`.
+ *
+ * The clock updates its time registers once a second. Reading them during the update may return a
+ * mix of the old and new time, so they're read until two reads agree.
+ */
+
+#define RTC_INTERRUPT_VECTOR (EXCEPTION_VECTOR_SIZE + 8)
+
+#define RTC_REGISTER_SECOND   (0x00)
+#define RTC_REGISTER_MINUTE   (0x02)
+#define RTC_REGISTER_HOUR     (0x04)
+#define RTC_REGISTER_DAY      (0x07)
+#define RTC_REGISTER_MONTH    (0x08)
+#define RTC_REGISTER_YEAR     (0x09)
+#define RTC_REGISTER_STATUS_A (0x0A)
+#define RTC_REGISTER_STATUS_B (0x0B)
+#define RTC_REGISTER_STATUS_C (0x0C)
+
+/** An update of the time registers is in progress, or starts in 244 microseconds. */
+#define RTC_STATUS_A_UPDATE_IN_PROGRESS (0x80)
+
+/** Bits of the status register B. */
+#define RTC_STATUS_B_24_HOUR            (0x02)
+#define RTC_STATUS_B_BINARY             (0x04)
+#define RTC_STATUS_B_UPDATE_INTERRUPT   (0x10)
+#define RTC_STATUS_B_ALARM_INTERRUPT    (0x20)
+#define RTC_STATUS_B_PERIODIC_INTERRUPT (0x40)
+
+/** Set in the status register C if the interrupt was raised by an update. */
+#define RTC_STATUS_C_UPDATE_INTERRUPT (0x10)
+
+/** Set on the hour in the 12 hour mode after noon. */
+#define RTC_HOUR_PM (0x80)
+
+#define RTC_READ_TRY_NUMBER (8)
+/** Registers are only 2 digits, so the century is assumed. */
+#define RTC_CENTURY         (2000)
+
+struct rtc_data {
+    rtc_update_handler_t update_handler;
+};
+
+static struct rtc_data global_rtc_data;
+
+static inline uint8_t read_register(uint8_t index)
+{
+    port_write(cmos0, index);
+    return port_read(cmos1);
+}
+
+static inline void write_register(uint8_t index, uint8_t value)
+{
+    port_write(cmos0, index);
+    port_write(cmos1, value);
+}
+
+static inline uint8_t convert_bcd_to_binary(uint8_t value)
+{
+    return (value >> 4) * 10 + (value & 0x0F);
+}
+
+static void read_time_registers(struct rtc_time *const out)
+{
+    while (read_register(RTC_REGISTER_STATUS_A) & RTC_STATUS_A_UPDATE_IN_PROGRESS);
+
+    out->second = read_register(RTC_REGISTER_SECOND);
+    out->minute = read_register(RTC_REGISTER_MINUTE);
+    out->hour = read_register(RTC_REGISTER_HOUR);
+    out->day = read_register(RTC_REGISTER_DAY);
+    out->month = read_register(RTC_REGISTER_MONTH);
+    out->year = read_register(RTC_REGISTER_YEAR);
+}
+
+static inline bool is_same_time(const struct rtc_time *const a, const struct rtc_time *const b)
+{
+    return a->second == b->second && a->minute == b->minute && a->hour == b->hour
+        && a->day == b->day && a->month == b->month && a->year == b->year;
+}
+
+static void normalize_time(struct rtc_time *const time, uint8_t status)
+{
+    const bool is_pm = (time->hour & RTC_HOUR_PM) != 0;
+    time->hour &= ~RTC_HOUR_PM;
+
+    if (!(status & RTC_STATUS_B_BINARY)) {
+        time->second = convert_bcd_to_binary(time->second);
+        time->minute = convert_bcd_to_binary(time->minute);
+        time->hour = convert_bcd_to_binary(time->hour);
+        time->day = convert_bcd_to_binary(time->day);
+        time->month = convert_bcd_to_binary(time->month);
+        time->year = convert_bcd_to_binary(time->year);
+    }
+
+    // Hours run 12, 1, ..., 11 in the 12 hour mode.
+    if (!(status & RTC_STATUS_B_24_HOUR)) {
+        time->hour %= 12;
+        if (is_pm) {
+            time->hour += 12;
+        }
+    }
+
+    time->year += RTC_CENTURY;
+}
+
+int rtc_read(struct rtc_time *const out)
+{
+    struct rtc_time previous;
+    struct rtc_time current;
+
+    const uint64_t flags = interrupts_save_and_disable();
+
+    read_time_registers(&current);
+
+    for (uint64_t i = 0; i < RTC_READ_TRY_NUMBER; ++i) {
+        previous = current;
+        read_time_registers(&current);
+
+        if (is_same_time(&previous, &current)) {
+            const uint8_t status = read_register(RTC_REGISTER_STATUS_B);
+            interrupts_restore(flags);
+
+            normalize_time(&current, status);
+            *out = current;
+
+            return 0;
+        }
+    }
+
+    interrupts_restore(flags);
+
+    return -1;
+}
+
+static int handle_interrupt(const struct interrupt_frame *const frame, void *const context)
+{
+    (void)frame;
+    (void)context;
+
+    // The RTC raises no more interrupts until the status register C is read.
+    const uint8_t status = read_register(RTC_REGISTER_STATUS_C);
+
+    if ((status & RTC_STATUS_C_UPDATE_INTERRUPT) && global_rtc_data.update_handler != NULL) {
+        global_rtc_data.update_handler();
+    }
+
+    return INTERRUPT_HANDLED;
+}
+
+int rtc_initialize(void)
+{
+    global_rtc_data.update_handler = NULL;
+
+    const uint64_t flags = interrupts_save_and_disable();
+
+    uint8_t status = read_register(RTC_REGISTER_STATUS_B);
+    status &= ~(RTC_STATUS_B_UPDATE_INTERRUPT | RTC_STATUS_B_ALARM_INTERRUPT
+            | RTC_STATUS_B_PERIODIC_INTERRUPT);
+    write_register(RTC_REGISTER_STATUS_B, status);
+    read_register(RTC_REGISTER_STATUS_C);
+
+    interrupts_restore(flags);
+
+    return interrupt_register(RTC_INTERRUPT_VECTOR, handle_interrupt, NULL);
+}
+
+void rtc_set_update_handler(rtc_update_handler_t handler)
+{
+    const uint64_t flags = interrupts_save_and_disable();
+
+    global_rtc_data.update_handler = handler;
+
+    uint8_t status = read_register(RTC_REGISTER_STATUS_B);
+    if (handler != NULL) {
+        status |= RTC_STATUS_B_UPDATE_INTERRUPT;
+    } else {
+        status &= ~RTC_STATUS_B_UPDATE_INTERRUPT;
+    }
+    write_register(RTC_REGISTER_STATUS_B, status);
+    read_register(RTC_REGISTER_STATUS_C);
+
+    interrupts_restore(flags);
+}
@@ -0,0 +1,42 @@
+#ifndef _DRIVERS_RTC_RTC_H
+#define _DRIVERS_RTC_RTC_H
+
+#include <stdint.h>
+
+struct rtc_time {
+    uint16_t year;
+    uint8_t month;
+    uint8_t day;
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t second;
+};
+
+/**
+ * A function called right after the clock moved on to the next second.
+ *
+ * It runs in the interrupt context with interrupts disabled. The time can be read with `rtc_read`
+ * without waiting for almost a second from then.
+ */
+typedef void (*rtc_update_handler_t)(void);
+
+/**
+ * Disable the interrupts of the RTC and attach its handler to IRQ 8.
+ *
+ * @return 0 on success, -1 if the interrupt handler can't be registered.
+ */
+int rtc_initialize(void);
+
+/**
+ * Read the current time. The RTC keeps no time zone, so it's assumed to be UTC.
+ *
+ * This waits for an update in progress to finish, which takes up to 2 milliseconds.
+ *
+ * @return 0 on success, -1 if the time didn't settle.
+ */
+int rtc_read(struct rtc_time *const out);
+
+/** Call `handler` on every update of the RTC, or stop the update interrupt if it's NULL. */
+void rtc_set_update_handler(rtc_update_handler_t handler);
+
+#endif
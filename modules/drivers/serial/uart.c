@@ -0,0 +1,89 @@
+#include <stdarg.h>
+#include <cpu/port.h>
+#include <general/string.h>
+
+#include "uart.h"
+
+/**
+ * A polling driver for the 16550 UART of the first serial port.
+ *
+ * It's meant for dumping diagnostics to the host, e.g. `qemu -serial stdio`, so the driver never
+ * uses interrupts and only transmits.
+ *
+ * Registers are selected by the offset from the base port:
+ * serial0: Transmit buffer, or low byte of the divisor latch when DLAB is set.
+ * serial1: Interrupt enable, or high byte of the divisor latch when DLAB is set.
+ * serial2: FIFO control.
+ * serial3: Line control.
+ * serial4: Modem control.
+ * serial5: Line status.
+ */
+
+#define UART_PRINT_FORMAT_BUFFER_SIZE (1024)
+
+/** Divide the 115200 Hz base clock by 1 to transmit at 115200 baud. */
+#define UART_DIVISOR (1)
+
+/** Set the divisor latch access bit (DLAB) to program the divisor. */
+#define UART_LINE_CONTROL_DLAB (0x80)
+/** 8 data bits, no parity and 1 stop bit. */
+#define UART_LINE_CONTROL_8N1  (0x03)
+/** Enable and clear both FIFOs and set the receive trigger level to 14 bytes. */
+#define UART_FIFO_CONTROL      (0xC7)
+/** Assert DTR and RTS. OUT2 stays clear so the UART never raises interrupts. */
+#define UART_MODEM_CONTROL     (0x03)
+/** Transmit holding register is empty. */
+#define UART_LINE_STATUS_THRE  (0x20)
+
+void uart_initialize(void)
+{
+    port_write(serial1, 0x00);
+
+    port_write(serial3, UART_LINE_CONTROL_DLAB);
+    port_write(serial0, UART_DIVISOR & 0xFF);
+    port_write(serial1, (UART_DIVISOR >> 8) & 0xFF);
+
+    port_write(serial3, UART_LINE_CONTROL_8N1);
+    port_write(serial2, UART_FIFO_CONTROL);
+    port_write(serial4, UART_MODEM_CONTROL);
+}
+
+static inline void write_byte(char ch)
+{
+    while ((port_read(serial5) & UART_LINE_STATUS_THRE) == 0);
+    port_write(serial0, ch);
+}
+
+void uart_print_char(char ch)
+{
+    if (ch == '\n') {
+        write_byte('\r');
+    }
+
+    write_byte(ch);
+}
+
+int uart_print_string(const char *const string)
+{
+    for (uint64_t i = 0; string[i] != '\0'; ++i) {
+        uart_print_char(string[i]);
+    }
+
+    return 0;
+}
+
+int uart_print_format(const char *const format, ...)
+{
+    char buffer[UART_PRINT_FORMAT_BUFFER_SIZE];
+
+    va_list ap;
+    va_start(ap, format);
+    int result = string_format_va(buffer, sizeof(buffer), format, ap);
+    va_end(ap);
+
+    if (result != 0) {
+        return -1;
+    }
+
+    return uart_print_string(buffer);
+}
@@ -0,0 +1,12 @@
+#ifndef _DRIVERS_SERIAL_UART_H
+#define _DRIVERS_SERIAL_UART_H
+
+void uart_initialize(void);
+
+void uart_print_char(char ch);
+
+int uart_print_string(const char *const string);
+
+int uart_print_format(const char *const format, ...);
+
+#endif
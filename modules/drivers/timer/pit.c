@@ -0,0 +1,59 @@
+#include <cpu/port.h>
+#include <debug/assert.h>
+
+#include "pit.h"
+
+/**
+ * A driver for the 8254 programmable interval timer.
+ *
+ * The PIT is only used as a reference to calibrate other timers. Its low frequency and slow port
+ * access make it a poor clock source by itself.
+ *
+ * Each bit of the command sent through `pit3` has following meanings:
+ * [0]: Count in BCD. Clear this bit to count in binary.
+ * [1, 3]: Operating mode.
+ * [4, 5]: Access mode. 3 means the low byte is written first, then the high byte.
+ * [6, 7]: Channel.
+ */
+
+/** Channel 0, low and high byte, mode 0 (interrupt on terminal count), binary. */
+#define PIT_COMMAND_CHANNEL0_ONESHOT (0x30)
+/** Channel 2, low and high byte, mode 0 (interrupt on terminal count), binary. */
+#define PIT_COMMAND_CHANNEL2_ONESHOT (0xB0)
+
+/** Gate input of the channel 2. The channel counts only while this bit is set. */
+#define SYSTEM_CONTROL_PIT2_GATE   (0x01)
+/** Connect the channel 2 output to the PC speaker. */
+#define SYSTEM_CONTROL_SPEAKER     (0x02)
+/** Output of the channel 2. Set when the counter reaches the terminal count in mode 0. */
+#define SYSTEM_CONTROL_PIT2_OUTPUT (0x20)
+
+void pit_wait(uint16_t tick_number)
+{
+    assert(tick_number > 0, "PIT count must be positive");
+
+    uint8_t control = port_read(system_control);
+    control &= ~(SYSTEM_CONTROL_SPEAKER | SYSTEM_CONTROL_PIT2_GATE);
+    port_write(system_control, control);
+
+    port_write(pit3, PIT_COMMAND_CHANNEL2_ONESHOT);
+    port_write(pit2, tick_number & 0xFF);
+    port_write(pit2, (tick_number >> 8) & 0xFF);
+
+    // Counting starts on the rising edge of the gate.
+    port_write(system_control, control | SYSTEM_CONTROL_PIT2_GATE);
+
+    while ((port_read(system_control) & SYSTEM_CONTROL_PIT2_OUTPUT) == 0);
+
+    port_write(system_control, control);
+}
+
+void pit_stop(void)
+{
+    /*
+     * Mode 0 fires once on the terminal count and then stays silent, unlike the rate generator
+     * modes which reload the count. Writing only the command byte leaves the counter waiting for a
+     * count, so the channel never reaches the terminal count.
+     */
+    port_write(pit3, PIT_COMMAND_CHANNEL0_ONESHOT);
+}
@@ -0,0 +1,22 @@
+#ifndef _DRIVERS_TIMER_PIT_H
+#define _DRIVERS_TIMER_PIT_H
+
+#include <stdint.h>
+
+/** Input clock of the 8254 programmable interval timer in Hz. */
+#define PIT_FREQUENCY (1193182)
+
+/**
+ * Busy-wait for `tick_number` PIT ticks using channel 2.
+ *
+ * Channel 2 is not wired to the interrupt controller, so this can be used with interrupts disabled
+ * and before any timer interrupt is set up.
+ *
+ * `tick_number` must be in range [1, 65535].
+ */
+void pit_wait(uint16_t tick_number);
+
+/** Stop channel 0 from generating periodic interrupts on IRQ 0. */
+void pit_stop(void);
+
+#endif
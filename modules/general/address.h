@@ -1,8 +1,13 @@
 #ifndef _GENERAL_ADDRESS_H
 #define _GENERAL_ADDRESS_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 typedef uint64_t address_t;
 
+/** Get the structure of `ContainerType` that embeds the member at `MemberAddress`. */
+#define container_of(MemberAddress, ContainerType, MemberName) \
+    ((ContainerType *)((address_t)(MemberAddress) - offsetof(ContainerType, MemberName)))
+
 #endif
@@ -0,0 +1,29 @@
+#include "histogram.h"
+
+#define HISTOGRAM_LINE_BUFFER_SIZE (512)
+
+void histogram_print(string_print_t print, const char *const name,
+        const struct histogram *const histogram)
+{
+    char line[HISTOGRAM_LINE_BUFFER_SIZE];
+    uint64_t size = 0;
+
+    if (string_format(line, sizeof(line), "  %s", name) != 0) {
+        return;
+    }
+    size = string_length(line);
+
+    for (uint64_t i = 0; i < HISTOGRAM_BUCKET_NUMBER; ++i) {
+        if (histogram->buckets[i] == 0) {
+            continue;
+        }
+
+        if (string_format(&line[size], sizeof(line) - size, " <2^%lu:%lu",
+                    i, histogram->buckets[i]) != 0) {
+            break;
+        }
+        size += string_length(&line[size]);
+    }
+
+    print("%s\n", line);
+}
@@ -0,0 +1,71 @@
+#ifndef _GENERAL_HISTOGRAM_H
+#define _GENERAL_HISTOGRAM_H
+
+#include <stdint.h>
+#include <general/string.h>
+
+#define HISTOGRAM_BUCKET_NUMBER (32)
+
+/**
+ * A histogram with logarithmic buckets.
+ *
+ * Bucket 0 counts the value 0 and bucket `i` counts values in [2^(i - 1), 2^i). Values too large
+ * for the buckets are counted in the last bucket.
+ *
+ * Recording is not atomic. Each histogram should have a single writer, such as a processor
+ * recording into its own histogram with interrupts disabled.
+ */
+struct histogram {
+    uint64_t buckets[HISTOGRAM_BUCKET_NUMBER];
+};
+
+static inline void histogram_initialize(struct histogram *const histogram)
+{
+    for (uint64_t i = 0; i < HISTOGRAM_BUCKET_NUMBER; ++i) {
+        histogram->buckets[i] = 0;
+    }
+}
+
+static inline uint64_t histogram_get_bucket_index(uint64_t value)
+{
+    if (value == 0) {
+        return 0;
+    }
+
+    const uint64_t index = 64 - __builtin_clzll(value);
+
+    return index < HISTOGRAM_BUCKET_NUMBER ? index : HISTOGRAM_BUCKET_NUMBER - 1;
+}
+
+static inline void histogram_record(struct histogram *const histogram, uint64_t value)
+{
+    ++histogram->buckets[histogram_get_bucket_index(value)];
+}
+
+/** Add every bucket of `source` to `destination`. */
+static inline void histogram_merge(struct histogram *const destination,
+        const struct histogram *const source)
+{
+    for (uint64_t i = 0; i < HISTOGRAM_BUCKET_NUMBER; ++i) {
+        destination->buckets[i] += source->buckets[i];
+    }
+}
+
+static inline uint64_t histogram_get_count(const struct histogram *const histogram)
+{
+    uint64_t count = 0;
+
+    for (uint64_t i = 0; i < HISTOGRAM_BUCKET_NUMBER; ++i) {
+        count += histogram->buckets[i];
+    }
+
+    return count;
+}
+
+/**
+ * Print non-empty buckets of `histogram` in a line, e.g. "  name <2^3:12 <2^4:5".
+ */
+void histogram_print(string_print_t print, const char *const name,
+        const struct histogram *const histogram);
+
+#endif
@@ -6,9 +6,6 @@
 #include <stdint.h>
 #include <general/address.h>
 
-#define container_of(MemberAddress, ContainerType, MemberName) \
-    ((ContainerType *)((address_t)(MemberAddress) - offsetof(ContainerType, MemberName)))
-
 #define linked_list_for_each_node(Cursor, Head) \
     for (Cursor = (Head)->next; Cursor != (Head); Cursor = Cursor->next)
 
@@ -30,6 +27,21 @@ static inline void linked_list_append(struct linked_list_node *const head,
 
     last->next = node;
     node->previous = last;
+    node->next = head;
+    head->previous = node;
+}
+
+/** Insert `new_node` right in front of `node`. */
+static inline void linked_list_insert_before(struct linked_list_node *const node,
+        struct linked_list_node *const new_node)
+{
+    struct linked_list_node *const previous = node->previous;
+
+    new_node->previous = previous;
+    previous->next = new_node;
+
+    new_node->next = node;
+    node->previous = new_node;
 }
 
 static inline struct linked_list_node *linked_list_get(struct linked_list_node *const head,
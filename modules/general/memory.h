@@ -15,6 +15,25 @@ static inline void memory_copy(void *const destination, const void *const source
     }
 }
 
+/**
+ * Store without filling the cache, for memory that won't be read back soon, such as a frame
+ * buffer. Non-temporal stores are weakly ordered, so call `memory_fence_stores` after them.
+ */
+static inline void memory_store_non_temporal_64(uint64_t *const address, uint64_t value)
+{
+    asm __volatile__("movnti %1, %0" : "=m"(*address) : "r"(value));
+}
+
+static inline void memory_store_non_temporal_32(uint32_t *const address, uint32_t value)
+{
+    asm __volatile__("movnti %1, %0" : "=m"(*address) : "r"(value));
+}
+
+static inline void memory_fence_stores(void)
+{
+    asm __volatile__("sfence" : : : "memory");
+}
+
 static inline int memory_compare(const void *const first, const void *const second, uint64_t size)
 {
     const byte_t *const frst = (byte_t *)first;
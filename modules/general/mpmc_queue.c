@@ -0,0 +1,97 @@
+#include <general/memory.h>
+
+#include "mpmc_queue.h"
+
+static inline uint64_t *get_sequence(const struct mpmc_queue *const queue, uint64_t position)
+{
+    return (uint64_t *)&queue->cells[(position & queue->mask) * queue->cell_size];
+}
+
+static inline void *get_entry(const struct mpmc_queue *const queue, uint64_t position)
+{
+    return &queue->cells[(position & queue->mask) * queue->cell_size + sizeof(uint64_t)];
+}
+
+int mpmc_queue_initialize(struct mpmc_queue *const queue, void *const buffer,
+        uint64_t entry_number, uint64_t entry_size)
+{
+    if (entry_number == 0 || (entry_number & (entry_number - 1)) != 0) {
+        return -1;
+    }
+
+    queue->cells = buffer;
+    queue->cell_size = mpmc_queue_cell_size(entry_size);
+    queue->entry_size = entry_size;
+    queue->mask = entry_number - 1;
+    queue->enqueue_position = 0;
+    queue->dequeue_position = 0;
+
+    for (uint64_t i = 0; i < entry_number; ++i) {
+        *get_sequence(queue, i) = i;
+    }
+
+    return 0;
+}
+
+int mpmc_queue_push(struct mpmc_queue *const queue, const void *const entry)
+{
+    uint64_t position = __atomic_load_n(&queue->enqueue_position, __ATOMIC_RELAXED);
+    uint64_t *sequence;
+
+    while (true) {
+        sequence = get_sequence(queue, position);
+
+        const int64_t difference =
+            (int64_t)(__atomic_load_n(sequence, __ATOMIC_ACQUIRE) - position);
+
+        if (difference == 0) {
+            // On failure the position is updated to what another producer left there.
+            if (__atomic_compare_exchange_n(&queue->enqueue_position, &position, position + 1,
+                        true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (difference < 0) {
+            // The cell still holds the entry of the previous round.
+            return -1;
+        } else {
+            // Another producer took the ticket.
+            position = __atomic_load_n(&queue->enqueue_position, __ATOMIC_RELAXED);
+        }
+    }
+
+    memory_copy(get_entry(queue, position), entry, queue->entry_size);
+    __atomic_store_n(sequence, position + 1, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+int mpmc_queue_pop(struct mpmc_queue *const queue, void *const destination)
+{
+    uint64_t position = __atomic_load_n(&queue->dequeue_position, __ATOMIC_RELAXED);
+    uint64_t *sequence;
+
+    while (true) {
+        sequence = get_sequence(queue, position);
+
+        const int64_t difference =
+            (int64_t)(__atomic_load_n(sequence, __ATOMIC_ACQUIRE) - (position + 1));
+
+        if (difference == 0) {
+            if (__atomic_compare_exchange_n(&queue->dequeue_position, &position, position + 1,
+                        true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (difference < 0) {
+            // The queue is empty, or the producer of the cell has not published it yet.
+            return -1;
+        } else {
+            // Another consumer took the ticket.
+            position = __atomic_load_n(&queue->dequeue_position, __ATOMIC_RELAXED);
+        }
+    }
+
+    memory_copy(destination, get_entry(queue, position), queue->entry_size);
+    __atomic_store_n(sequence, position + queue->mask + 1, __ATOMIC_RELEASE);
+
+    return 0;
+}
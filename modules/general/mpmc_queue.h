@@ -0,0 +1,98 @@
+#ifndef _GENERAL_MPMC_QUEUE_H
+#define _GENERAL_MPMC_QUEUE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Bytes of a cell: the sequence number followed by the entry, padded to 8 bytes. */
+#define mpmc_queue_cell_size(EntrySize) (sizeof(uint64_t) + (((EntrySize) + 7) & ~(uint64_t)7))
+
+/** Bytes of the buffer to hand to `mpmc_queue_initialize` for `EntryNumber` entries. */
+#define mpmc_queue_buffer_size(EntryType, EntryNumber) \
+    (mpmc_queue_cell_size(sizeof(EntryType)) * (EntryNumber))
+
+/**
+ * Define `struct Name` holding `EntryType` entries and its functions `Name##_initialize`,
+ * `Name##_push`, `Name##_pop` and `Name##_is_empty`, so entries of another type don't compile.
+ */
+#define mpmc_queue_define_typed(Name, EntryType) \
+    struct Name { \
+        struct mpmc_queue queue; \
+    }; \
+    static inline int Name##_initialize(struct Name *const typed_queue, void *const buffer, \
+            uint64_t entry_number) \
+    { \
+        return mpmc_queue_initialize(&typed_queue->queue, buffer, entry_number, \
+                sizeof(EntryType)); \
+    } \
+    static inline int Name##_push(struct Name *const typed_queue, const EntryType *const entry) \
+    { \
+        return mpmc_queue_push(&typed_queue->queue, entry); \
+    } \
+    static inline int Name##_pop(struct Name *const typed_queue, EntryType *const destination) \
+    { \
+        return mpmc_queue_pop(&typed_queue->queue, destination); \
+    } \
+    static inline bool Name##_is_empty(const struct Name *const typed_queue) \
+    { \
+        return mpmc_queue_is_empty(&typed_queue->queue); \
+    }
+
+/**
+ * A bounded lock-free queue for any number of producers and consumers.
+ *
+ * Every cell has a sequence number telling whose turn it is. A cell at position `p` is free for
+ * the producer holding ticket `p` when its sequence is `p`, and ready for the consumer holding
+ * ticket `p` when it is `p + 1`. A producer takes a ticket by a compare-and-swap on
+ * `enqueue_position` only after seeing the cell free, fills the cell and publishes it with a
+ * release store of the sequence. A consumer does the same on `dequeue_position` and hands the
+ * cell back for the next round with the sequence `p + entry_number`.
+ *
+ * Producers and consumers only meet on a cell, so they contend with each other only when the
+ * queue is nearly empty or full. A thread stopped between taking a ticket and publishing its
+ * cell holds back the consumer of that cell, but no one else.
+ */
+struct mpmc_queue {
+    uint8_t *cells;
+    uint64_t cell_size;
+    uint64_t entry_size;
+    /** The number of entries minus one. */
+    uint64_t mask;
+
+    uint64_t enqueue_position __attribute__((aligned(64)));
+
+    uint64_t dequeue_position __attribute__((aligned(64)));
+} __attribute__((aligned(64)));
+
+/**
+ * Set up a queue of `entry_number` entries of `entry_size` bytes over `buffer`, which must hold
+ * `mpmc_queue_buffer_size` bytes and be 8-byte aligned.
+ *
+ * @return 0 on success, -1 if `entry_number` is not a power of two.
+ */
+int mpmc_queue_initialize(struct mpmc_queue *const queue, void *const buffer,
+        uint64_t entry_number, uint64_t entry_size);
+
+/**
+ * Push an entry. Safe to call from any processor and from interrupt handlers.
+ *
+ * @return 0 on success, -1 if the queue is full.
+ */
+int mpmc_queue_push(struct mpmc_queue *const queue, const void *const entry);
+
+/**
+ * Pop the oldest entry into `destination`. Safe to call from any processor and from interrupt
+ * handlers.
+ *
+ * @return 0 on success, -1 if the queue is empty.
+ */
+int mpmc_queue_pop(struct mpmc_queue *const queue, void *const destination);
+
+/** Only a hint, as others may push or pop right after. */
+static inline bool mpmc_queue_is_empty(const struct mpmc_queue *const queue)
+{
+    return __atomic_load_n(&queue->dequeue_position, __ATOMIC_RELAXED)
+        == __atomic_load_n(&queue->enqueue_position, __ATOMIC_RELAXED);
+}
+
+#endif
@@ -0,0 +1,313 @@
+#include "red_black_tree.h"
+
+/**
+ * The tree keeps following properties:
+ * 1. The root is black.
+ * 2. A red node has no red child.
+ * 3. Every path from a node down to its leaves goes through the same number of black nodes.
+ *
+ * Missing children count as black leaves. See "Introduction to Algorithms" by Cormen et al. for the
+ * cases handled below.
+ */
+
+static inline bool is_red(const struct red_black_tree_node *const node)
+{
+    return node != NULL && node->is_red;
+}
+
+static inline void replace_child(struct red_black_tree *const tree,
+        struct red_black_tree_node *const parent, struct red_black_tree_node *const old_child,
+        struct red_black_tree_node *const new_child)
+{
+    if (parent == NULL) {
+        tree->root = new_child;
+    } else if (parent->left == old_child) {
+        parent->left = new_child;
+    } else {
+        parent->right = new_child;
+    }
+}
+
+static void rotate_left(struct red_black_tree *const tree, struct red_black_tree_node *const node)
+{
+    struct red_black_tree_node *const right = node->right;
+
+    node->right = right->left;
+    if (right->left != NULL) {
+        right->left->parent = node;
+    }
+
+    right->parent = node->parent;
+    replace_child(tree, node->parent, node, right);
+
+    right->left = node;
+    node->parent = right;
+}
+
+static void rotate_right(struct red_black_tree *const tree, struct red_black_tree_node *const node)
+{
+    struct red_black_tree_node *const left = node->left;
+
+    node->left = left->right;
+    if (left->right != NULL) {
+        left->right->parent = node;
+    }
+
+    left->parent = node->parent;
+    replace_child(tree, node->parent, node, left);
+
+    left->right = node;
+    node->parent = left;
+}
+
+static void fix_insertion(struct red_black_tree *const tree, struct red_black_tree_node *node)
+{
+    while (is_red(node->parent)) {
+        struct red_black_tree_node *parent = node->parent;
+        struct red_black_tree_node *const grandparent = parent->parent;
+
+        if (parent == grandparent->left) {
+            struct red_black_tree_node *const uncle = grandparent->right;
+
+            if (is_red(uncle)) {
+                parent->is_red = false;
+                uncle->is_red = false;
+                grandparent->is_red = true;
+                node = grandparent;
+                continue;
+            }
+
+            if (node == parent->right) {
+                rotate_left(tree, parent);
+                node = parent;
+                parent = node->parent;
+            }
+
+            parent->is_red = false;
+            grandparent->is_red = true;
+            rotate_right(tree, grandparent);
+        } else {
+            struct red_black_tree_node *const uncle = grandparent->left;
+
+            if (is_red(uncle)) {
+                parent->is_red = false;
+                uncle->is_red = false;
+                grandparent->is_red = true;
+                node = grandparent;
+                continue;
+            }
+
+            if (node == parent->left) {
+                rotate_right(tree, parent);
+                node = parent;
+                parent = node->parent;
+            }
+
+            parent->is_red = false;
+            grandparent->is_red = true;
+            rotate_left(tree, grandparent);
+        }
+    }
+
+    tree->root->is_red = false;
+}
+
+void red_black_tree_insert(struct red_black_tree *const tree,
+        struct red_black_tree_node *const node, red_black_tree_less_t less)
+{
+    struct red_black_tree_node *parent = NULL;
+    struct red_black_tree_node **link = &tree->root;
+    bool is_leftmost = true;
+
+    while (*link != NULL) {
+        parent = *link;
+
+        if (less(node, parent)) {
+            link = &parent->left;
+        } else {
+            link = &parent->right;
+            is_leftmost = false;
+        }
+    }
+
+    node->parent = parent;
+    node->left = NULL;
+    node->right = NULL;
+    node->is_red = true;
+    *link = node;
+
+    if (is_leftmost) {
+        tree->leftmost = node;
+    }
+
+    fix_insertion(tree, node);
+}
+
+/** Put `new_node` where `old_node` is. `old_node` keeps its children. */
+static inline void transplant(struct red_black_tree *const tree,
+        struct red_black_tree_node *const old_node, struct red_black_tree_node *const new_node)
+{
+    replace_child(tree, old_node->parent, old_node, new_node);
+
+    if (new_node != NULL) {
+        new_node->parent = old_node->parent;
+    }
+}
+
+/**
+ * Restore the properties after removing a black node.
+ *
+ * `node` took the place of the removed node and has one black node less on its paths. It may be
+ * NULL, so its parent is passed separately.
+ */
+static void fix_removal(struct red_black_tree *const tree, struct red_black_tree_node *node,
+        struct red_black_tree_node *parent)
+{
+    while (node != tree->root && !is_red(node)) {
+        if (node == parent->left) {
+            struct red_black_tree_node *sibling = parent->right;
+
+            if (is_red(sibling)) {
+                sibling->is_red = false;
+                parent->is_red = true;
+                rotate_left(tree, parent);
+                sibling = parent->right;
+            }
+
+            if (!is_red(sibling->left) && !is_red(sibling->right)) {
+                sibling->is_red = true;
+                node = parent;
+                parent = node->parent;
+                continue;
+            }
+
+            if (!is_red(sibling->right)) {
+                sibling->left->is_red = false;
+                sibling->is_red = true;
+                rotate_right(tree, sibling);
+                sibling = parent->right;
+            }
+
+            sibling->is_red = parent->is_red;
+            parent->is_red = false;
+            sibling->right->is_red = false;
+            rotate_left(tree, parent);
+        } else {
+            struct red_black_tree_node *sibling = parent->left;
+
+            if (is_red(sibling)) {
+                sibling->is_red = false;
+                parent->is_red = true;
+                rotate_right(tree, parent);
+                sibling = parent->left;
+            }
+
+            if (!is_red(sibling->left) && !is_red(sibling->right)) {
+                sibling->is_red = true;
+                node = parent;
+                parent = node->parent;
+                continue;
+            }
+
+            if (!is_red(sibling->left)) {
+                sibling->right->is_red = false;
+                sibling->is_red = true;
+                rotate_left(tree, sibling);
+                sibling = parent->left;
+            }
+
+            sibling->is_red = parent->is_red;
+            parent->is_red = false;
+            sibling->left->is_red = false;
+            rotate_right(tree, parent);
+        }
+
+        node = tree->root;
+        parent = NULL;
+    }
+
+    if (node != NULL) {
+        node->is_red = false;
+    }
+}
+
+void red_black_tree_remove(struct red_black_tree *const tree,
+        struct red_black_tree_node *const node)
+{
+    struct red_black_tree_node *child;
+    struct red_black_tree_node *child_parent;
+    bool is_removed_red = node->is_red;
+
+    if (tree->leftmost == node) {
+        tree->leftmost = red_black_tree_get_next(node);
+    }
+
+    if (node->left == NULL) {
+        child = node->right;
+        child_parent = node->parent;
+        transplant(tree, node, node->right);
+    } else if (node->right == NULL) {
+        child = node->left;
+        child_parent = node->parent;
+        transplant(tree, node, node->left);
+    } else {
+        // Replace the node with its successor, which has no left child.
+        struct red_black_tree_node *successor = node->right;
+        while (successor->left != NULL) {
+            successor = successor->left;
+        }
+
+        is_removed_red = successor->is_red;
+        child = successor->right;
+
+        if (successor->parent == node) {
+            child_parent = successor;
+        } else {
+            child_parent = successor->parent;
+            transplant(tree, successor, successor->right);
+            successor->right = node->right;
+            successor->right->parent = successor;
+        }
+
+        transplant(tree, node, successor);
+        successor->left = node->left;
+        successor->left->parent = successor;
+        successor->is_red = node->is_red;
+    }
+
+    if (!is_removed_red) {
+        fix_removal(tree, child, child_parent);
+    }
+}
+
+struct red_black_tree_node *red_black_tree_get_next(const struct red_black_tree_node *node)
+{
+    if (node->right != NULL) {
+        node = node->right;
+        while (node->left != NULL) {
+            node = node->left;
+        }
+        return (struct red_black_tree_node *)node;
+    }
+
+    while (node->parent != NULL && node == node->parent->right) {
+        node = node->parent;
+    }
+
+    return node->parent;
+}
+
+struct red_black_tree_node *red_black_tree_get_last(const struct red_black_tree *const tree)
+{
+    struct red_black_tree_node *node = tree->root;
+
+    if (node == NULL) {
+        return NULL;
+    }
+
+    while (node->right != NULL) {
+        node = node->right;
+    }
+
+    return node;
+}
@@ -0,0 +1,73 @@
+#ifndef _GENERAL_RED_BLACK_TREE_H
+#define _GENERAL_RED_BLACK_TREE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <general/address.h>
+
+/**
+ * An intrusive red-black tree.
+ *
+ * Like `linked_list_node`, a node is embedded in the structure to keep in the tree and the
+ * structure is reached back with `container_of`. The tree never allocates memory.
+ *
+ * Inserting and removing take O(log n) time. The leftmost node is cached, so getting the
+ * smallest node takes O(1) time.
+ */
+
+#define red_black_tree_for_each_node(Cursor, Tree) \
+    for (Cursor = red_black_tree_get_first(Tree); Cursor != NULL; \
+            Cursor = red_black_tree_get_next(Cursor))
+
+struct red_black_tree_node {
+    struct red_black_tree_node *parent;
+    struct red_black_tree_node *left;
+    struct red_black_tree_node *right;
+    bool is_red;
+};
+
+struct red_black_tree {
+    struct red_black_tree_node *root;
+    struct red_black_tree_node *leftmost;
+};
+
+/** Return whether `a` goes before `b` in the tree. */
+typedef bool (*red_black_tree_less_t)(const struct red_black_tree_node *const a,
+        const struct red_black_tree_node *const b);
+
+static inline void red_black_tree_initialize(struct red_black_tree *const tree)
+{
+    tree->root = NULL;
+    tree->leftmost = NULL;
+}
+
+static inline bool red_black_tree_is_empty(const struct red_black_tree *const tree)
+{
+    return tree->root == NULL;
+}
+
+/** Return the smallest node, or NULL if the tree is empty. */
+static inline struct red_black_tree_node *red_black_tree_get_first(
+        const struct red_black_tree *const tree)
+{
+    return tree->leftmost;
+}
+
+/**
+ * Insert `node` into the tree.
+ *
+ * A node equal to nodes already in the tree goes after them.
+ */
+void red_black_tree_insert(struct red_black_tree *const tree,
+        struct red_black_tree_node *const node, red_black_tree_less_t less);
+
+void red_black_tree_remove(struct red_black_tree *const tree,
+        struct red_black_tree_node *const node);
+
+/** Return the node after `node` in order, or NULL if it's the last one. */
+struct red_black_tree_node *red_black_tree_get_next(const struct red_black_tree_node *node);
+
+/** Return the largest node, or NULL if the tree is empty. */
+struct red_black_tree_node *red_black_tree_get_last(const struct red_black_tree *const tree);
+
+#endif
@@ -102,6 +102,24 @@ static inline size_t copy_string(char *const buffer, const char *const string)
     return i;
 }
 
+/** Copy `number` into `buffer`, padded with leading zeros to be at least `width` long. */
+static inline size_t copy_padded_number(char *const buffer, const char *const number,
+        size_t number_size, size_t width)
+{
+    size_t i;
+
+    for (i = 0; i + number_size < width; ++i) {
+        buffer[i] = '0';
+    }
+
+    return i + copy_string(&buffer[i], number);
+}
+
+static inline size_t get_padded_size(size_t size, size_t width)
+{
+    return size < width ? width : size;
+}
+
 size_t string_length(const char *const string)
 {
     size_t i;
@@ -141,6 +159,15 @@ int string_format_va(char *const output_buffer, const uint64_t output_buffer_siz
 
         ++cursor;
 
+        uint64_t width = 0;
+        if (*cursor == '0') {
+            ++cursor;
+            while ('0' <= *cursor && *cursor <= '9') {
+                width = width * 10 + (*cursor - '0');
+                ++cursor;
+            }
+        }
+
         switch (*cursor) {
         case 'c':
             output_buffer[output_buffer_index++] = (char)va_arg(ap, int);
@@ -148,7 +175,7 @@ int string_format_va(char *const output_buffer, const uint64_t output_buffer_siz
             break;
         case 's': {
             const char *const string = va_arg(ap, char *);
-            if (output_buffer_size < output_buffer_index + string_length(va_arg(ap, char *))) {
+            if (output_buffer_size < output_buffer_index + string_length(string)) {
                 return -1;
             }
             output_buffer_index += copy_string(&output_buffer[output_buffer_index], string);
@@ -167,11 +194,11 @@ int string_format_va(char *const output_buffer, const uint64_t output_buffer_siz
         }
         case 'u': {
             size_t string_size = uint32_to_string(number_string_buffer, va_arg(ap, uint32_t));
-            if (output_buffer_size < output_buffer_index + string_size) {
+            if (output_buffer_size < output_buffer_index + get_padded_size(string_size, width)) {
                 return -1;
             }
-            output_buffer_index += copy_string(&output_buffer[output_buffer_index],
-                    number_string_buffer);
+            output_buffer_index += copy_padded_number(&output_buffer[output_buffer_index],
+                    number_string_buffer, string_size, width);
             ++cursor;
             break;
         }
@@ -191,11 +218,11 @@ int string_format_va(char *const output_buffer, const uint64_t output_buffer_siz
             }
             case 'u': {
                 size_t string_size = uint64_to_string(number_string_buffer, va_arg(ap, uint64_t));
-                if (output_buffer_size < output_buffer_index + string_size) {
+                if (output_buffer_size < output_buffer_index + get_padded_size(string_size, width)) {
                     return -1;
                 }
-                output_buffer_index += copy_string(&output_buffer[output_buffer_index],
-                        number_string_buffer);
+                output_buffer_index += copy_padded_number(&output_buffer[output_buffer_index],
+                        number_string_buffer, string_size, width);
                 ++cursor;
                 break;
             }
@@ -229,5 +256,37 @@ int string_compare(const char *a, const char *b)
         ++b;
     }
 
+    if (*a != *b) {
+        return -1;
+    }
+
+    return 0;
+}
+
+int string_to_unsigned(const char *string, uint64_t *const out)
+{
+    uint64_t value = 0;
+
+    if (*string < '0' || '9' < *string) {
+        return -1;
+    }
+
+    while ('0' <= *string && *string <= '9') {
+        const uint64_t digit = *string - '0';
+
+        if (value > (UINT64_MAX - digit) / 10) {
+            return -1;
+        }
+
+        value = value * 10 + digit;
+        ++string;
+    }
+
+    if (*string != '\0' && *string != ' ') {
+        return -1;
+    }
+
+    *out = value;
+
     return 0;
 }
@@ -5,6 +5,13 @@
 #include <stddef.h>
 #include <stdint.h>
 
+/**
+ * A function that prints formatted string somewhere, such as `console_print_format`.
+ *
+ * Used to let a module print its report without knowing where the output goes.
+ */
+typedef int (*string_print_t)(const char *const format, ...);
+
 /**
  * Put formatted string into given `buffer`.
  *
@@ -14,6 +21,8 @@
  * %u:  Unsigned integer, 4 bytes.
  * %ld: Signed long, 8 bytes.
  * %lu: Unsigned long, 8 bytes.
+ *
+ * Unsigned conversions take a zero padded width, e.g. %02u prints 7 as "07".
  */
 int string_format(char *buffer, uint64_t buffer_size, const char *format, ...);
 
@@ -22,6 +31,20 @@ int string_format_va(char *const output_buffer, const uint64_t output_buffer_siz
 
 size_t string_length(const char *const string);
 
+/**
+ * Compare two strings.
+ *
+ * @return 0 if the strings are equal, -1 otherwise.
+ */
 int string_compare(const char *a, const char *b);
 
+/**
+ * Parse the decimal number at the start of `string`.
+ *
+ * The number has to be followed by the end of the string or a space.
+ *
+ * @return 0 on success, -1 if there is no valid number or it doesn't fit in 64 bits.
+ */
+int string_to_unsigned(const char *string, uint64_t *const out);
+
 #endif
@@ -7,22 +7,50 @@
 
 static inline void interrupts_enable(void)
 {
-    asm __volatile__("sti");
+    asm __volatile__("sti" : : : "memory");
 }
 
 static inline void interrupts_disable(void)
 {
-    asm __volatile__("cli");
+    asm __volatile__("cli" : : : "memory");
 }
 
-static inline uint16_t get_rflags(void)
+/**
+ * Disable interrupts and return the RFLAGS register value before disabling them.
+ *
+ * Pass the returned value to `interrupts_restore` to leave the critical section.
+ */
+static inline uint64_t interrupts_save_and_disable(void)
 {
-    uint16_t result = 0;
+    uint64_t flags;
 
     asm __volatile__(
         "pushfq \n\t"
         "pop %0 \n\t"
-        : "=m"(result)
+        "cli    \n\t"
+        : "=r"(flags)
+        :
+        : "memory"
+    );
+
+    return flags;
+}
+
+static inline void interrupts_restore(uint64_t flags)
+{
+    if (flags & REGISTER_RFLAGS_INTERRUPT) {
+        asm __volatile__("sti" : : : "memory");
+    }
+}
+
+static inline uint64_t get_rflags(void)
+{
+    uint64_t result = 0;
+
+    asm __volatile__(
+        "pushfq \n\t"
+        "pop %0 \n\t"
+        : "=r"(result)
     );
 
     return result;
@@ -0,0 +1,95 @@
+#include <stdbool.h>
+#include <cpu/local.h>
+#include <cpu/timestamp_counter.h>
+
+#include "control_register.h"
+#include "deferred_work.h"
+#include "statistics.h"
+
+#define DEFERRED_WORK_QUEUE_MASK (DEFERRED_WORK_QUEUE_SIZE - 1)
+
+struct deferred_work {
+    deferred_work_function_t function;
+    uint64_t data;
+};
+
+/**
+ * A queue of deferred work owned by a single processor.
+ *
+ * Only the owning processor touches its queue and it always does so with interrupts disabled, so
+ * no lock is needed.
+ */
+struct deferred_work_queue {
+    struct deferred_work works[DEFERRED_WORK_QUEUE_SIZE];
+    uint64_t head;
+    uint64_t tail;
+    bool is_running;
+};
+
+static struct deferred_work_queue global_deferred_work_queues[CPU_MAX_NUMBER];
+
+void deferred_work_initialize(void)
+{
+    for (uint64_t i = 0; i < CPU_MAX_NUMBER; ++i) {
+        global_deferred_work_queues[i].head = 0;
+        global_deferred_work_queues[i].tail = 0;
+        global_deferred_work_queues[i].is_running = false;
+    }
+}
+
+int deferred_work_queue(deferred_work_function_t function, uint64_t data)
+{
+    int result = 0;
+
+    const uint64_t flags = interrupts_save_and_disable();
+
+    struct deferred_work_queue *const queue = &global_deferred_work_queues[cpu_local_index()];
+
+    if (queue->tail - queue->head >= DEFERRED_WORK_QUEUE_SIZE) {
+        interrupt_statistics_record_deferred_work_drop();
+        result = -1;
+        goto END;
+    }
+
+    queue->works[queue->tail & DEFERRED_WORK_QUEUE_MASK].function = function;
+    queue->works[queue->tail & DEFERRED_WORK_QUEUE_MASK].data = data;
+    ++queue->tail;
+
+END:
+    interrupts_restore(flags);
+
+    return result;
+}
+
+void deferred_work_run(void)
+{
+    struct deferred_work_queue *const queue = &global_deferred_work_queues[cpu_local_index()];
+
+    if (queue->is_running || queue->head == queue->tail) {
+        return;
+    }
+
+    queue->is_running = true;
+
+    while (queue->head != queue->tail) {
+        const struct deferred_work work = queue->works[queue->head & DEFERRED_WORK_QUEUE_MASK];
+        ++queue->head;
+
+        interrupts_enable();
+
+        const uint64_t start_time = timestamp_counter_read();
+        work.function(work.data);
+        const uint64_t end_time = timestamp_counter_read();
+
+        interrupts_disable();
+
+        interrupt_statistics_record_deferred_work(end_time - start_time);
+    }
+
+    queue->is_running = false;
+}
+
+bool deferred_work_is_running(void)
+{
+    return global_deferred_work_queues[cpu_local_index()].is_running;
+}
@@ -0,0 +1,42 @@
+#ifndef _INTERRUPTS_DEFERRED_WORK_H
+#define _INTERRUPTS_DEFERRED_WORK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Deferred work, also known as the bottom half of interrupt handlers.
+ *
+ * An interrupt handler should only acknowledge its device and queue the rest of the work. Queued
+ * work runs on the same processor right after the interrupt is completed, with interrupts enabled,
+ * so a slow device does not keep other interrupts waiting.
+ *
+ * Deferred work is never nested: an interrupt arriving while deferred work runs only queues its
+ * work, which is picked up by the running loop before it returns.
+ */
+
+#define DEFERRED_WORK_QUEUE_SIZE (64)
+
+typedef void (*deferred_work_function_t)(uint64_t data);
+
+void deferred_work_initialize(void);
+
+/**
+ * Queue `function` to be called with `data` on the current processor.
+ *
+ * @return 0 on success, -1 if the queue of the current processor is full.
+ */
+int deferred_work_queue(deferred_work_function_t function, uint64_t data);
+
+/**
+ * Run queued work of the current processor.
+ *
+ * Must be called with interrupts disabled. Interrupts are enabled while each work runs and are
+ * disabled again on return.
+ */
+void deferred_work_run(void);
+
+/** Return whether the current processor is running deferred work. */
+bool deferred_work_is_running(void);
+
+#endif
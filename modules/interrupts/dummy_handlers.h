@@ -3,7 +3,6 @@
 
 #include <stdint.h>
 
-void dummy_interrupt_handler(const uint8_t interrupt_number);
 void dummy_exception_handler(const uint8_t exception_number, const uint64_t error_code);
 
 // TODO: Implement handlers below.
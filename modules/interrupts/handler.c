@@ -0,0 +1,268 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <cpu/timestamp_counter.h>
+#include <general/memory.h>
+#include <sync/rcu.h>
+#include <sync/spinlock.h>
+
+#include "control_register.h"
+#include "controller.h"
+#include "deferred_work.h"
+#include "dummy_handlers.h"
+#include "exception_vector_size.h"
+#include "handler.h"
+#include "local_apic.h"
+#include "stack.h"
+#include "statistics.h"
+
+#define PIC_VECTOR_START (EXCEPTION_VECTOR_SIZE)
+#define PIC_VECTOR_END   (EXCEPTION_VECTOR_SIZE + 16)
+
+struct interrupt_handler_entry {
+    interrupt_handler_t handler;
+    void *context;
+};
+
+struct interrupt_handler_list {
+    struct interrupt_handler_entry handlers[INTERRUPT_VECTOR_HANDLER_NUMBER];
+    uint64_t handler_number;
+};
+
+/**
+ * Handlers and statistics of a single vector.
+ *
+ * Vectors are looked up by indexing `global_interrupt_vectors`, so dispatch costs the same no
+ * matter how many vectors are in use.
+ *
+ * Other processors may be dispatching the vector while it's updated, so the handlers are read
+ * under RCU. An update fills the list not in use and publishes it. The list it replaces is
+ * reused by the next update once the readers that may still see it are done.
+ */
+struct interrupt_vector {
+    struct interrupt_handler_list *handlers;
+    struct interrupt_handler_list *spare;
+    /** The RCU state after which nobody reads `spare`. */
+    uint64_t spare_state;
+    struct interrupt_handler_list lists[2];
+    uint64_t unhandled_count;
+};
+
+static struct interrupt_vector global_interrupt_vectors[INTERRUPT_VECTOR_NUMBER];
+
+/** Serializes updates of every vector. Dispatch does not take it. */
+static struct spinlock global_interrupt_update_lock;
+
+static interrupt_exit_handler_t global_interrupt_exit_handler;
+
+static inline bool is_exception(uint8_t vector)
+{
+    return vector < EXCEPTION_VECTOR_SIZE;
+}
+
+static inline void notify_end(uint8_t vector)
+{
+    if (PIC_VECTOR_START <= vector && vector < PIC_VECTOR_END) {
+        interrupt_controller_notify_end(vector - PIC_VECTOR_START);
+        return;
+    }
+
+    // Spurious interrupts of the local APIC must not be acknowledged.
+    if (vector >= PIC_VECTOR_END && vector != LOCAL_APIC_SPURIOUS_VECTOR
+            && local_apic_is_enabled()) {
+        local_apic_notify_end();
+    }
+}
+
+void interrupt_handler_initialize(void)
+{
+    for (uint64_t i = 0; i < INTERRUPT_VECTOR_NUMBER; ++i) {
+        struct interrupt_vector *const vector = &global_interrupt_vectors[i];
+
+        for (uint64_t j = 0; j < 2; ++j) {
+            for (uint64_t k = 0; k < INTERRUPT_VECTOR_HANDLER_NUMBER; ++k) {
+                vector->lists[j].handlers[k].handler = NULL;
+                vector->lists[j].handlers[k].context = NULL;
+            }
+
+            vector->lists[j].handler_number = 0;
+        }
+
+        vector->handlers = &vector->lists[0];
+        vector->spare = &vector->lists[1];
+        vector->spare_state = rcu_get_state();
+        vector->unhandled_count = 0;
+    }
+
+    spinlock_initialize(&global_interrupt_update_lock);
+
+    global_interrupt_exit_handler = NULL;
+
+    interrupt_statistics_initialize();
+    deferred_work_initialize();
+}
+
+void interrupt_set_exit_handler(interrupt_exit_handler_t handler)
+{
+    global_interrupt_exit_handler = handler;
+}
+
+/**
+ * Take the update lock and copy the handlers of `vector` to its spare list, first waiting for the
+ * readers of the spare list to be done.
+ *
+ * @return The flags to give to `publish_update`.
+ */
+static uint64_t begin_update(struct interrupt_vector *const vector)
+{
+    uint64_t flags = spinlock_lock_save(&global_interrupt_update_lock);
+
+    while (!rcu_is_state_completed(vector->spare_state)) {
+        spinlock_unlock_restore(&global_interrupt_update_lock, flags);
+        rcu_synchronize();
+        flags = spinlock_lock_save(&global_interrupt_update_lock);
+    }
+
+    memory_copy(vector->spare, vector->handlers, sizeof(*vector->spare));
+
+    return flags;
+}
+
+/** Make the spare list the one dispatch reads and release the update lock. */
+static void publish_update(struct interrupt_vector *const vector, uint64_t flags)
+{
+    struct interrupt_handler_list *const old = vector->handlers;
+
+    rcu_assign_pointer(vector->handlers, vector->spare);
+    vector->spare = old;
+    vector->spare_state = rcu_get_state();
+
+    spinlock_unlock_restore(&global_interrupt_update_lock, flags);
+}
+
+int interrupt_register(uint8_t vector_number, interrupt_handler_t handler, void *const context)
+{
+    struct interrupt_vector *const vector = &global_interrupt_vectors[vector_number];
+
+    const uint64_t flags = begin_update(vector);
+    struct interrupt_handler_list *const list = vector->spare;
+
+    if (list->handler_number >= INTERRUPT_VECTOR_HANDLER_NUMBER) {
+        spinlock_unlock_restore(&global_interrupt_update_lock, flags);
+        return -1;
+    }
+
+    list->handlers[list->handler_number].handler = handler;
+    list->handlers[list->handler_number].context = context;
+    ++list->handler_number;
+
+    publish_update(vector, flags);
+
+    return 0;
+}
+
+int interrupt_unregister(uint8_t vector_number, interrupt_handler_t handler,
+        const void *const context)
+{
+    struct interrupt_vector *const vector = &global_interrupt_vectors[vector_number];
+    int result = -1;
+
+    const uint64_t flags = begin_update(vector);
+    struct interrupt_handler_list *const list = vector->spare;
+
+    for (uint64_t i = 0; i < list->handler_number; ++i) {
+        if (list->handlers[i].handler != handler || list->handlers[i].context != context) {
+            continue;
+        }
+
+        // Keep the registration order of remaining handlers.
+        for (uint64_t j = i + 1; j < list->handler_number; ++j) {
+            list->handlers[j - 1] = list->handlers[j];
+        }
+
+        --list->handler_number;
+        list->handlers[list->handler_number].handler = NULL;
+        list->handlers[list->handler_number].context = NULL;
+
+        result = 0;
+        break;
+    }
+
+    if (result != 0) {
+        spinlock_unlock_restore(&global_interrupt_update_lock, flags);
+        return result;
+    }
+
+    publish_update(vector, flags);
+
+    // Dispatch on other processors may still be calling the handler.
+    rcu_synchronize();
+
+    return 0;
+}
+
+void interrupt_get_statistics(uint8_t vector_number, struct interrupt_vector_statistics *const out)
+{
+    const struct interrupt_vector *const vector = &global_interrupt_vectors[vector_number];
+
+    out->count = interrupt_statistics_get_count(vector_number);
+    out->unhandled_count = vector->unhandled_count;
+    out->handler_number = rcu_dereference(vector->handlers)->handler_number;
+}
+
+void interrupt_dispatch(uint64_t vector_number, uint64_t error_code,
+        const struct interrupt_stack_frame *const stack_frame, uint64_t entry_time)
+{
+    const uint64_t handler_start_time = timestamp_counter_read();
+
+    struct interrupt_vector *const vector = &global_interrupt_vectors[vector_number];
+    const struct interrupt_frame frame = {
+        .vector = (uint8_t)vector_number,
+        .error_code = error_code,
+        .stack_frame = stack_frame
+    };
+    bool handled = false;
+
+    // The processor may have been asleep, where grace periods don't wait for it.
+    rcu_exit_idle();
+    rcu_read_lock();
+
+    const struct interrupt_handler_list *const list = rcu_dereference(vector->handlers);
+
+    for (uint64_t i = 0; i < list->handler_number; ++i) {
+        const struct interrupt_handler_entry *const entry = &list->handlers[i];
+
+        if (entry->handler(&frame, entry->context) == INTERRUPT_HANDLED) {
+            handled = true;
+
+            if (is_exception(frame.vector)) {
+                break;
+            }
+        }
+    }
+
+    rcu_read_unlock();
+
+    if (!handled) {
+        ++vector->unhandled_count;
+
+        if (is_exception(frame.vector)) {
+            dummy_exception_handler(frame.vector, frame.error_code);
+        }
+    }
+
+    const uint64_t handler_end_time = timestamp_counter_read();
+
+    notify_end(frame.vector);
+
+    interrupt_statistics_record(frame.vector, entry_time, handler_start_time, handler_end_time,
+            timestamp_counter_read());
+
+    if (!is_exception(frame.vector)
+            && interrupt_stack_get_index(frame.vector) == INTERRUPT_STACK_NONE) {
+        deferred_work_run();
+
+        if (global_interrupt_exit_handler != NULL) {
+            global_interrupt_exit_handler();
+        }
+    }
+}
@@ -0,0 +1,102 @@
+#ifndef _INTERRUPTS_HANDLER_H
+#define _INTERRUPTS_HANDLER_H
+
+#include <stdint.h>
+
+#define INTERRUPT_VECTOR_NUMBER (256)
+
+/** Maximum number of handlers that can share a single vector. */
+#define INTERRUPT_VECTOR_HANDLER_NUMBER (4)
+
+/** Return values of `interrupt_handler_t`. */
+#define INTERRUPT_UNHANDLED (0)
+#define INTERRUPT_HANDLED   (1)
+
+/**
+ * A data structure that represents the stack frame pushed by the processor on interrupt.
+ */
+struct interrupt_stack_frame {
+    uint64_t instruction_pointer;
+    uint64_t code_segment;
+    uint64_t flags;
+    uint64_t stack_pointer;
+    uint64_t stack_segment;
+} __attribute__((packed));
+
+struct interrupt_frame {
+    uint8_t vector;
+    /** Error code pushed by the processor. It's 0 for vectors without an error code. */
+    uint64_t error_code;
+    const struct interrupt_stack_frame *stack_frame;
+};
+
+/**
+ * An interrupt handler.
+ *
+ * @param context The value given to `interrupt_register`.
+ *
+ * @return `INTERRUPT_HANDLED` if the handler serviced the interrupt, `INTERRUPT_UNHANDLED`
+ * otherwise.
+ */
+typedef int (*interrupt_handler_t)(const struct interrupt_frame *const frame, void *const context);
+
+/**
+ * A function called on the way out of interrupts, after the deferred work ran.
+ *
+ * It runs with interrupts disabled on the stack of the interrupted thread, so it may switch to
+ * another thread. It's not called for exceptions and for interrupts on dedicated stacks.
+ */
+typedef void (*interrupt_exit_handler_t)(void);
+
+struct interrupt_vector_statistics {
+    /** Number of times the vector has been delivered. */
+    uint64_t count;
+    /** Number of deliveries no handler claimed. */
+    uint64_t unhandled_count;
+    /** Number of handlers currently registered on the vector. */
+    uint64_t handler_number;
+};
+
+void interrupt_handler_initialize(void);
+
+/**
+ * Register `handler` on `vector`.
+ *
+ * Several handlers can share a vector. They are invoked in the order of registration.
+ *
+ * For exceptions (vectors below `EXCEPTION_VECTOR_SIZE`), handlers form a chain: the first handler
+ * that returns `INTERRUPT_HANDLED` stops the chain. An exception no handler claims halts the system.
+ *
+ * For interrupts, every handler on the vector is invoked because any device sharing the line might
+ * have raised it. The end of interrupt is notified by the dispatcher, so handlers must not do it.
+ *
+ * Dispatch reads the handlers without a lock. Updates to a vector that come closer together than a
+ * grace period wait for it, so they must not come from interrupt handlers.
+ *
+ * @return 0 on success, -1 if the vector has no free handler slot.
+ */
+int interrupt_register(uint8_t vector, interrupt_handler_t handler, void *const context);
+
+/**
+ * Remove the handler registered with the same `handler` and `context` pair.
+ *
+ * Returns once no processor can be running the handler anymore, so `context` may be freed. Call
+ * this from a thread.
+ *
+ * @return 0 on success, -1 if there is no such handler.
+ */
+int interrupt_unregister(uint8_t vector, interrupt_handler_t handler, const void *const context);
+
+void interrupt_get_statistics(uint8_t vector, struct interrupt_vector_statistics *const out);
+
+void interrupt_set_exit_handler(interrupt_exit_handler_t handler);
+
+/**
+ * Entry point from the interrupt service routines.
+ *
+ * Do not invoke this function directly.
+ */
+void interrupt_dispatch(uint64_t vector, uint64_t error_code,
+        const struct interrupt_stack_frame *const stack_frame, uint64_t entry_time);
+
+#endif
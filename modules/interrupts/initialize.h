@@ -3,4 +3,12 @@
 
 int interrupts_initialize(void);
 
+/**
+ * Load the IDT shared by all processors and enable the local APIC of an application processor.
+ *
+ * Interrupts stay disabled. The 8259A keeps delivering device interrupts to the bootstrap
+ * processor only.
+ */
+void interrupts_initialize_application_processor(void);
+
 #endif
@@ -0,0 +1,194 @@
+#include <stdbool.h>
+#include <cpu/cpuid.h>
+#include <cpu/model_specific_register.h>
+#include <general/address.h>
+#include <memory/page.h>
+
+#include "control_register.h"
+#include "local_apic.h"
+
+/**
+ * Control functions for the local APIC in xAPIC mode.
+ *
+ * Registers are 32 bits wide, memory mapped and aligned on 16 bytes from the base address written
+ * in the IA32_APIC_BASE model specific register.
+ *
+ * For detailed description, check out the chapter 10 of the Intel SDM volume 3.
+ */
+
+#define LOCAL_APIC_REGISTER_ID            (0x020)
+#define LOCAL_APIC_REGISTER_TASK_PRIORITY (0x080)
+#define LOCAL_APIC_REGISTER_END           (0x0B0)
+#define LOCAL_APIC_REGISTER_SPURIOUS      (0x0F0)
+#define LOCAL_APIC_REGISTER_COMMAND_LOW   (0x300)
+#define LOCAL_APIC_REGISTER_COMMAND_HIGH  (0x310)
+#define LOCAL_APIC_REGISTER_TIMER         (0x320)
+#define LOCAL_APIC_REGISTER_TIMER_INITIAL (0x380)
+#define LOCAL_APIC_REGISTER_TIMER_CURRENT (0x390)
+#define LOCAL_APIC_REGISTER_TIMER_DIVIDE  (0x3E0)
+
+/** Bits of the IA32_APIC_BASE register. */
+#define LOCAL_APIC_BASE_ENABLE  (1 << 11)
+#define LOCAL_APIC_BASE_ADDRESS (0x000FFFFFFFFFF000)
+
+/** Software enable bit of the spurious interrupt vector register. */
+#define LOCAL_APIC_SPURIOUS_ENABLE (1 << 8)
+
+/** Bits of local vector table entries. */
+#define LOCAL_APIC_VECTOR_TABLE_MASKED     (1 << 16)
+#define LOCAL_APIC_VECTOR_TABLE_TIMER_MODE (17)
+
+/** Bits of the interrupt command register. */
+#define LOCAL_APIC_COMMAND_DELIVERY_FIXED   (0x0 << 8)
+#define LOCAL_APIC_COMMAND_DELIVERY_INIT    (0x5 << 8)
+#define LOCAL_APIC_COMMAND_DELIVERY_STARTUP (0x6 << 8)
+#define LOCAL_APIC_COMMAND_PENDING          (1 << 12)
+#define LOCAL_APIC_COMMAND_ASSERT           (1 << 14)
+#define LOCAL_APIC_COMMAND_DESTINATION      (24)
+
+/** Divide the bus clock by 16. */
+#define LOCAL_APIC_TIMER_DIVIDE_16 (0x03)
+
+struct local_apic_data {
+    address_t base_address;
+    bool is_enabled;
+};
+
+static struct local_apic_data global_local_apic_data;
+
+static inline uint32_t read_register(uint32_t offset)
+{
+    return *(volatile uint32_t *)(global_local_apic_data.base_address + offset);
+}
+
+static inline void write_register(uint32_t offset, uint32_t value)
+{
+    *(volatile uint32_t *)(global_local_apic_data.base_address + offset) = value;
+}
+
+/** Enable the local APIC of the current processor through its registers. */
+static void enable_local_apic(void)
+{
+    const uint64_t base = model_specific_register_read(MODEL_SPECIFIC_REGISTER_APIC_BASE);
+    if ((base & LOCAL_APIC_BASE_ENABLE) == 0) {
+        model_specific_register_write(MODEL_SPECIFIC_REGISTER_APIC_BASE,
+                base | LOCAL_APIC_BASE_ENABLE);
+    }
+
+    write_register(LOCAL_APIC_REGISTER_TASK_PRIORITY, 0);
+    write_register(LOCAL_APIC_REGISTER_SPURIOUS,
+            LOCAL_APIC_SPURIOUS_ENABLE | LOCAL_APIC_SPURIOUS_VECTOR);
+
+    // The firmware may have left the timer running.
+    write_register(LOCAL_APIC_REGISTER_TIMER_DIVIDE, LOCAL_APIC_TIMER_DIVIDE_16);
+    local_apic_timer_set_mode(LOCAL_APIC_TIMER_MODE_ONESHOT, true);
+    local_apic_timer_set_count(0);
+}
+
+int local_apic_initialize(void)
+{
+    global_local_apic_data.is_enabled = false;
+
+    if ((cpuid(CPUID_LEAF_FEATURE, 0).edx & CPUID_FEATURE_EDX_APIC) == 0) {
+        return -1;
+    }
+
+    const uint64_t base = model_specific_register_read(MODEL_SPECIFIC_REGISTER_APIC_BASE);
+    const address_t base_address = base & LOCAL_APIC_BASE_ADDRESS;
+
+    // The kernel map only covers the RAM, so the register page has to be mapped separately.
+    struct page_data page_data = page_get_loaded();
+    if (page_map(&page_data, base_address, base_address) != 0) {
+        return -2;
+    }
+
+    global_local_apic_data.base_address = base_address;
+
+    enable_local_apic();
+
+    global_local_apic_data.is_enabled = true;
+
+    return 0;
+}
+
+void local_apic_initialize_application_processor(void)
+{
+    enable_local_apic();
+}
+
+bool local_apic_is_enabled(void)
+{
+    return global_local_apic_data.is_enabled;
+}
+
+uint32_t local_apic_get_id(void)
+{
+    return read_register(LOCAL_APIC_REGISTER_ID) >> 24;
+}
+
+void local_apic_notify_end(void)
+{
+    write_register(LOCAL_APIC_REGISTER_END, 0);
+}
+
+void local_apic_timer_set_mode(enum local_apic_timer_mode mode, bool is_masked)
+{
+    uint32_t entry = LOCAL_APIC_TIMER_VECTOR;
+    entry |= (uint32_t)mode << LOCAL_APIC_VECTOR_TABLE_TIMER_MODE;
+
+    if (is_masked) {
+        entry |= LOCAL_APIC_VECTOR_TABLE_MASKED;
+    }
+
+    write_register(LOCAL_APIC_REGISTER_TIMER, entry);
+
+    /*
+     * Writes to the TSC deadline MSR may be reordered before the write switching the timer into
+     * the TSC-deadline mode, so serialize them. The Intel SDM recommends MFENCE for this.
+     */
+    asm __volatile__("mfence" : : : "memory");
+}
+
+void local_apic_timer_set_count(uint32_t count)
+{
+    write_register(LOCAL_APIC_REGISTER_TIMER_INITIAL, count);
+}
+
+uint32_t local_apic_timer_get_count(void)
+{
+    return read_register(LOCAL_APIC_REGISTER_TIMER_CURRENT);
+}
+
+/** Send an interrupt command and wait until the local APIC has accepted it. */
+static void send_command(uint32_t local_apic_id, uint32_t command)
+{
+    const uint64_t flags = interrupts_save_and_disable();
+
+    // Writing the low half sends the command, so the destination goes first.
+    write_register(LOCAL_APIC_REGISTER_COMMAND_HIGH,
+            local_apic_id << LOCAL_APIC_COMMAND_DESTINATION);
+    write_register(LOCAL_APIC_REGISTER_COMMAND_LOW, command);
+
+    while (read_register(LOCAL_APIC_REGISTER_COMMAND_LOW) & LOCAL_APIC_COMMAND_PENDING) {
+        asm __volatile__("pause");
+    }
+
+    interrupts_restore(flags);
+}
+
+void local_apic_send_init(uint32_t local_apic_id)
+{
+    send_command(local_apic_id, LOCAL_APIC_COMMAND_DELIVERY_INIT | LOCAL_APIC_COMMAND_ASSERT);
+}
+
+void local_apic_send_startup(uint32_t local_apic_id, uint8_t page_number)
+{
+    send_command(local_apic_id,
+            LOCAL_APIC_COMMAND_DELIVERY_STARTUP | LOCAL_APIC_COMMAND_ASSERT | page_number);
+}
+
+void local_apic_send_interrupt(uint32_t local_apic_id, uint8_t vector)
+{
+    send_command(local_apic_id,
+            LOCAL_APIC_COMMAND_DELIVERY_FIXED | LOCAL_APIC_COMMAND_ASSERT | vector);
+}
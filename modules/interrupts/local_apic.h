@@ -0,0 +1,74 @@
+#ifndef _INTERRUPTS_LOCAL_APIC_H
+#define _INTERRUPTS_LOCAL_APIC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Vectors of interrupts raised by the local APIC itself. */
+#define LOCAL_APIC_TIMER_VECTOR      (0xF0)
+#define LOCAL_APIC_SPURIOUS_VECTOR   (0xFF)
+
+/** Vector of the interrupt processors send each other to run the scheduler. */
+#define LOCAL_APIC_RESCHEDULE_VECTOR (0xF1)
+
+enum local_apic_timer_mode {
+    LOCAL_APIC_TIMER_MODE_ONESHOT      = 0,
+    LOCAL_APIC_TIMER_MODE_PERIODIC     = 1,
+    LOCAL_APIC_TIMER_MODE_TSC_DEADLINE = 2
+};
+
+/**
+ * Enable the local APIC of the current processor.
+ *
+ * The legacy interrupt pins are left as the firmware configured them, so interrupts of the 8259A
+ * keep being delivered through the local APIC.
+ *
+ * @return 0 on success, -1 if the processor has no local APIC, -2 if the registers can't be mapped.
+ */
+int local_apic_initialize(void);
+
+/**
+ * Enable the local APIC of an application processor.
+ *
+ * `local_apic_initialize` must have succeeded on the bootstrap processor. All local APICs are at
+ * the same address, each processor seeing its own.
+ */
+void local_apic_initialize_application_processor(void);
+
+bool local_apic_is_enabled(void);
+
+uint32_t local_apic_get_id(void);
+
+/** Notify the end of an interrupt delivered by the local APIC. */
+void local_apic_notify_end(void);
+
+/**
+ * Set the mode of the timer and mask or unmask it.
+ *
+ * The timer raises `LOCAL_APIC_TIMER_VECTOR`.
+ */
+void local_apic_timer_set_mode(enum local_apic_timer_mode mode, bool is_masked);
+
+/**
+ * Start the timer counting down from `count`.
+ *
+ * The timer counts at the bus frequency divided by 16. Writing 0 stops the timer.
+ */
+void local_apic_timer_set_count(uint32_t count);
+
+uint32_t local_apic_timer_get_count(void);
+
+/** Send an INIT IPI, which puts the processor of `local_apic_id` in the wait-for-SIPI state. */
+void local_apic_send_init(uint32_t local_apic_id);
+
+/**
+ * Send a startup IPI to the processor of `local_apic_id`.
+ *
+ * The processor starts in real mode at the physical address `page_number * 4096`.
+ */
+void local_apic_send_startup(uint32_t local_apic_id, uint8_t page_number);
+
+/** Raise the interrupt `vector` on the processor of `local_apic_id`. */
+void local_apic_send_interrupt(uint32_t local_apic_id, uint8_t vector);
+
+#endif
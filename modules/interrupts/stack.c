@@ -0,0 +1,27 @@
+#include <cpu/local.h>
+#include <memory/stack.h>
+
+#include "stack.h"
+
+static struct stack global_interrupt_stacks[CPU_MAX_NUMBER][INTERRUPT_STACK_NUMBER];
+
+int interrupt_stack_initialize(uint32_t cpu_index,
+        struct task_state_segment *const task_state_segment)
+{
+    for (uint64_t i = 0; i < INTERRUPT_STACK_NUMBER; ++i) {
+        struct stack *const stack = &global_interrupt_stacks[cpu_index][i];
+
+        if (stack_allocate(stack, INTERRUPT_STACK_PAGE_NUMBER) != 0) {
+            return -1;
+        }
+
+        // IST index n is stored in `interrupt_stack_table[n - 1]`.
+        task_state_segment->interrupt_stack_table[i] = stack->top_address;
+    }
+
+    for (uint64_t i = INTERRUPT_STACK_NUMBER; i < 7; ++i) {
+        task_state_segment->interrupt_stack_table[i] = 0;
+    }
+
+    return 0;
+}
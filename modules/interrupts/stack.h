@@ -0,0 +1,64 @@
+#ifndef _INTERRUPTS_STACK_H
+#define _INTERRUPTS_STACK_H
+
+#include <stdint.h>
+#include <memory/task_state_segment.h>
+
+/**
+ * Dedicated stacks for interrupts that may arrive when the current stack is unusable.
+ *
+ * The processor switches to the stack selected by the IST index of the gate no matter which stack
+ * was in use, so these handlers work even if the interrupted code overflowed its stack.
+ *
+ * Note that a vector must not be nested on its own IST stack: a second delivery restarts from the
+ * top of the stack and overwrites the first one. Handlers on IST stacks therefore never enable
+ * interrupts and never run deferred work.
+ */
+
+/** IST index 0 keeps the interrupted stack. */
+#define INTERRUPT_STACK_NONE          (0)
+#define INTERRUPT_STACK_DOUBLE_FAULT  (1)
+#define INTERRUPT_STACK_NMI           (2)
+#define INTERRUPT_STACK_MACHINE_CHECK (3)
+#define INTERRUPT_STACK_PROFILE       (4)
+
+#define INTERRUPT_STACK_NUMBER (4)
+
+/** Usable pages of each interrupt stack, excluding the guard page. */
+#define INTERRUPT_STACK_PAGE_NUMBER (4)
+
+#define INTERRUPT_VECTOR_NMI           (2)
+#define INTERRUPT_VECTOR_DOUBLE_FAULT  (8)
+#define INTERRUPT_VECTOR_MACHINE_CHECK (18)
+/**
+ * Vector reserved for sampling interrupts of performance monitoring counters delivered in fixed
+ * mode. Counters delivered as NMI use `INTERRUPT_STACK_NMI` instead.
+ */
+#define INTERRUPT_VECTOR_PROFILE       (0xFE)
+
+/**
+ * Allocate interrupt stacks of processor `cpu_index` and put them in `task_state_segment`.
+ *
+ * @return 0 on success, -1 otherwise.
+ */
+int interrupt_stack_initialize(uint32_t cpu_index,
+        struct task_state_segment *const task_state_segment);
+
+/** Return the IST index for `vector`. */
+static inline uint8_t interrupt_stack_get_index(uint8_t vector)
+{
+    switch (vector) {
+    case INTERRUPT_VECTOR_DOUBLE_FAULT:
+        return INTERRUPT_STACK_DOUBLE_FAULT;
+    case INTERRUPT_VECTOR_NMI:
+        return INTERRUPT_STACK_NMI;
+    case INTERRUPT_VECTOR_MACHINE_CHECK:
+        return INTERRUPT_STACK_MACHINE_CHECK;
+    case INTERRUPT_VECTOR_PROFILE:
+        return INTERRUPT_STACK_PROFILE;
+    default:
+        return INTERRUPT_STACK_NONE;
+    }
+}
+
+#endif
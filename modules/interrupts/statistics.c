@@ -0,0 +1,122 @@
+#include <cpu/local.h>
+#include <general/histogram.h>
+
+#include "handler.h"
+#include "statistics.h"
+
+struct interrupt_latency {
+    uint64_t count;
+    /** Cycles from the entry of the service routine to the first handler. */
+    struct histogram entry;
+    /** Cycles spent in the handlers. */
+    struct histogram handler;
+    /** Cycles spent notifying the end of interrupt. */
+    struct histogram end;
+};
+
+struct deferred_work_latency {
+    /** Cycles spent running each deferred work with interrupts enabled. */
+    struct histogram run;
+    uint64_t drop_count;
+};
+
+static struct interrupt_latency global_interrupt_latencies[CPU_MAX_NUMBER][INTERRUPT_VECTOR_NUMBER];
+static struct deferred_work_latency global_deferred_work_latencies[CPU_MAX_NUMBER];
+
+void interrupt_statistics_initialize(void)
+{
+    for (uint64_t i = 0; i < CPU_MAX_NUMBER; ++i) {
+        for (uint64_t j = 0; j < INTERRUPT_VECTOR_NUMBER; ++j) {
+            struct interrupt_latency *const latency = &global_interrupt_latencies[i][j];
+
+            latency->count = 0;
+            histogram_initialize(&latency->entry);
+            histogram_initialize(&latency->handler);
+            histogram_initialize(&latency->end);
+        }
+
+        histogram_initialize(&global_deferred_work_latencies[i].run);
+        global_deferred_work_latencies[i].drop_count = 0;
+    }
+}
+
+void interrupt_statistics_record(uint8_t vector, uint64_t entry_time, uint64_t handler_start_time,
+        uint64_t handler_end_time, uint64_t end_time)
+{
+    struct interrupt_latency *const latency = &global_interrupt_latencies[cpu_local_index()][vector];
+
+    ++latency->count;
+    histogram_record(&latency->entry, handler_start_time - entry_time);
+    histogram_record(&latency->handler, handler_end_time - handler_start_time);
+    histogram_record(&latency->end, end_time - handler_end_time);
+}
+
+void interrupt_statistics_record_deferred_work(uint64_t cycles)
+{
+    histogram_record(&global_deferred_work_latencies[cpu_local_index()].run, cycles);
+}
+
+void interrupt_statistics_record_deferred_work_drop(void)
+{
+    ++global_deferred_work_latencies[cpu_local_index()].drop_count;
+}
+
+uint64_t interrupt_statistics_get_count(uint8_t vector)
+{
+    uint64_t count = 0;
+
+    for (uint64_t i = 0; i < CPU_MAX_NUMBER; ++i) {
+        count += global_interrupt_latencies[i][vector].count;
+    }
+
+    return count;
+}
+
+void interrupt_statistics_print(string_print_t print)
+{
+    struct histogram entry;
+    struct histogram handler;
+    struct histogram end;
+
+    print("Interrupt latency in cycles, <2^n:count\n");
+
+    for (uint64_t vector = 0; vector < INTERRUPT_VECTOR_NUMBER; ++vector) {
+        struct interrupt_vector_statistics statistics;
+        interrupt_get_statistics(vector, &statistics);
+
+        if (statistics.count == 0) {
+            continue;
+        }
+
+        histogram_initialize(&entry);
+        histogram_initialize(&handler);
+        histogram_initialize(&end);
+
+        for (uint64_t cpu = 0; cpu < CPU_MAX_NUMBER; ++cpu) {
+            const struct interrupt_latency *const latency = &global_interrupt_latencies[cpu][vector];
+
+            histogram_merge(&entry, &latency->entry);
+            histogram_merge(&handler, &latency->handler);
+            histogram_merge(&end, &latency->end);
+        }
+
+        print("Vector %lu: count %lu, unhandled %lu, handlers %lu\n", vector,
+                statistics.count, statistics.unhandled_count, statistics.handler_number);
+        histogram_print(print, "entry  ", &entry);
+        histogram_print(print, "handler", &handler);
+        histogram_print(print, "eoi    ", &end);
+    }
+
+    struct histogram run;
+    uint64_t drop_count = 0;
+
+    histogram_initialize(&run);
+
+    for (uint64_t cpu = 0; cpu < CPU_MAX_NUMBER; ++cpu) {
+        histogram_merge(&run, &global_deferred_work_latencies[cpu].run);
+        drop_count += global_deferred_work_latencies[cpu].drop_count;
+    }
+
+    print("Deferred work: count %lu, dropped %lu\n", histogram_get_count(&run), drop_count);
+    histogram_print(print, "run    ", &run);
+}
@@ -0,0 +1,41 @@
+#ifndef _INTERRUPTS_STATISTICS_H
+#define _INTERRUPTS_STATISTICS_H
+
+#include <stdint.h>
+#include <general/string.h>
+
+/**
+ * Per-processor, per-vector interrupt counts and latency histograms.
+ *
+ * Each processor records only into its own entries with interrupts disabled, so recording needs
+ * neither locks nor atomic instructions. Readers sum the entries of all processors and might see
+ * an interrupt partially recorded, which is fine for statistics.
+ *
+ * All latencies are in time-stamp counter cycles.
+ */
+
+void interrupt_statistics_initialize(void);
+
+/**
+ * Record a delivery of `vector`.
+ *
+ * @param entry_time Time the interrupt service routine was entered.
+ * @param handler_start_time Time the first handler was about to run.
+ * @param handler_end_time Time the last handler returned.
+ * @param end_time Time the end of interrupt was notified.
+ */
+void interrupt_statistics_record(uint8_t vector, uint64_t entry_time, uint64_t handler_start_time,
+        uint64_t handler_end_time, uint64_t end_time);
+
+/** Record how long a deferred work ran with interrupts enabled. */
+void interrupt_statistics_record_deferred_work(uint64_t cycles);
+
+/** Record deferred work dropped because the queue was full. */
+void interrupt_statistics_record_deferred_work_drop(void);
+
+uint64_t interrupt_statistics_get_count(uint8_t vector);
+
+/** Print counts and histograms of every vector delivered at least once and of deferred work. */
+void interrupt_statistics_print(string_print_t print);
+
+#endif
@@ -0,0 +1,1955 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <cpu/local.h>
+#include <cpu/timestamp_counter.h>
+#include <drivers/graphic/glyph_cache.h>
+#include <drivers/graphic/screen.h>
+#include <drivers/graphic/surface.h>
+#include <general/circular_queue.h>
+#include <general/histogram.h>
+#include <general/mpmc_queue.h>
+#include <general/string.h>
+#include <interrupts/control_register.h>
+#include <memory/frame_allocator.h>
+#include <sync/mcs_lock.h>
+#include <sync/rcu.h>
+#include <sync/rwlock.h>
+#include <sync/spinlock.h>
+#include <sync/spsc_ring.h>
+#include <task/thread.h>
+#include <task/wait_queue.h>
+#include <time/clock.h>
+#include <time/timer.h>
+
+#include "benchmark.h"
+#include "command.h"
+#include "console.h"
+#include "shell.h"
+#include "smp.h"
+
+#define BENCHMARK_MAX_NUMBER      (32)
+#define BENCHMARK_NAME_MAX_LENGTH (32)
+
+/** Enough for two workers on every processor. */
+#define BENCHMARK_WORKER_MAX_NUMBER (2 * CPU_MAX_NUMBER)
+
+#define BENCHMARK_SWITCH_DEFAULT_ITERATION_NUMBER (100000)
+
+#define BENCHMARK_FAIR_CPU_THREAD_NUMBER (4)
+#define BENCHMARK_FAIR_IO_THREAD_NUMBER  (4)
+#define BENCHMARK_FAIR_THREAD_NUMBER \
+    (BENCHMARK_FAIR_CPU_THREAD_NUMBER + BENCHMARK_FAIR_IO_THREAD_NUMBER)
+#define BENCHMARK_FAIR_DEFAULT_DURATION  (1000)
+#define BENCHMARK_FAIR_IO_PERIOD         (1 * CLOCK_NANOSECONDS_PER_MILLISECOND)
+
+#define BENCHMARK_SCALE_DEFAULT_TASK_NUMBER (512)
+/** Iterations of the loop each task runs, about 100 us of work. */
+#define BENCHMARK_SCALE_TASK_ITERATION_NUMBER (200000)
+
+#define BENCHMARK_LOCK_DEFAULT_ITERATION_NUMBER (100000)
+
+#define BENCHMARK_RING_DEFAULT_OPERATION_NUMBER (1000000)
+#define BENCHMARK_RING_ENTRY_NUMBER             (1024)
+/** Entries pushed before they are popped again when one thread does both. */
+#define BENCHMARK_RING_BATCH_SIZE               (32)
+
+#define BENCHMARK_TIMER_DEFAULT_TIMER_NUMBER (100000)
+/** Timers that are only added and canceled are spread over this span, a second from now. */
+#define BENCHMARK_TIMER_IDLE_SPAN            (1000 * CLOCK_NANOSECONDS_PER_MILLISECOND)
+/** Timers that expire are spread over this span, after `BENCHMARK_TIMER_EXPIRY_DELAY`. */
+#define BENCHMARK_TIMER_EXPIRY_SPAN          (100 * CLOCK_NANOSECONDS_PER_MILLISECOND)
+#define BENCHMARK_TIMER_EXPIRY_DELAY         (10 * CLOCK_NANOSECONDS_PER_MILLISECOND)
+
+#define BENCHMARK_RCU_DEFAULT_ITERATION_NUMBER (1000000)
+#define BENCHMARK_RCU_VALUE_NUMBER             (8)
+#define BENCHMARK_RCU_SYNCHRONIZE_NUMBER       (16)
+
+#define BENCHMARK_MPMC_DEFAULT_ENTRY_NUMBER (100000)
+#define BENCHMARK_MPMC_QUEUE_SIZE           (1024)
+
+#define BENCHMARK_GLYPH_DEFAULT_PASS_NUMBER (4)
+#define BENCHMARK_GLYPH_NUMBER              (16)
+#define BENCHMARK_GLYPH_HEIGHT              (16)
+#define BENCHMARK_GLYPH_MAX_BLOCK_SIZE      (2)
+#define BENCHMARK_CLEAR_DEFAULT_ITERATION_NUMBER (10)
+
+#define BENCHMARK_SURFACE_DEFAULT_ITERATION_NUMBER (10)
+#define BENCHMARK_SURFACE_SPRITE_SIZE              (128)
+#define BENCHMARK_SURFACE_LINE_NUMBER              (1024)
+#define BENCHMARK_SURFACE_CIRCLE_NUMBER            (64)
+
+/** Console cells drawn at once, enough for a 4K screen. */
+#define BENCHMARK_GLYPH_MAX_CELL_NUMBER     (480 * 135)
+
+struct benchmark {
+    const char *name;
+    benchmark_function_t function;
+};
+
+struct benchmark_data {
+    struct benchmark benchmarks[BENCHMARK_MAX_NUMBER];
+    uint64_t benchmark_number;
+};
+
+static struct benchmark_data global_benchmark_data;
+
+/** Run as worker `index` of `run_workers`, with the data given to it. */
+typedef void (*benchmark_worker_function_t)(void *const data, uint64_t index);
+
+struct benchmark_worker {
+    benchmark_worker_function_t function;
+    void *data;
+    uint64_t index;
+};
+
+/**
+ * Workers started by `run_workers`. Benchmarks run one at a time from the shell, so there is a
+ * single set.
+ *
+ * The wait queue is only set up once, as the last worker may still be waking it up after the
+ * waiter saw every worker finished and went on.
+ */
+struct benchmark_worker_data {
+    struct benchmark_worker workers[BENCHMARK_WORKER_MAX_NUMBER];
+    uint64_t worker_number;
+    uint64_t ready_number;
+    uint64_t finished_number;
+    /** Set if not every worker could be created, so those created finish without running. */
+    bool is_cancelled;
+    struct wait_queue wait_queue;
+};
+
+static struct benchmark_worker_data global_benchmark_worker_data;
+
+/**
+ * Parse an optional iteration number argument.
+ *
+ * @return 0 on success, -1 if the argument is not a positive number.
+ */
+static int parse_iteration_number(const char *const arguments, uint64_t default_number,
+        uint64_t *const out)
+{
+    if (*arguments == '\0') {
+        *out = default_number;
+        return 0;
+    }
+
+    if (string_to_unsigned(arguments, out) != 0 || *out == 0) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/** Wait until every worker is ready, so they start together, and run the worker's function. */
+static void run_worker(void *const argument)
+{
+    struct benchmark_worker_data *const data = &global_benchmark_worker_data;
+    const struct benchmark_worker *const worker = argument;
+
+    __atomic_add_fetch(&data->ready_number, 1, __ATOMIC_ACQ_REL);
+    while (__atomic_load_n(&data->ready_number, __ATOMIC_ACQUIRE) < data->worker_number) {
+        asm __volatile__("pause");
+    }
+
+    if (!__atomic_load_n(&data->is_cancelled, __ATOMIC_ACQUIRE)) {
+        worker->function(worker->data, worker->index);
+    }
+
+    if (__atomic_add_fetch(&data->finished_number, 1, __ATOMIC_ACQ_REL) == data->worker_number) {
+        wait_queue_wake_all(&data->wait_queue);
+    }
+}
+
+static bool are_workers_finished(void *const context)
+{
+    const struct benchmark_worker_data *const data = context;
+
+    return __atomic_load_n(&data->finished_number, __ATOMIC_ACQUIRE) == data->worker_number;
+}
+
+/**
+ * Run `function` on `worker_number` threads at once and wait until they all return. Worker `i` is
+ * pinned to processor `i` modulo the number of processors if `is_pinned` is true.
+ *
+ * If a thread can't be created, those created return without calling `function`.
+ *
+ * @return Nanoseconds it took, or 0 if the threads can't be created.
+ */
+static uint64_t run_workers(benchmark_worker_function_t function, void *const function_data,
+        uint64_t worker_number, bool is_pinned)
+{
+    struct benchmark_worker_data *const data = &global_benchmark_worker_data;
+    const uint32_t cpu_number = smp_get_cpu_number();
+
+    if (worker_number > BENCHMARK_WORKER_MAX_NUMBER) {
+        return 0;
+    }
+
+    data->worker_number = worker_number;
+    data->ready_number = 0;
+    data->finished_number = 0;
+    data->is_cancelled = false;
+
+    const uint64_t start = clock_get_nanoseconds();
+
+    for (uint64_t i = 0; i < worker_number; ++i) {
+        struct benchmark_worker *const worker = &data->workers[i];
+        worker->function = function;
+        worker->data = function_data;
+        worker->index = i;
+
+        const struct thread *const thread = is_pinned
+            ? thread_create_pinned("bench worker", run_worker, worker, i % cpu_number)
+            : thread_create("bench worker", run_worker, worker);
+
+        if (thread == NULL) {
+            // The others count as ready and finished, so the created ones don't wait forever.
+            __atomic_store_n(&data->is_cancelled, true, __ATOMIC_RELEASE);
+            __atomic_add_fetch(&data->ready_number, worker_number - i, __ATOMIC_ACQ_REL);
+            __atomic_add_fetch(&data->finished_number, worker_number - i, __ATOMIC_ACQ_REL);
+            break;
+        }
+    }
+
+    wait_queue_wait(&data->wait_queue, are_workers_finished, data);
+
+    return data->is_cancelled ? 0 : clock_get_nanoseconds() - start;
+}
+
+struct ping_pong_data {
+    struct thread *threads[2];
+    struct thread *waiter;
+    uint64_t iteration_number;
+    uint64_t start;
+    uint64_t end;
+    /** Index of the player allowed to run. */
+    uint64_t turn;
+    uint64_t finished_number;
+};
+
+struct ping_pong_player {
+    struct ping_pong_data *data;
+    uint64_t index;
+};
+
+/**
+ * Pass the turn to the other player, wake it up and block until the turn comes back. Every
+ * iteration is one switch.
+ *
+ * The turn makes up for wakeups that come before a player blocks, which make `thread_block`
+ * return early.
+ */
+static void ping_pong(void *const argument)
+{
+    const struct ping_pong_player *const player = argument;
+    struct ping_pong_data *const data = player->data;
+    struct thread *const peer = data->threads[1 - player->index];
+
+    const uint64_t flags = interrupts_save_and_disable();
+
+    if (player->index == 0) {
+        data->start = timestamp_counter_read();
+    }
+
+    for (uint64_t i = 0; i < data->iteration_number; ++i) {
+        while (__atomic_load_n(&data->turn, __ATOMIC_ACQUIRE) != player->index) {
+            thread_block();
+        }
+
+        __atomic_store_n(&data->turn, 1 - player->index, __ATOMIC_RELEASE);
+        thread_wakeup(peer);
+    }
+
+    if (player->index == 0) {
+        data->end = timestamp_counter_read();
+    }
+
+    if (__atomic_add_fetch(&data->finished_number, 1, __ATOMIC_ACQ_REL) == 2) {
+        thread_wakeup(data->waiter);
+    }
+
+    interrupts_restore(flags);
+}
+
+static void benchmark_switch(const char *const arguments, string_print_t print)
+{
+    struct ping_pong_data data;
+    struct ping_pong_player players[2];
+
+    if (parse_iteration_number(arguments, BENCHMARK_SWITCH_DEFAULT_ITERATION_NUMBER,
+                &data.iteration_number) != 0) {
+        print("Usage: bench switch [iterations]\n");
+        return;
+    }
+
+    data.waiter = thread_get_current();
+    data.turn = 0;
+    data.finished_number = 0;
+
+    bool is_failed = false;
+
+    const uint64_t flags = interrupts_save_and_disable();
+
+    // Both players stay on this processor, so a wakeup is a switch rather than an interrupt.
+    for (uint64_t i = 0; i < 2; ++i) {
+        players[i].data = &data;
+        players[i].index = i;
+        data.threads[i] = thread_create_pinned("ping-pong", ping_pong, &players[i],
+                cpu_local_index());
+
+        if (data.threads[i] == NULL) {
+            /*
+             * A player already created hasn't run yet, as interrupts are disabled on its
+             * processor. It finishes without playing, and the missing one counts as finished.
+             */
+            data.iteration_number = 0;
+            __atomic_add_fetch(&data.finished_number, 2 - i, __ATOMIC_ACQ_REL);
+            is_failed = true;
+            break;
+        }
+    }
+
+    // The players use this stack frame, so wait for them even if one couldn't be created.
+    while (__atomic_load_n(&data.finished_number, __ATOMIC_ACQUIRE) < 2) {
+        thread_block();
+    }
+
+    interrupts_restore(flags);
+
+    if (is_failed) {
+        print("Failed to create threads.\n");
+        return;
+    }
+
+    const uint64_t switch_number = data.iteration_number * 2;
+    const uint64_t cycles = data.end - data.start;
+
+    print("%lu switches, %lu cycles/switch, %lu ns/switch\n", switch_number,
+            cycles / switch_number, clock_convert_cycles_to_nanoseconds(cycles) / switch_number);
+}
+
+struct fair_data {
+    struct thread *waiter;
+    volatile bool is_stopped;
+    uint64_t finished_number;
+    /** Delay from the end of the sleep of I/O-bound threads until they run, in nanoseconds. */
+    struct histogram latency;
+    uint64_t latency_sum;
+    uint64_t latency_max;
+};
+
+struct fair_worker {
+    struct fair_data *data;
+    int8_t nice;
+    uint64_t iteration_number;
+    uint64_t runtime;
+};
+
+static void finish_fair_worker(struct fair_worker *const worker)
+{
+    struct fair_data *const data = worker->data;
+
+    const uint64_t flags = interrupts_save_and_disable();
+
+    worker->runtime = thread_get_current()->scheduler_entity.runtime;
+
+    if (++data->finished_number == BENCHMARK_FAIR_THREAD_NUMBER) {
+        thread_wakeup(data->waiter);
+    }
+
+    interrupts_restore(flags);
+}
+
+static void run_cpu_bound(void *const argument)
+{
+    struct fair_worker *const worker = argument;
+
+    while (!worker->data->is_stopped) {
+        ++worker->iteration_number;
+    }
+
+    finish_fair_worker(worker);
+}
+
+static void run_io_bound(void *const argument)
+{
+    struct fair_worker *const worker = argument;
+    struct fair_data *const data = worker->data;
+
+    while (!data->is_stopped) {
+        const uint64_t deadline = clock_get_nanoseconds() + BENCHMARK_FAIR_IO_PERIOD;
+        thread_sleep(BENCHMARK_FAIR_IO_PERIOD);
+        const uint64_t now = clock_get_nanoseconds();
+        const uint64_t latency = now > deadline ? now - deadline : 0;
+
+        const uint64_t flags = interrupts_save_and_disable();
+        histogram_record(&data->latency, latency);
+        data->latency_sum += latency;
+        if (latency > data->latency_max) {
+            data->latency_max = latency;
+        }
+        interrupts_restore(flags);
+
+        ++worker->iteration_number;
+    }
+
+    finish_fair_worker(worker);
+}
+
+/**
+ * Run CPU-bound threads of different nice values along with threads sleeping 1 ms at a time.
+ *
+ * CPU-bound threads should get shares of the processor proportional to their weights, and
+ * I/O-bound threads should run soon after they wake up.
+ */
+static void benchmark_fair(const char *const arguments, string_print_t print)
+{
+    struct fair_data data;
+    struct fair_worker workers[BENCHMARK_FAIR_THREAD_NUMBER];
+    const int8_t nices[BENCHMARK_FAIR_CPU_THREAD_NUMBER] = { -5, 0, 0, 5 };
+    uint64_t duration;
+
+    if (parse_iteration_number(arguments, BENCHMARK_FAIR_DEFAULT_DURATION, &duration) != 0) {
+        print("Usage: bench fair [milliseconds]\n");
+        return;
+    }
+
+    data.waiter = thread_get_current();
+    data.is_stopped = false;
+    data.finished_number = 0;
+    histogram_initialize(&data.latency);
+    data.latency_sum = 0;
+    data.latency_max = 0;
+
+    const uint64_t flags = interrupts_save_and_disable();
+
+    for (uint64_t i = 0; i < BENCHMARK_FAIR_THREAD_NUMBER; ++i) {
+        const bool is_cpu_bound = i < BENCHMARK_FAIR_CPU_THREAD_NUMBER;
+
+        workers[i].data = &data;
+        workers[i].nice = is_cpu_bound ? nices[i] : 0;
+        workers[i].iteration_number = 0;
+        workers[i].runtime = 0;
+
+        /*
+         * The shares only show when the threads compete for one processor. It also keeps the
+         * counters below safe with interrupts disabled.
+         */
+        struct thread *const thread = thread_create_pinned(
+                is_cpu_bound ? "cpu-bound" : "io-bound",
+                is_cpu_bound ? run_cpu_bound : run_io_bound, &workers[i], cpu_local_index());
+        if (thread == NULL) {
+            // Threads already created stop right away and the count is made up below.
+            data.is_stopped = true;
+            data.finished_number += BENCHMARK_FAIR_THREAD_NUMBER - i;
+            print("Failed to create threads.\n");
+            break;
+        }
+
+        thread_set_nice(thread, workers[i].nice);
+    }
+
+    interrupts_restore(flags);
+
+    if (!data.is_stopped) {
+        thread_sleep(duration * CLOCK_NANOSECONDS_PER_MILLISECOND);
+        data.is_stopped = true;
+    }
+
+    interrupts_disable();
+    while (data.finished_number < BENCHMARK_FAIR_THREAD_NUMBER) {
+        thread_block();
+    }
+    interrupts_enable();
+
+    for (uint64_t i = 0; i < BENCHMARK_FAIR_CPU_THREAD_NUMBER; ++i) {
+        print("cpu-bound nice %d: %lu ms, %lu iterations\n", workers[i].nice,
+                workers[i].runtime / CLOCK_NANOSECONDS_PER_MILLISECOND,
+                workers[i].iteration_number);
+    }
+
+    uint64_t wakeup_number = 0;
+    for (uint64_t i = BENCHMARK_FAIR_CPU_THREAD_NUMBER; i < BENCHMARK_FAIR_THREAD_NUMBER; ++i) {
+        wakeup_number += workers[i].iteration_number;
+    }
+
+    print("io-bound: %lu wakeups, wakeup latency avg %lu us, max %lu us\n", wakeup_number,
+            wakeup_number == 0 ? 0 : data.latency_sum / wakeup_number
+                / CLOCK_NANOSECONDS_PER_MICROSECOND,
+            data.latency_max / CLOCK_NANOSECONDS_PER_MICROSECOND);
+    histogram_print(print, "latency (ns)", &data.latency);
+}
+
+struct scale_data {
+    uint64_t task_number;
+    /** Index of the next task a worker takes. */
+    uint64_t next_task;
+    /** Tasks run on each processor. */
+    uint64_t cpu_task_numbers[CPU_MAX_NUMBER];
+};
+
+/** Work that touches nothing shared, so processors never wait for each other. */
+static void run_scale_task(void)
+{
+    volatile uint64_t value = 0;
+
+    for (uint64_t i = 0; i < BENCHMARK_SCALE_TASK_ITERATION_NUMBER; ++i) {
+        value += i;
+    }
+}
+
+static void run_scale_worker(void *const argument, uint64_t index)
+{
+    struct scale_data *const data = argument;
+
+    (void)index;
+
+    while (__atomic_fetch_add(&data->next_task, 1, __ATOMIC_RELAXED) < data->task_number) {
+        run_scale_task();
+        // The worker may have moved since the task ended, which only blurs the distribution.
+        __atomic_add_fetch(&data->cpu_task_numbers[cpu_local_index()], 1, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * Run the tasks on `worker_number` threads and wait until they are all done.
+ *
+ * @return Nanoseconds it took, or 0 if the threads can't be created.
+ */
+static uint64_t run_scale(struct scale_data *const data, uint64_t worker_number)
+{
+    data->next_task = 0;
+
+    for (uint64_t i = 0; i < CPU_MAX_NUMBER; ++i) {
+        data->cpu_task_numbers[i] = 0;
+    }
+
+    // Not pinned, so the scheduler places the workers and balances them.
+    return run_workers(run_scale_worker, data, worker_number, false);
+}
+
+/**
+ * Run the same independent tasks on one thread and then on a thread for each processor.
+ *
+ * New threads go to idle processors, and processors that run out of work steal it, so the speedup
+ * should come close to the number of processors.
+ */
+static void benchmark_scale(const char *const arguments, string_print_t print)
+{
+    struct scale_data data;
+
+    if (parse_iteration_number(arguments, BENCHMARK_SCALE_DEFAULT_TASK_NUMBER,
+                &data.task_number) != 0) {
+        print("Usage: bench scale [tasks]\n");
+        return;
+    }
+
+    const uint32_t cpu_number = smp_get_cpu_number();
+    const uint64_t worker_numbers[2] = { 1, cpu_number };
+    uint64_t single_time = 0;
+
+    for (uint64_t i = 0; i < 2; ++i) {
+        const uint64_t time = run_scale(&data, worker_numbers[i]);
+        if (time == 0) {
+            print("Failed to create threads.\n");
+            return;
+        }
+
+        if (i == 0) {
+            single_time = time;
+        }
+
+        const uint64_t speedup = single_time * 100 / time;
+
+        print("%lu threads: %lu ms, %lu tasks/s, speedup %lu.%02lu\n", worker_numbers[i],
+                time / CLOCK_NANOSECONDS_PER_MILLISECOND,
+                data.task_number * CLOCK_NANOSECONDS_PER_SECOND / time, speedup / 100,
+                speedup % 100);
+
+        print("  tasks per CPU:");
+        for (uint32_t j = 0; j < cpu_number; ++j) {
+            print(" %lu", data.cpu_task_numbers[j]);
+        }
+        print("\n");
+    }
+}
+
+enum lock_kind {
+    LOCK_KIND_TICKET,
+    LOCK_KIND_MCS,
+    LOCK_KIND_RWLOCK_WRITE,
+    LOCK_KIND_RWLOCK_READ,
+    LOCK_KIND_NUMBER
+};
+
+struct lock_data {
+    enum lock_kind kind;
+    uint64_t iteration_number;
+    uint64_t worker_number;
+    /** Incremented under the lock by writers, so lost updates show a broken lock. */
+    uint64_t counter;
+    struct spinlock spinlock;
+    struct mcs_lock mcs_lock;
+    struct rwlock rwlock;
+};
+
+static void run_lock_iterations(struct lock_data *const data)
+{
+    for (uint64_t i = 0; i < data->iteration_number; ++i) {
+        switch (data->kind) {
+        case LOCK_KIND_TICKET: {
+            const uint64_t flags = spinlock_lock_save(&data->spinlock);
+            ++data->counter;
+            spinlock_unlock_restore(&data->spinlock, flags);
+            break;
+        }
+        case LOCK_KIND_MCS: {
+            struct mcs_lock_node node;
+            const uint64_t flags = mcs_lock_lock_save(&data->mcs_lock, &node);
+            ++data->counter;
+            mcs_lock_unlock_restore(&data->mcs_lock, &node, flags);
+            break;
+        }
+        case LOCK_KIND_RWLOCK_WRITE: {
+            const uint64_t flags = rwlock_write_lock_save(&data->rwlock);
+            ++data->counter;
+            rwlock_write_unlock_restore(&data->rwlock, flags);
+            break;
+        }
+        case LOCK_KIND_RWLOCK_READ: {
+            const uint64_t flags = rwlock_read_lock_save(&data->rwlock);
+            (void)*(volatile uint64_t *)&data->counter;
+            rwlock_read_unlock_restore(&data->rwlock, flags);
+            break;
+        }
+        case LOCK_KIND_NUMBER:
+            break;
+        }
+    }
+}
+
+static void run_lock_worker(void *const argument, uint64_t index)
+{
+    (void)index;
+
+    run_lock_iterations(argument);
+}
+
+/**
+ * Run a worker on every processor taking the lock of `data->kind`. The workers start together, so
+ * the lock is fought over from the first iteration.
+ *
+ * @return Nanoseconds it took, or 0 if the threads can't be created.
+ */
+static uint64_t run_lock(struct lock_data *const data)
+{
+    data->worker_number = smp_get_cpu_number();
+    data->counter = 0;
+
+    return run_workers(run_lock_worker, data, data->worker_number, true);
+}
+
+/** Take each kind of lock from every processor at once and print the cost of an acquisition. */
+static void benchmark_lock(const char *const arguments, string_print_t print)
+{
+    struct lock_data data;
+
+    if (parse_iteration_number(arguments, BENCHMARK_LOCK_DEFAULT_ITERATION_NUMBER,
+                &data.iteration_number) != 0) {
+        print("Usage: bench lock [iterations]\n");
+        return;
+    }
+
+    spinlock_initialize(&data.spinlock);
+    mcs_lock_initialize(&data.mcs_lock);
+    rwlock_initialize(&data.rwlock);
+
+    for (uint64_t i = 0; i < LOCK_KIND_NUMBER; ++i) {
+        data.kind = (enum lock_kind)i;
+
+        const uint64_t time = run_lock(&data);
+        if (time == 0) {
+            print("Failed to create threads.\n");
+            return;
+        }
+
+        const uint64_t acquisition_number = data.iteration_number * data.worker_number;
+        const uint64_t expected_counter = data.kind == LOCK_KIND_RWLOCK_READ
+            ? 0 : acquisition_number;
+        const char *name = "ticket";
+        if (data.kind == LOCK_KIND_MCS) {
+            name = "mcs";
+        } else if (data.kind == LOCK_KIND_RWLOCK_WRITE) {
+            name = "rwlock write";
+        } else if (data.kind == LOCK_KIND_RWLOCK_READ) {
+            name = "rwlock read";
+        }
+
+        print("%s: %lu CPUs, %lu ns/acquisition, %lu acquisitions/s%s\n", name,
+                data.worker_number, time / acquisition_number,
+                acquisition_number * CLOCK_NANOSECONDS_PER_SECOND / time,
+                data.counter == expected_counter ? "" : " (counter mismatch)");
+    }
+}
+
+enum ring_kind {
+    RING_KIND_LOCKED_QUEUE,
+    RING_KIND_SPSC,
+    RING_KIND_SPSC_BULK,
+    RING_KIND_NUMBER
+};
+
+struct ring_data {
+    uint64_t operation_number;
+    /** Popped values that did not come in the order they were pushed. */
+    uint64_t error_number;
+    struct circular_queue_data queue;
+    struct spinlock queue_lock;
+    struct spsc_ring ring;
+    uint64_t buffer[BENCHMARK_RING_ENTRY_NUMBER];
+};
+
+/** Too large for the stack of the shell. */
+static struct ring_data global_ring_data;
+
+/**
+ * Push a batch and pop it again on this thread until `operation_number` entries went through.
+ *
+ * The queue is taken with the lock the keyboard used around it, as it can't be shared without.
+ */
+static void run_ring_batches(struct ring_data *const data, enum ring_kind kind)
+{
+    uint64_t batch[BENCHMARK_RING_BATCH_SIZE];
+    uint64_t next_value = 0;
+    uint64_t expected_value = 0;
+
+    for (uint64_t i = 0; i < data->operation_number; i += BENCHMARK_RING_BATCH_SIZE) {
+        switch (kind) {
+        case RING_KIND_LOCKED_QUEUE:
+            for (uint64_t j = 0; j < BENCHMARK_RING_BATCH_SIZE; ++j) {
+                const uint64_t flags = spinlock_lock_save(&data->queue_lock);
+                circular_queue_push(&data->queue, &next_value);
+                spinlock_unlock_restore(&data->queue_lock, flags);
+                ++next_value;
+            }
+            for (uint64_t j = 0; j < BENCHMARK_RING_BATCH_SIZE; ++j) {
+                const uint64_t flags = spinlock_lock_save(&data->queue_lock);
+                circular_queue_pop(&data->queue, &batch[j]);
+                spinlock_unlock_restore(&data->queue_lock, flags);
+            }
+            break;
+        case RING_KIND_SPSC:
+            for (uint64_t j = 0; j < BENCHMARK_RING_BATCH_SIZE; ++j) {
+                spsc_ring_push(&data->ring, &next_value);
+                ++next_value;
+            }
+            for (uint64_t j = 0; j < BENCHMARK_RING_BATCH_SIZE; ++j) {
+                spsc_ring_pop(&data->ring, &batch[j]);
+            }
+            break;
+        case RING_KIND_SPSC_BULK:
+            for (uint64_t j = 0; j < BENCHMARK_RING_BATCH_SIZE; ++j) {
+                batch[j] = next_value++;
+            }
+            spsc_ring_push_bulk(&data->ring, batch, BENCHMARK_RING_BATCH_SIZE);
+            spsc_ring_pop_bulk(&data->ring, batch, BENCHMARK_RING_BATCH_SIZE);
+            break;
+        case RING_KIND_NUMBER:
+            break;
+        }
+
+        for (uint64_t j = 0; j < BENCHMARK_RING_BATCH_SIZE; ++j) {
+            if (batch[j] != expected_value++) {
+                ++data->error_number;
+            }
+        }
+    }
+}
+
+static void run_ring_producer(struct ring_data *const data)
+{
+    for (uint64_t value = 0; value < data->operation_number; ++value) {
+        while (spsc_ring_push(&data->ring, &value) != 0) {
+            asm __volatile__("pause");
+        }
+    }
+}
+
+static void run_ring_consumer(struct ring_data *const data)
+{
+    uint64_t value;
+
+    for (uint64_t expected_value = 0; expected_value < data->operation_number;
+            ++expected_value) {
+        while (spsc_ring_pop(&data->ring, &value) != 0) {
+            asm __volatile__("pause");
+        }
+
+        if (value != expected_value) {
+            ++data->error_number;
+        }
+    }
+}
+
+/** Worker 0 consumes and worker 1 produces. */
+static void run_ring_worker(void *const argument, uint64_t index)
+{
+    if (index == 0) {
+        run_ring_consumer(argument);
+    } else {
+        run_ring_producer(argument);
+    }
+}
+
+/**
+ * Pass entries from a producer on processor 1 to a consumer on processor 0.
+ *
+ * @return Nanoseconds it took, or 0 if the threads can't be created.
+ */
+static uint64_t run_ring_cross(struct ring_data *const data)
+{
+    return run_workers(run_ring_worker, data, 2, true);
+}
+
+static void print_ring_result(string_print_t print, const char *const name,
+        const struct ring_data *const data, uint64_t time)
+{
+    if (time == 0) {
+        time = 1;
+    }
+
+    print("%s: %lu ns/op, %lu ops/s%s\n", name, time / data->operation_number,
+            data->operation_number * CLOCK_NANOSECONDS_PER_SECOND / time,
+            data->error_number == 0 ? "" : " (order mismatch)");
+}
+
+/**
+ * Compare the locked circular queue the keyboard used with the SPSC ring, first with one thread
+ * pushing and popping batches, then with the producer and the consumer on different processors.
+ */
+static void benchmark_ring(const char *const arguments, string_print_t print)
+{
+    struct ring_data *const data = &global_ring_data;
+
+    if (parse_iteration_number(arguments, BENCHMARK_RING_DEFAULT_OPERATION_NUMBER,
+                &data->operation_number) != 0) {
+        print("Usage: bench ring [operations]\n");
+        return;
+    }
+
+    // Whole batches only, so the order check doesn't look past the last one.
+    data->operation_number = (data->operation_number + BENCHMARK_RING_BATCH_SIZE - 1)
+        / BENCHMARK_RING_BATCH_SIZE * BENCHMARK_RING_BATCH_SIZE;
+
+    spinlock_initialize(&data->queue_lock);
+
+    for (uint64_t i = 0; i < RING_KIND_NUMBER; ++i) {
+        const enum ring_kind kind = (enum ring_kind)i;
+
+        data->error_number = 0;
+        circular_queue_initialize(&data->queue, data->buffer, sizeof(data->buffer),
+                sizeof(uint64_t));
+        spsc_ring_initialize(&data->ring, data->buffer, BENCHMARK_RING_ENTRY_NUMBER,
+                sizeof(uint64_t));
+
+        const uint64_t start = clock_get_nanoseconds();
+        run_ring_batches(data, kind);
+        const uint64_t time = clock_get_nanoseconds() - start;
+
+        const char *name = "locked queue";
+        if (kind == RING_KIND_SPSC) {
+            name = "spsc ring";
+        } else if (kind == RING_KIND_SPSC_BULK) {
+            name = "spsc ring bulk";
+        }
+
+        print_ring_result(print, name, data, time);
+    }
+
+    if (smp_get_cpu_number() < 2) {
+        print("spsc ring cross-CPU: needs 2 CPUs\n");
+        return;
+    }
+
+    data->error_number = 0;
+    spsc_ring_initialize(&data->ring, data->buffer, BENCHMARK_RING_ENTRY_NUMBER,
+            sizeof(uint64_t));
+
+    const uint64_t time = run_ring_cross(data);
+    if (time == 0) {
+        print("Failed to create threads.\n");
+        return;
+    }
+
+    print_ring_result(print, "spsc ring cross-CPU", data, time);
+}
+
+struct timer_benchmark_data;
+
+struct timer_benchmark_entry {
+    struct timer timer;
+    struct timer_benchmark_data *data;
+};
+
+struct timer_benchmark_data {
+    struct thread *waiter;
+    uint64_t timer_number;
+    uint64_t expired_number;
+    /** Nanoseconds between the deadlines and the callbacks. */
+    uint64_t lateness_sum;
+    uint64_t lateness_max;
+    uint64_t random_state;
+    struct timer_benchmark_entry *entries;
+};
+
+static uint64_t get_random_offset(struct timer_benchmark_data *const data, uint64_t span)
+{
+    data->random_state = data->random_state * 6364136223846793005ULL + 1442695040888963407ULL;
+
+    return (data->random_state >> 33) % span;
+}
+
+static void handle_benchmark_timer(uint64_t argument)
+{
+    struct timer_benchmark_entry *const entry = (struct timer_benchmark_entry *)argument;
+    struct timer_benchmark_data *const data = entry->data;
+    const uint64_t lateness = clock_get_nanoseconds() - entry->timer.deadline;
+
+    data->lateness_sum += lateness;
+    if (lateness > data->lateness_max) {
+        data->lateness_max = lateness;
+    }
+
+    // Callbacks run on this processor one after another, so the count needs no atomics.
+    if (++data->expired_number == data->timer_number) {
+        thread_wakeup(data->waiter);
+    }
+}
+
+/** Add every timer at a random point of `span` after `delay`, returning the nanoseconds taken. */
+static uint64_t add_benchmark_timers(struct timer_benchmark_data *const data, uint64_t delay,
+        uint64_t span)
+{
+    const uint64_t base = clock_get_nanoseconds() + delay;
+    const uint64_t start = clock_get_nanoseconds();
+
+    for (uint64_t i = 0; i < data->timer_number; ++i) {
+        timer_add(&data->entries[i].timer, base + get_random_offset(data, span));
+    }
+
+    return clock_get_nanoseconds() - start;
+}
+
+/**
+ * Add, cancel and expire a large number of timers on this processor.
+ *
+ * Adding and canceling should cost the same however many timers are pending. Expired timers are
+ * run in batches, one for each clock event.
+ */
+static void benchmark_timer(const char *const arguments, string_print_t print)
+{
+    struct timer_benchmark_data data;
+
+    if (parse_iteration_number(arguments, BENCHMARK_TIMER_DEFAULT_TIMER_NUMBER,
+                &data.timer_number) != 0) {
+        print("Usage: bench timer [timers]\n");
+        return;
+    }
+
+    const uint64_t frame_number = (data.timer_number * sizeof(struct timer_benchmark_entry)
+            + MEMORY_FRAME_SIZE - 1) / MEMORY_FRAME_SIZE;
+    const frame_t frame = frame_allcoator_request(frame_number);
+    if (frame == MEMORY_FRAME_NULL) {
+        print("Not enough memory for %lu timers.\n", data.timer_number);
+        return;
+    }
+
+    // The kernel maps memory identically, so the frame address is also the virtual address.
+    data.entries = (struct timer_benchmark_entry *)frame;
+    data.random_state = timestamp_counter_read();
+
+    for (uint64_t i = 0; i < data.timer_number; ++i) {
+        timer_setup(&data.entries[i].timer, handle_benchmark_timer, (uint64_t)&data.entries[i]);
+        data.entries[i].data = &data;
+    }
+
+    // The thread is pinned, so every timer goes to the wheel of the same processor.
+    const uint32_t cpu_index = cpu_local_index();
+
+    const uint64_t add_time = add_benchmark_timers(&data, BENCHMARK_TIMER_IDLE_SPAN,
+            BENCHMARK_TIMER_IDLE_SPAN);
+
+    const uint64_t next_start = clock_get_nanoseconds();
+    const uint64_t next_deadline = timer_get_next_deadline(cpu_index);
+    const uint64_t next_time = clock_get_nanoseconds() - next_start;
+
+    const uint64_t cancel_start = clock_get_nanoseconds();
+    for (uint64_t i = 0; i < data.timer_number; ++i) {
+        timer_cancel(&data.entries[i].timer);
+    }
+    const uint64_t cancel_time = clock_get_nanoseconds() - cancel_start;
+
+    print("%lu timers: add %lu ns, cancel %lu ns, next deadline in %lu ms found in %lu ns\n",
+            data.timer_number, add_time / data.timer_number, cancel_time / data.timer_number,
+            (next_deadline - next_start) / CLOCK_NANOSECONDS_PER_MILLISECOND, next_time);
+
+    struct timer_statistics before;
+    struct timer_statistics after;
+
+    data.waiter = thread_get_current();
+    data.expired_number = 0;
+    data.lateness_sum = 0;
+    data.lateness_max = 0;
+
+    timer_get_statistics(cpu_index, &before);
+
+    add_benchmark_timers(&data, BENCHMARK_TIMER_EXPIRY_DELAY, BENCHMARK_TIMER_EXPIRY_SPAN);
+
+    const uint64_t flags = interrupts_save_and_disable();
+    while (data.expired_number < data.timer_number) {
+        thread_block();
+    }
+    interrupts_restore(flags);
+
+    timer_get_statistics(cpu_index, &after);
+
+    const uint64_t batch_number = after.batch_number - before.batch_number;
+
+    print("expired in %lu batches of %lu timers on average, late by %lu ns on average, "
+            "%lu ns at most\n", batch_number,
+            batch_number == 0 ? 0 : data.timer_number / batch_number,
+            data.lateness_sum / data.timer_number, data.lateness_max);
+
+    frame_allocator_free(frame, frame_number);
+}
+
+struct rcu_benchmark_values {
+    uint64_t values[BENCHMARK_RCU_VALUE_NUMBER];
+};
+
+struct rcu_benchmark_data {
+    uint64_t iteration_number;
+    bool is_rcu;
+    /** Sums of the values read, so the reads can't be optimized away. */
+    uint64_t sum;
+    struct rcu_benchmark_values *values;
+    struct rwlock rwlock;
+    struct rcu_benchmark_values value_versions[2];
+};
+
+static void run_rcu_reader(void *const argument, uint64_t index)
+{
+    struct rcu_benchmark_data *const data = argument;
+    uint64_t sum = 0;
+
+    (void)index;
+
+    for (uint64_t i = 0; i < data->iteration_number; ++i) {
+        const uint64_t index = i % BENCHMARK_RCU_VALUE_NUMBER;
+
+        if (data->is_rcu) {
+            rcu_read_lock();
+            sum += rcu_dereference(data->values)->values[index];
+            rcu_read_unlock();
+        } else {
+            rwlock_read_lock(&data->rwlock);
+            sum += data->values->values[index];
+            rwlock_read_unlock(&data->rwlock);
+        }
+    }
+
+    __atomic_add_fetch(&data->sum, sum, __ATOMIC_RELAXED);
+}
+
+/**
+ * Run a reader on each of the first `worker_number` processors.
+ *
+ * @return Nanoseconds it took, or 0 if the threads can't be created.
+ */
+static uint64_t run_rcu_readers(struct rcu_benchmark_data *const data, uint64_t worker_number)
+{
+    return run_workers(run_rcu_reader, data, worker_number, true);
+}
+
+/**
+ * Read shared values under RCU and under a reader-writer lock, on one processor and then on all
+ * of them, and time grace periods.
+ *
+ * RCU readers write nothing shared, so their throughput should grow with the processors. Readers
+ * of the lock all write its counter.
+ */
+static void benchmark_rcu(const char *const arguments, string_print_t print)
+{
+    struct rcu_benchmark_data data;
+
+    if (parse_iteration_number(arguments, BENCHMARK_RCU_DEFAULT_ITERATION_NUMBER,
+                &data.iteration_number) != 0) {
+        print("Usage: bench rcu [iterations]\n");
+        return;
+    }
+
+    for (uint64_t i = 0; i < BENCHMARK_RCU_VALUE_NUMBER; ++i) {
+        data.value_versions[0].values[i] = i;
+        data.value_versions[1].values[i] = i;
+    }
+
+    data.values = &data.value_versions[0];
+    rwlock_initialize(&data.rwlock);
+
+    const uint32_t cpu_number = smp_get_cpu_number();
+    const uint64_t worker_numbers[2] = { 1, cpu_number };
+
+    for (uint64_t i = 0; i < 2; ++i) {
+        data.is_rcu = i == 0;
+
+        uint64_t single_rate = 0;
+
+        for (uint64_t j = 0; j < 2; ++j) {
+            data.sum = 0;
+
+            const uint64_t time = run_rcu_readers(&data, worker_numbers[j]);
+            if (time == 0) {
+                print("Failed to create threads.\n");
+                return;
+            }
+
+            const uint64_t rate = data.iteration_number * worker_numbers[j]
+                * CLOCK_NANOSECONDS_PER_SECOND / time;
+            if (j == 0) {
+                single_rate = rate;
+            }
+
+            const uint64_t scaling = single_rate == 0 ? 0 : rate * 100 / single_rate;
+
+            print("%s: %lu readers, %lu reads/s, scaling %lu.%02lu\n",
+                    data.is_rcu ? "rcu" : "rwlock", worker_numbers[j], rate, scaling / 100,
+                    scaling % 100);
+        }
+    }
+
+    // Swap the versions back and forth, waiting each time until the old one is unused.
+    const uint64_t start = clock_get_nanoseconds();
+
+    for (uint64_t i = 0; i < BENCHMARK_RCU_SYNCHRONIZE_NUMBER; ++i) {
+        rcu_assign_pointer(data.values, &data.value_versions[(i + 1) % 2]);
+        rcu_synchronize();
+    }
+
+    const uint64_t time = clock_get_nanoseconds() - start;
+
+    print("grace period: %lu us on average\n",
+            time / BENCHMARK_RCU_SYNCHRONIZE_NUMBER / CLOCK_NANOSECONDS_PER_MICROSECOND);
+}
+
+mpmc_queue_define_typed(mpmc_benchmark_queue, uint64_t)
+
+struct mpmc_data {
+    /** Entries each producer pushes and each consumer pops. */
+    uint64_t entry_number;
+    /** Producers and consumers each. */
+    uint64_t cpu_number;
+    /** Entries popped out of the order their producer pushed them. */
+    uint64_t order_error_number;
+    uint64_t popped_sum;
+    struct mpmc_benchmark_queue queue;
+    uint8_t buffer[mpmc_queue_buffer_size(uint64_t, BENCHMARK_MPMC_QUEUE_SIZE)]
+        __attribute__((aligned(8)));
+};
+
+/** Too large for the stack of the shell. */
+static struct mpmc_data global_mpmc_data;
+
+/** An entry tells the producer in the upper half and its sequence number in the lower half. */
+static inline uint64_t make_mpmc_entry(uint64_t producer, uint64_t sequence)
+{
+    return (producer << 32) | sequence;
+}
+
+/** Give the processor away while the queue is full, as a consumer may share it. */
+static void run_mpmc_producer(struct mpmc_data *const data, uint64_t producer)
+{
+    for (uint64_t i = 0; i < data->entry_number; ++i) {
+        const uint64_t entry = make_mpmc_entry(producer, i);
+
+        while (mpmc_benchmark_queue_push(&data->queue, &entry) != 0) {
+            thread_yield();
+        }
+    }
+}
+
+/**
+ * Pop a share of the entries. Entries of one producer must come out in the order they went in,
+ * even though entries of different producers interleave.
+ */
+static void run_mpmc_consumer(struct mpmc_data *const data)
+{
+    uint64_t next_sequences[CPU_MAX_NUMBER];
+    uint64_t sum = 0;
+    uint64_t order_error_number = 0;
+
+    for (uint64_t i = 0; i < CPU_MAX_NUMBER; ++i) {
+        next_sequences[i] = 0;
+    }
+
+    for (uint64_t i = 0; i < data->entry_number; ++i) {
+        uint64_t entry;
+
+        while (mpmc_benchmark_queue_pop(&data->queue, &entry) != 0) {
+            thread_yield();
+        }
+
+        const uint64_t producer = entry >> 32;
+        const uint64_t sequence = entry & 0xFFFFFFFF;
+
+        if (producer >= CPU_MAX_NUMBER || sequence < next_sequences[producer]) {
+            ++order_error_number;
+        } else {
+            next_sequences[producer] = sequence + 1;
+        }
+
+        sum += entry;
+    }
+
+    __atomic_add_fetch(&data->popped_sum, sum, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&data->order_error_number, order_error_number, __ATOMIC_RELAXED);
+}
+
+/** The first worker on each processor produces and the second consumes. */
+static void run_mpmc_worker(void *const argument, uint64_t index)
+{
+    struct mpmc_data *const data = argument;
+
+    if (index < data->cpu_number) {
+        run_mpmc_producer(data, index);
+    } else {
+        run_mpmc_consumer(data);
+    }
+}
+
+/**
+ * Run a producer and a consumer pinned to every processor on one queue.
+ *
+ * @return Nanoseconds it took, or 0 if the threads can't be created.
+ */
+static uint64_t run_mpmc(struct mpmc_data *const data, uint32_t cpu_number)
+{
+    data->cpu_number = cpu_number;
+    data->order_error_number = 0;
+    data->popped_sum = 0;
+
+    return run_workers(run_mpmc_worker, data, cpu_number * 2, true);
+}
+
+/**
+ * Stress the MPMC queue with a producer and a consumer on every processor, check that nothing is
+ * lost, duplicated or reordered within a producer, and print the throughput.
+ */
+static void benchmark_mpmc(const char *const arguments, string_print_t print)
+{
+    struct mpmc_data *const data = &global_mpmc_data;
+
+    if (parse_iteration_number(arguments, BENCHMARK_MPMC_DEFAULT_ENTRY_NUMBER,
+                &data->entry_number) != 0 || data->entry_number > 0xFFFFFFFF) {
+        print("Usage: bench mpmc [entries per producer]\n");
+        return;
+    }
+
+    mpmc_benchmark_queue_initialize(&data->queue, data->buffer, BENCHMARK_MPMC_QUEUE_SIZE);
+
+    const uint32_t cpu_number = smp_get_cpu_number();
+    const uint64_t time = run_mpmc(data, cpu_number);
+    if (time == 0) {
+        print("Failed to create threads.\n");
+        return;
+    }
+
+    uint64_t expected_sum = 0;
+    for (uint64_t i = 0; i < cpu_number; ++i) {
+        expected_sum += make_mpmc_entry(i, 0) * data->entry_number
+            + data->entry_number * (data->entry_number - 1) / 2;
+    }
+
+    const uint64_t total_number = data->entry_number * cpu_number;
+
+    print("%u producers, %u consumers: %lu ns/entry, %lu entries/s\n", cpu_number, cpu_number,
+            time / total_number, total_number * CLOCK_NANOSECONDS_PER_SECOND / time);
+    print("order errors %lu, %s\n", data->order_error_number,
+            data->popped_sum == expected_sum && mpmc_benchmark_queue_is_empty(&data->queue)
+            ? "all entries popped once" : "entries lost or duplicated");
+}
+
+enum glyph_method {
+    GLYPH_METHOD_PER_PIXEL,
+    GLYPH_METHOD_BLITTER,
+    GLYPH_METHOD_CACHE,
+    GLYPH_METHOD_NUMBER
+};
+
+struct glyph_data {
+    struct graphic_frame_buffer_data frame_buffer_data;
+    /** Random glyphs, as the cost of drawing doesn't depend on their shapes. */
+    uint8_t font[BENCHMARK_GLYPH_NUMBER][BENCHMARK_GLYPH_HEIGHT];
+    struct pixel_color foreground;
+    struct pixel_color background;
+    uint64_t pass_number;
+    char text[BENCHMARK_GLYPH_MAX_CELL_NUMBER];
+};
+
+static struct glyph_data global_glyph_data;
+
+/** The way `console_print_char` drew before it had a glyph blitter. */
+static void draw_glyph_per_pixel(const struct glyph_data *const data, uint64_t x, uint64_t y,
+        const uint8_t *const glyph, uint64_t block_size)
+{
+    for (uint64_t row = 0; row < BENCHMARK_GLYPH_HEIGHT; ++row) {
+        for (uint64_t col = 0; col < SCREEN_GLYPH_WIDTH; ++col) {
+            screen_draw_block(&data->frame_buffer_data, x + (col * block_size),
+                    y + (row * block_size),
+                    ((glyph[row] << col) & 0x80) ? data->foreground : data->background,
+                    block_size);
+        }
+    }
+}
+
+/**
+ * Fill the screen with glyphs `pass_number` times.
+ *
+ * @return Nanoseconds it took.
+ */
+static uint64_t draw_glyph_screens(const struct glyph_data *const data, uint64_t block_size,
+        enum glyph_method method, uint64_t *const char_number)
+{
+    const uint64_t glyph_width = SCREEN_GLYPH_WIDTH * block_size;
+    const uint64_t glyph_height = BENCHMARK_GLYPH_HEIGHT * block_size;
+    const uint64_t col_size = data->frame_buffer_data.width / glyph_width;
+    const uint64_t row_size = data->frame_buffer_data.height / glyph_height;
+
+    *char_number = data->pass_number * row_size * col_size;
+
+    const uint64_t start = clock_get_nanoseconds();
+
+    for (uint64_t pass = 0; pass < data->pass_number; ++pass) {
+        for (uint64_t row = 0; row < row_size; ++row) {
+            for (uint64_t col = 0; col < col_size; ++col) {
+                const uint8_t *const glyph =
+                    data->font[(pass + row + col) % BENCHMARK_GLYPH_NUMBER];
+
+                switch (method) {
+                case GLYPH_METHOD_PER_PIXEL:
+                    draw_glyph_per_pixel(data, col * glyph_width, row * glyph_height, glyph,
+                            block_size);
+                    break;
+                case GLYPH_METHOD_BLITTER:
+                    screen_draw_glyph(&data->frame_buffer_data, col * glyph_width,
+                            row * glyph_height, glyph, BENCHMARK_GLYPH_HEIGHT,
+                            data->foreground, data->background, block_size);
+                    break;
+                default:
+                    glyph_cache_draw(&data->frame_buffer_data, col * glyph_width,
+                            row * glyph_height, glyph, BENCHMARK_GLYPH_HEIGHT,
+                            data->foreground, data->background, block_size);
+                    break;
+                }
+            }
+        }
+    }
+
+    return clock_get_nanoseconds() - start;
+}
+
+static void print_glyph_result(string_print_t print, const char *const name, uint64_t block_size,
+        uint64_t char_number, uint64_t time)
+{
+    if (time == 0) {
+        time = 1;
+    }
+
+    print("%s x%lu: %lu chars/s, %lu ns/char\n", name, block_size,
+            char_number * CLOCK_NANOSECONDS_PER_SECOND / time,
+            char_number == 0 ? 0 : time / char_number);
+}
+
+/**
+ * Draw the screen full of glyphs pixel by pixel, with the glyph blitter and through the glyph
+ * cache, then through the console. The shell draws over the screen again afterward.
+ */
+static void benchmark_glyph(const char *const arguments, string_print_t print)
+{
+    struct glyph_data *const data = &global_glyph_data;
+
+    if (parse_iteration_number(arguments, BENCHMARK_GLYPH_DEFAULT_PASS_NUMBER,
+                &data->pass_number) != 0) {
+        print("Usage: bench glyph [screens]\n");
+        return;
+    }
+
+    data->frame_buffer_data = console_get_frame_buffer_data();
+    data->foreground = (struct pixel_color){ .red = 0xFF, .green = 0xFF, .blue = 0xFF };
+    data->background = (struct pixel_color){ .red = 0x00, .green = 0x00, .blue = 0x00 };
+
+    uint64_t seed = timestamp_counter_read() | 1;
+    for (uint64_t i = 0; i < BENCHMARK_GLYPH_NUMBER; ++i) {
+        for (uint64_t j = 0; j < BENCHMARK_GLYPH_HEIGHT; ++j) {
+            seed ^= seed << 13;
+            seed ^= seed >> 7;
+            seed ^= seed << 17;
+            data->font[i][j] = (uint8_t)seed;
+        }
+    }
+
+    uint64_t results[BENCHMARK_GLYPH_MAX_BLOCK_SIZE][GLYPH_METHOD_NUMBER];
+    uint64_t char_numbers[BENCHMARK_GLYPH_MAX_BLOCK_SIZE];
+
+    for (uint64_t i = 0; i < BENCHMARK_GLYPH_MAX_BLOCK_SIZE; ++i) {
+        for (uint64_t j = 0; j < GLYPH_METHOD_NUMBER; ++j) {
+            results[i][j] = draw_glyph_screens(data, i + 1, (enum glyph_method)j,
+                    &char_numbers[i]);
+        }
+    }
+
+    const uint64_t col_size = console_get_width();
+    uint64_t row_size = console_get_height();
+    if (col_size * row_size > BENCHMARK_GLYPH_MAX_CELL_NUMBER) {
+        row_size = BENCHMARK_GLYPH_MAX_CELL_NUMBER / col_size;
+    }
+
+    for (uint64_t i = 0; i < col_size * row_size; ++i) {
+        data->text[i] = (char)('!' + i % ('~' - '!'));
+    }
+
+    // The way the shell draws, a whole screen and a flush at a time.
+    const uint64_t char_number = data->pass_number * col_size * row_size;
+    const uint64_t start = clock_get_nanoseconds();
+
+    for (uint64_t pass = 0; pass < data->pass_number; ++pass) {
+        console_draw(data->text, row_size, col_size);
+    }
+
+    const uint64_t console_time = clock_get_nanoseconds() - start;
+
+    for (uint64_t i = 0; i < BENCHMARK_GLYPH_MAX_BLOCK_SIZE; ++i) {
+        print_glyph_result(print, "per pixel", i + 1, char_numbers[i],
+                results[i][GLYPH_METHOD_PER_PIXEL]);
+        print_glyph_result(print, "blitter  ", i + 1, char_numbers[i],
+                results[i][GLYPH_METHOD_BLITTER]);
+        print_glyph_result(print, "cache    ", i + 1, char_numbers[i],
+                results[i][GLYPH_METHOD_CACHE]);
+    }
+    print("console: %lu chars/s, %lu ns/char\n",
+            char_number * CLOCK_NANOSECONDS_PER_SECOND / (console_time == 0 ? 1 : console_time),
+            char_number == 0 ? 0 : console_time / char_number);
+    glyph_cache_print(print);
+
+    shell_redraw();
+}
+
+struct clear_resolution {
+    uint64_t width;
+    uint64_t height;
+};
+
+static const struct clear_resolution global_clear_resolutions[] = {
+    { .width = 640, .height = 480 },
+    { .width = 1280, .height = 720 },
+    { .width = 1920, .height = 1080 },
+    { .width = 2560, .height = 1440 },
+    { .width = 3840, .height = 2160 },
+};
+
+enum clear_method {
+    CLEAR_METHOD_PER_PIXEL,
+    CLEAR_METHOD_FILL,
+    CLEAR_METHOD_PARALLEL_FILL,
+    CLEAR_METHOD_NUMBER
+};
+
+struct clear_data {
+    struct graphic_frame_buffer_data frame_buffer_data;
+    struct pixel_color color;
+    uint64_t width;
+    uint64_t height;
+    uint64_t iteration_number;
+    uint64_t worker_number;
+};
+
+/** Clear a `width` by `height` area the way `console_clear` used to, a call per pixel. */
+static void clear_per_pixel(const struct clear_data *const data)
+{
+    for (uint64_t y = 0; y < data->height; ++y) {
+        for (uint64_t x = 0; x < data->width; ++x) {
+            screen_draw_block(&data->frame_buffer_data, x, y, data->color, 1);
+        }
+    }
+}
+
+/** Clear a band of the rows, one band for each worker. */
+static void run_clear_worker(void *const argument, uint64_t index)
+{
+    const struct clear_data *const data = argument;
+    const uint64_t band_height = (data->height + data->worker_number - 1) / data->worker_number;
+    const uint64_t y = index * band_height;
+
+    if (y >= data->height) {
+        return;
+    }
+
+    const uint64_t height = y + band_height > data->height ? data->height - y : band_height;
+
+    for (uint64_t i = 0; i < data->iteration_number; ++i) {
+        screen_fill_rectangle(&data->frame_buffer_data, 0, y, data->width, height, data->color);
+    }
+}
+
+/**
+ * Clear the area with a worker on every processor.
+ *
+ * @return Nanoseconds it took, or 0 if the threads can't be created.
+ */
+static uint64_t run_parallel_clear(struct clear_data *const data)
+{
+    data->worker_number = smp_get_cpu_number();
+
+    return run_workers(run_clear_worker, data, data->worker_number, true);
+}
+
+static uint64_t run_clear(struct clear_data *const data, enum clear_method method)
+{
+    if (method == CLEAR_METHOD_PARALLEL_FILL) {
+        return run_parallel_clear(data);
+    }
+
+    const uint64_t start = clock_get_nanoseconds();
+
+    for (uint64_t i = 0; i < data->iteration_number; ++i) {
+        if (method == CLEAR_METHOD_PER_PIXEL) {
+            clear_per_pixel(data);
+        } else {
+            screen_fill_rectangle(&data->frame_buffer_data, 0, 0, data->width, data->height,
+                    data->color);
+        }
+    }
+
+    return clock_get_nanoseconds() - start;
+}
+
+/**
+ * Clear areas of common screen sizes that fit in the console's drawing target, a call per pixel,
+ * with a single fill and with a fill split across processors.
+ */
+static void benchmark_clear(const char *const arguments, string_print_t print)
+{
+    struct clear_data data;
+
+    if (parse_iteration_number(arguments, BENCHMARK_CLEAR_DEFAULT_ITERATION_NUMBER,
+                &data.iteration_number) != 0) {
+        print("Usage: bench clear [iterations]\n");
+        return;
+    }
+
+    data.frame_buffer_data = console_get_frame_buffer_data();
+    data.color = (struct pixel_color){ .red = 0x00, .green = 0x00, .blue = 0x00 };
+
+    for (uint64_t i = 0; i < sizeof(global_clear_resolutions) / sizeof(global_clear_resolutions[0]);
+            ++i) {
+        data.width = global_clear_resolutions[i].width;
+        data.height = global_clear_resolutions[i].height;
+
+        if (data.width > data.frame_buffer_data.width
+                || data.height > data.frame_buffer_data.height) {
+            print("%lux%lu: larger than the screen\n", data.width, data.height);
+            continue;
+        }
+
+        for (uint64_t j = 0; j < CLEAR_METHOD_NUMBER; ++j) {
+            const uint64_t time = run_clear(&data, (enum clear_method)j);
+            if (time == 0) {
+                print("Failed to create threads.\n");
+                return;
+            }
+
+            const char *name = "per pixel";
+            if (j == CLEAR_METHOD_FILL) {
+                name = "fill";
+            } else if (j == CLEAR_METHOD_PARALLEL_FILL) {
+                name = "parallel fill";
+            }
+
+            const uint64_t byte_number =
+                data.iteration_number * data.width * data.height * sizeof(pixel_value_t);
+
+            print("%lux%lu %s: %lu us/clear, %lu MB/s\n", data.width, data.height, name,
+                    time / data.iteration_number / CLOCK_NANOSECONDS_PER_MICROSECOND,
+                    byte_number * 1000 / time);
+        }
+    }
+
+    shell_redraw();
+}
+
+enum surface_operation {
+    SURFACE_OPERATION_FILL,
+    SURFACE_OPERATION_BLIT,
+    SURFACE_OPERATION_CONVERTING_BLIT,
+    SURFACE_OPERATION_SCALED_BLIT,
+    SURFACE_OPERATION_BLEND_PER_CHANNEL,
+    SURFACE_OPERATION_BLEND,
+    SURFACE_OPERATION_LINE,
+    SURFACE_OPERATION_CIRCLE,
+    SURFACE_OPERATION_NUMBER
+};
+
+struct surface_line {
+    int64_t x0;
+    int64_t y0;
+    int64_t x1;
+    int64_t y1;
+};
+
+struct surface_circle {
+    int64_t x;
+    int64_t y;
+    uint64_t radius;
+};
+
+struct surface_benchmark_data {
+    /** The console's drawing target. */
+    struct surface screen;
+    /** An alpha gradient in the format of the screen. */
+    struct surface sprite;
+    /** The same sprite with red and blue swapped, so blits convert it. */
+    struct surface converted_sprite;
+    struct surface_line lines[BENCHMARK_SURFACE_LINE_NUMBER];
+    struct surface_circle circles[BENCHMARK_SURFACE_CIRCLE_NUMBER];
+    uint64_t line_pixel_number;
+    uint64_t circle_pixel_number;
+    uint64_t iteration_number;
+};
+
+static struct surface_benchmark_data global_surface_benchmark_data;
+
+static uint64_t get_next_random(uint64_t *const seed)
+{
+    *seed ^= *seed << 13;
+    *seed ^= *seed >> 7;
+    *seed ^= *seed << 17;
+
+    return *seed;
+}
+
+/** Pixels `surface_fill_circle` draws for a circle that fits the surface. */
+static uint64_t get_circle_pixel_number(uint64_t radius)
+{
+    const uint64_t limit = radius * radius + radius;
+    uint64_t half_width = radius;
+    uint64_t pixel_number = 0;
+
+    for (uint64_t offset = 0; offset <= radius; ++offset) {
+        while (half_width > 0 && half_width * half_width + offset * offset > limit) {
+            --half_width;
+        }
+        pixel_number += (offset > 0 ? 2 : 1) * (2 * half_width + 1);
+    }
+
+    return pixel_number;
+}
+
+static int initialize_surface_benchmark(struct surface_benchmark_data *const data)
+{
+    const struct graphic_frame_buffer_data frame_buffer_data = console_get_frame_buffer_data();
+    const uint64_t size = BENCHMARK_SURFACE_SPRITE_SIZE;
+
+    data->screen = surface_from_frame_buffer(&frame_buffer_data);
+
+    if (surface_create(&data->sprite, size, size, data->screen.format->type) != 0) {
+        return -1;
+    }
+
+    const EFI_GRAPHICS_PIXEL_FORMAT converted_format =
+        data->screen.format->type == PixelRedGreenBlueReserved8BitPerColor
+        ? PixelBlueGreenRedReserved8BitPerColor : PixelRedGreenBlueReserved8BitPerColor;
+
+    if (surface_create(&data->converted_sprite, size, size, converted_format) != 0) {
+        surface_destroy(&data->sprite);
+        return -1;
+    }
+
+    // Alpha runs from clear on the left to opaque on the right, so the blends take every path.
+    for (uint64_t y = 0; y < size; ++y) {
+        for (uint64_t x = 0; x < size; ++x) {
+            const struct pixel_color color = {
+                .red = (uint8_t)x, .green = (uint8_t)y, .blue = (uint8_t)(x ^ y),
+            };
+            const uint8_t alpha = (uint8_t)(x * SURFACE_ALPHA_OPAQUE / (size - 1));
+
+            data->sprite.pixels[x + (y * size)] =
+                surface_get_pixel_value(&data->sprite, color, alpha);
+            data->converted_sprite.pixels[x + (y * size)] =
+                surface_get_pixel_value(&data->converted_sprite, color, alpha);
+        }
+    }
+
+    uint64_t seed = timestamp_counter_read() | 1;
+    const uint64_t width = data->screen.width;
+    const uint64_t height = data->screen.height;
+
+    data->line_pixel_number = 0;
+    for (uint64_t i = 0; i < BENCHMARK_SURFACE_LINE_NUMBER; ++i) {
+        struct surface_line *const line = &data->lines[i];
+
+        line->x0 = get_next_random(&seed) % width;
+        line->y0 = get_next_random(&seed) % height;
+        line->x1 = get_next_random(&seed) % width;
+        line->y1 = get_next_random(&seed) % height;
+
+        const int64_t delta_x = line->x1 > line->x0 ? line->x1 - line->x0 : line->x0 - line->x1;
+        const int64_t delta_y = line->y1 > line->y0 ? line->y1 - line->y0 : line->y0 - line->y1;
+        data->line_pixel_number += (delta_x > delta_y ? delta_x : delta_y) + 1;
+    }
+
+    // Circles are kept inside the screen, so every pixel counted is drawn.
+    const uint64_t max_radius = (width < height ? width : height) / 4;
+
+    data->circle_pixel_number = 0;
+    for (uint64_t i = 0; i < BENCHMARK_SURFACE_CIRCLE_NUMBER; ++i) {
+        struct surface_circle *const circle = &data->circles[i];
+
+        circle->radius = get_next_random(&seed) % max_radius;
+        circle->x = circle->radius + get_next_random(&seed) % (width - 2 * circle->radius);
+        circle->y = circle->radius + get_next_random(&seed) % (height - 2 * circle->radius);
+        data->circle_pixel_number += get_circle_pixel_number(circle->radius);
+    }
+
+    return 0;
+}
+
+/** Blend a channel at a time with a division for each, as a reference for the lanes. */
+static void blend_per_channel(const struct surface *const destination, int64_t x, int64_t y,
+        const struct surface *const source)
+{
+    for (uint64_t row = 0; row < source->height; ++row) {
+        pixel_value_t *const out = destination->pixels + x + ((y + row) * destination->stride);
+        const pixel_value_t *const in = source->pixels + (row * source->stride);
+
+        for (uint64_t col = 0; col < source->width; ++col) {
+            const uint32_t alpha = in[col] >> 24;
+            pixel_value_t value = out[col] & 0xFF000000;
+
+            for (uint64_t shift = 0; shift < 24; shift += 8) {
+                const uint32_t top = (in[col] >> shift) & 0xFF;
+                const uint32_t bottom = (out[col] >> shift) & 0xFF;
+
+                value |= ((top * alpha + bottom * (255 - alpha) + 127) / 255) << shift;
+            }
+            out[col] = value;
+        }
+    }
+}
+
+/**
+ * Cover the screen with sprites, scaled by `scale`, in whole tiles only.
+ *
+ * @return Pixels drawn.
+ */
+static uint64_t draw_sprite_tiles(const struct surface_benchmark_data *const data,
+        enum surface_operation operation, uint64_t scale)
+{
+    const uint64_t size = BENCHMARK_SURFACE_SPRITE_SIZE * scale;
+    uint64_t pixel_number = 0;
+
+    for (uint64_t y = 0; y + size <= data->screen.height; y += size) {
+        for (uint64_t x = 0; x + size <= data->screen.width; x += size) {
+            switch (operation) {
+            case SURFACE_OPERATION_BLIT:
+                surface_blit(&data->screen, x, y, &data->sprite, 0, 0, size, size);
+                break;
+            case SURFACE_OPERATION_CONVERTING_BLIT:
+                surface_blit(&data->screen, x, y, &data->converted_sprite, 0, 0, size, size);
+                break;
+            case SURFACE_OPERATION_SCALED_BLIT:
+                surface_blit_scaled(&data->screen, x, y, &data->sprite, 0, 0,
+                        BENCHMARK_SURFACE_SPRITE_SIZE, BENCHMARK_SURFACE_SPRITE_SIZE, scale);
+                break;
+            case SURFACE_OPERATION_BLEND_PER_CHANNEL:
+                blend_per_channel(&data->screen, x, y, &data->sprite);
+                break;
+            default:
+                surface_blend(&data->screen, x, y, &data->sprite, 0, 0, size, size);
+                break;
+            }
+            pixel_number += size * size;
+        }
+    }
+
+    return pixel_number;
+}
+
+/**
+ * Run an operation `iteration_number` times.
+ *
+ * @return Nanoseconds it took.
+ */
+static uint64_t run_surface_operation(const struct surface_benchmark_data *const data,
+        enum surface_operation operation, uint64_t *const pixel_number)
+{
+    const pixel_value_t value = surface_get_pixel_value(&data->screen,
+            (struct pixel_color){ .red = 0x20, .green = 0x40, .blue = 0x80 },
+            SURFACE_ALPHA_OPAQUE);
+
+    *pixel_number = 0;
+
+    const uint64_t start = clock_get_nanoseconds();
+
+    for (uint64_t i = 0; i < data->iteration_number; ++i) {
+        switch (operation) {
+        case SURFACE_OPERATION_FILL:
+            surface_fill_rectangle(&data->screen, 0, 0, data->screen.width,
+                    data->screen.height, value);
+            *pixel_number += data->screen.width * data->screen.height;
+            break;
+        case SURFACE_OPERATION_SCALED_BLIT:
+            *pixel_number += draw_sprite_tiles(data, operation, 2);
+            break;
+        case SURFACE_OPERATION_LINE:
+            for (uint64_t j = 0; j < BENCHMARK_SURFACE_LINE_NUMBER; ++j) {
+                const struct surface_line *const line = &data->lines[j];
+                surface_draw_line(&data->screen, line->x0, line->y0, line->x1, line->y1, value);
+            }
+            *pixel_number += data->line_pixel_number;
+            break;
+        case SURFACE_OPERATION_CIRCLE:
+            for (uint64_t j = 0; j < BENCHMARK_SURFACE_CIRCLE_NUMBER; ++j) {
+                const struct surface_circle *const circle = &data->circles[j];
+                surface_fill_circle(&data->screen, circle->x, circle->y, circle->radius,
+                        value);
+            }
+            *pixel_number += data->circle_pixel_number;
+            break;
+        default:
+            *pixel_number += draw_sprite_tiles(data, operation, 1);
+            break;
+        }
+    }
+
+    return clock_get_nanoseconds() - start;
+}
+
+/**
+ * Fill, blit, blend and draw shapes on the console's drawing target and report megapixels a
+ * second for each. The shell draws over the screen again afterward.
+ */
+static void benchmark_surface(const char *const arguments, string_print_t print)
+{
+    struct surface_benchmark_data *const data = &global_surface_benchmark_data;
+
+    if (parse_iteration_number(arguments, BENCHMARK_SURFACE_DEFAULT_ITERATION_NUMBER,
+                &data->iteration_number) != 0) {
+        print("Usage: bench surface [iterations]\n");
+        return;
+    }
+
+    if (initialize_surface_benchmark(data) != 0) {
+        print("Failed to allocate sprites.\n");
+        return;
+    }
+
+    uint64_t times[SURFACE_OPERATION_NUMBER];
+    uint64_t pixel_numbers[SURFACE_OPERATION_NUMBER];
+
+    for (uint64_t i = 0; i < SURFACE_OPERATION_NUMBER; ++i) {
+        times[i] = run_surface_operation(data, (enum surface_operation)i, &pixel_numbers[i]);
+    }
+
+    surface_destroy(&data->sprite);
+    surface_destroy(&data->converted_sprite);
+    shell_redraw();
+
+    for (uint64_t i = 0; i < SURFACE_OPERATION_NUMBER; ++i) {
+        const char *name = "fill";
+        if (i == SURFACE_OPERATION_BLIT) {
+            name = "blit";
+        } else if (i == SURFACE_OPERATION_CONVERTING_BLIT) {
+            name = "converting blit";
+        } else if (i == SURFACE_OPERATION_SCALED_BLIT) {
+            name = "scaled blit x2";
+        } else if (i == SURFACE_OPERATION_BLEND_PER_CHANNEL) {
+            name = "blend per channel";
+        } else if (i == SURFACE_OPERATION_BLEND) {
+            name = "blend";
+        } else if (i == SURFACE_OPERATION_LINE) {
+            name = "line";
+        } else if (i == SURFACE_OPERATION_CIRCLE) {
+            name = "circle";
+        }
+
+        print("%s: %lu MP/s\n", name,
+                pixel_numbers[i] * 1000 / (times[i] == 0 ? 1 : times[i]));
+    }
+}
+
+static void command_bench(const char *const arguments)
+{
+    char name[BENCHMARK_NAME_MAX_LENGTH];
+    const char *cursor = arguments;
+    uint64_t name_length = 0;
+
+    while (*cursor != '\0' && *cursor != ' ' && name_length < sizeof(name) - 1) {
+        name[name_length++] = *cursor++;
+    }
+    name[name_length] = '\0';
+
+    while (*cursor == ' ') {
+        ++cursor;
+    }
+
+    for (uint64_t i = 0; i < global_benchmark_data.benchmark_number; ++i) {
+        const struct benchmark *const benchmark = &global_benchmark_data.benchmarks[i];
+
+        if (string_compare(benchmark->name, name) == 0) {
+            benchmark->function(cursor, shell_print_format);
+            return;
+        }
+    }
+
+    shell_print_format("Benchmarks:");
+    for (uint64_t i = 0; i < global_benchmark_data.benchmark_number; ++i) {
+        shell_print_format(" %s", global_benchmark_data.benchmarks[i].name);
+    }
+    shell_print_format("\n");
+}
+
+void benchmark_initialize(void)
+{
+    global_benchmark_data.benchmark_number = 0;
+    wait_queue_initialize(&global_benchmark_worker_data.wait_queue);
+
+    benchmark_register("switch", benchmark_switch);
+    benchmark_register("fair", benchmark_fair);
+    benchmark_register("scale", benchmark_scale);
+    benchmark_register("lock", benchmark_lock);
+    benchmark_register("ring", benchmark_ring);
+    benchmark_register("rcu", benchmark_rcu);
+    benchmark_register("timer", benchmark_timer);
+    benchmark_register("mpmc", benchmark_mpmc);
+    benchmark_register("glyph", benchmark_glyph);
+    benchmark_register("clear", benchmark_clear);
+    benchmark_register("surface", benchmark_surface);
+
+    command_register("bench", "Run a benchmark. 'bench' alone lists them.", command_bench);
+}
+
+int benchmark_register(const char *const name, benchmark_function_t function)
+{
+    if (global_benchmark_data.benchmark_number >= BENCHMARK_MAX_NUMBER) {
+        return -1;
+    }
+
+    struct benchmark *const benchmark =
+        &global_benchmark_data.benchmarks[global_benchmark_data.benchmark_number];
+    benchmark->name = name;
+    benchmark->function = function;
+
+    ++global_benchmark_data.benchmark_number;
+
+    return 0;
+}
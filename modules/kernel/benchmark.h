@@ -0,0 +1,26 @@
+#ifndef _KERNEL_BENCHMARK_H
+#define _KERNEL_BENCHMARK_H
+
+#include <general/string.h>
+
+/**
+ * A benchmark run by the `bench` shell command.
+ *
+ * @param arguments Rest of the command line after the benchmark name.
+ * @param print Where to print the result.
+ */
+typedef void (*benchmark_function_t)(const char *const arguments, string_print_t print);
+
+/** Reset the benchmark table, register built-in benchmarks and the `bench` command. */
+void benchmark_initialize(void);
+
+/**
+ * Register a benchmark.
+ *
+ * `name` is not copied, so it has to stay valid.
+ *
+ * @return 0 on success, -1 if the benchmark table is full.
+ */
+int benchmark_register(const char *const name, benchmark_function_t function);
+
+#endif
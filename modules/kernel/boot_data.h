@@ -13,6 +13,8 @@ struct boot_data {
     struct uefi_memory_map_data memory_map_data;
     struct graphic_frame_buffer_data frame_buffer_data;
     struct psf1_data psf1_data;
+    /** Physical address of the ACPI RSDP, or 0 if the firmware does not provide one. */
+    address_t acpi_rsdp_address;
 };
 
 #endif
@@ -0,0 +1,273 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <cpu/local.h>
+#include <drivers/keyboard/manager.h>
+#include <drivers/serial/uart.h>
+#include <general/string.h>
+#include <interrupts/statistics.h>
+#include <sync/lock_statistics.h>
+#include <sync/rcu.h>
+#include <task/scheduler.h>
+#include <task/thread.h>
+#include <time/clock.h>
+#include <time/clock_event.h>
+#include <time/timer.h>
+#include <time/wall_clock.h>
+
+#include "command.h"
+#include "idle.h"
+#include "shell.h"
+#include "smp.h"
+
+#define COMMAND_MAX_NUMBER      (32)
+#define COMMAND_NAME_MAX_LENGTH (32)
+
+struct command {
+    const char *name;
+    const char *description;
+    command_function_t function;
+};
+
+/*
+ * Commands are registered at runtime instead of being listed in an initialized table because the
+ * boot loader does not relocate the kernel, so pointers in initialized data would be wrong.
+ */
+struct command_data {
+    struct command commands[COMMAND_MAX_NUMBER];
+    uint64_t command_number;
+};
+
+static struct command_data global_command_data;
+
+static void command_help(const char *const arguments)
+{
+    (void)arguments;
+
+    for (uint64_t i = 0; i < global_command_data.command_number; ++i) {
+        shell_print_format("%s: %s\n", global_command_data.commands[i].name,
+                global_command_data.commands[i].description);
+    }
+}
+
+static void command_irqstat(const char *const arguments)
+{
+    if (string_compare(arguments, "serial") == 0) {
+        interrupt_statistics_print(uart_print_format);
+        shell_print_format("Dumped to the serial port.\n");
+        return;
+    }
+
+    interrupt_statistics_print(shell_print_format);
+}
+
+static void command_clock(const char *const arguments)
+{
+    (void)arguments;
+
+    const uint64_t uptime = clock_get_nanoseconds();
+
+    shell_print_format("TSC: %lu kHz, %s\n", clock_get_frequency() / 1000,
+            clock_is_invariant() ? "invariant" : "not invariant");
+    shell_print_format("Clock event: %s\n",
+            clock_event_get_mode() == CLOCK_EVENT_MODE_TSC_DEADLINE ? "TSC deadline"
+            : "local APIC timer");
+    shell_print_format("Uptime: %lu ms\n", uptime / CLOCK_NANOSECONDS_PER_MILLISECOND);
+}
+
+static void command_sleep(const char *const arguments)
+{
+    uint64_t milliseconds;
+
+    if (string_to_unsigned(arguments, &milliseconds) != 0) {
+        shell_print_format("Usage: sleep <milliseconds>\n");
+        return;
+    }
+
+    const uint64_t start = clock_get_nanoseconds();
+    thread_sleep(milliseconds * CLOCK_NANOSECONDS_PER_MILLISECOND);
+    const uint64_t end = clock_get_nanoseconds();
+
+    shell_print_format("Slept %lu us\n", (end - start) / CLOCK_NANOSECONDS_PER_MICROSECOND);
+}
+
+static void command_idle(const char *const arguments)
+{
+    (void)arguments;
+
+    const uint64_t uptime = clock_get_nanoseconds();
+    const uint64_t idle_time = idle_get_nanoseconds(cpu_local_index());
+
+    shell_print_format("Idle: %lu ms of %lu ms (%lu percent), using %s\n",
+            idle_time / CLOCK_NANOSECONDS_PER_MILLISECOND,
+            uptime / CLOCK_NANOSECONDS_PER_MILLISECOND,
+            uptime == 0 ? 0 : idle_time * 100 / uptime,
+            idle_is_using_mwait() ? "MWAIT" : "HLT");
+}
+
+static void command_cpus(const char *const arguments)
+{
+    (void)arguments;
+
+    const uint64_t uptime = clock_get_nanoseconds();
+
+    for (uint32_t i = 0; i < smp_get_cpu_number(); ++i) {
+        const uint64_t idle_time = idle_get_nanoseconds(i);
+
+        shell_print_format("CPU %u: local APIC %u, idle %lu percent, %lu migrations%s\n", i,
+                smp_get_local_apic_id(i), uptime == 0 ? 0 : idle_time * 100 / uptime,
+                scheduler_get_migration_number(i), i == cpu_local_index() ? " (current)" : "");
+    }
+}
+
+static void command_timers(const char *const arguments)
+{
+    (void)arguments;
+
+    const uint64_t now = clock_get_nanoseconds();
+
+    for (uint32_t i = 0; i < smp_get_cpu_number(); ++i) {
+        struct timer_statistics statistics;
+        timer_get_statistics(i, &statistics);
+
+        const uint64_t next_deadline = timer_get_next_deadline(i);
+
+        shell_print_format("CPU %u: %lu pending, %lu expired in %lu batches", i,
+                statistics.pending_number, statistics.expired_number, statistics.batch_number);
+        if (next_deadline != UINT64_MAX) {
+            shell_print_format(", next in %lu us", next_deadline > now
+                    ? (next_deadline - now) / CLOCK_NANOSECONDS_PER_MICROSECOND : 0);
+        }
+        shell_print_format("\n");
+    }
+}
+
+static void command_locks(const char *const arguments)
+{
+    if (string_compare(arguments, "reset") == 0) {
+        lock_statistics_reset();
+        return;
+    }
+
+    lock_statistics_print(shell_print_format);
+}
+
+static void command_rcu(const char *const arguments)
+{
+    (void)arguments;
+
+    rcu_print(shell_print_format);
+}
+
+static void command_keyboard(const char *const arguments)
+{
+    (void)arguments;
+
+    struct histogram latency;
+    keyboard_get_latency(&latency);
+
+    shell_print_format("%lu keys read\n", histogram_get_count(&latency));
+    histogram_print(shell_print_format, "latency (ns)", &latency);
+}
+
+static bool is_wall_clock_synchronized(void *const context)
+{
+    (void)context;
+
+    return wall_clock_is_synchronized();
+}
+
+static void command_date(const char *const arguments)
+{
+    struct wall_clock_date date;
+
+    if (string_compare(arguments, "sync") == 0) {
+        wall_clock_synchronize();
+        thread_wait_until(is_wall_clock_synchronized, NULL);
+    }
+
+    wall_clock_get_date(&date);
+
+    shell_print_format("%u-%02u-%02u %02u:%02u:%02u.%03u UTC%s\n", date.year, date.month,
+            date.day, date.hour, date.minute, date.second,
+            date.nanosecond / (uint32_t)CLOCK_NANOSECONDS_PER_MILLISECOND,
+            wall_clock_is_synchronized() ? "" : " (not synchronized)");
+}
+
+void command_initialize(void)
+{
+    global_command_data.command_number = 0;
+
+    command_register("help", "List commands.", command_help);
+    command_register("irqstat", "Print interrupt latency. 'irqstat serial' dumps to COM1.",
+            command_irqstat);
+    command_register("clock", "Print the clock source and the uptime.", command_clock);
+    command_register("sleep", "Sleep for the given milliseconds.", command_sleep);
+    command_register("idle", "Print the time the processor spent asleep.", command_idle);
+    command_register("cpus", "List running processors.", command_cpus);
+    command_register("timers", "Print pending timers of each processor.", command_timers);
+    command_register("locks", "Print lock statistics. 'locks reset' clears them.", command_locks);
+    command_register("rcu", "Print RCU grace periods and callbacks.", command_rcu);
+    command_register("keyboard", "Print latency from key presses to the shell.",
+            command_keyboard);
+    command_register("date", "Print the date. 'date sync' reads the RTC again.", command_date);
+}
+
+int command_register(const char *const name, const char *const description,
+        command_function_t function)
+{
+    if (global_command_data.command_number >= COMMAND_MAX_NUMBER) {
+        return -1;
+    }
+
+    struct command *const command = &global_command_data.commands[global_command_data.command_number];
+    command->name = name;
+    command->description = description;
+    command->function = function;
+
+    ++global_command_data.command_number;
+
+    return 0;
+}
+
+static inline bool is_space(char ch)
+{
+    return ch == ' ' || ch == '\t';
+}
+
+int command_execute(const char *const line)
+{
+    char name[COMMAND_NAME_MAX_LENGTH];
+    const char *cursor = line;
+    uint64_t name_length = 0;
+
+    while (is_space(*cursor)) {
+        ++cursor;
+    }
+
+    if (*cursor == '\0') {
+        return 0;
+    }
+
+    while (*cursor != '\0' && !is_space(*cursor)) {
+        if (name_length >= sizeof(name) - 1) {
+            return -1;
+        }
+        name[name_length++] = *cursor++;
+    }
+    name[name_length] = '\0';
+
+    while (is_space(*cursor)) {
+        ++cursor;
+    }
+
+    for (uint64_t i = 0; i < global_command_data.command_number; ++i) {
+        const struct command *const command = &global_command_data.commands[i];
+
+        if (string_compare(command->name, name) == 0) {
+            command->function(cursor);
+            return 0;
+        }
+    }
+
+    return -1;
+}
@@ -0,0 +1,31 @@
+#ifndef _KERNEL_COMMAND_H
+#define _KERNEL_COMMAND_H
+
+/**
+ * A shell command.
+ *
+ * @param arguments Rest of the command line after the command name, without leading spaces.
+ */
+typedef void (*command_function_t)(const char *const arguments);
+
+/** Reset the command table and register built-in commands. */
+void command_initialize(void);
+
+/**
+ * Register a command.
+ *
+ * `name` and `description` are not copied, so they have to stay valid.
+ *
+ * @return 0 on success, -1 if the command table is full.
+ */
+int command_register(const char *const name, const char *const description,
+        command_function_t function);
+
+/**
+ * Run the command named by the first word of `line`.
+ *
+ * @return 0 on success or if `line` is empty, -1 if there is no such command.
+ */
+int command_execute(const char *const line);
+
+#endif
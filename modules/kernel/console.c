@@ -1,4 +1,8 @@
 #include <stdarg.h>
+#include <stdbool.h>
+#include <drivers/graphic/back_buffer.h>
+#include <drivers/graphic/glyph_cache.h>
+#include <drivers/graphic/pixel_format.h>
 #include <drivers/graphic/screen.h>
 #include <general/memory.h>
 #include <general/string.h>
@@ -8,7 +12,7 @@
 #define PRINT_FORMAT_BUFFER_SIZE (1024)
 #define PRINT_TAB_SIZE    (4)
 #define PSF1_GLYPH_HEIGHT (16)
-#define PSF1_GLYPH_WIDTH  (8)
+#define PSF1_GLYPH_WIDTH  (SCREEN_GLYPH_WIDTH)
 
 struct console_cursor {
     uint64_t x;
@@ -17,7 +21,10 @@ struct console_cursor {
 
 struct console_data {
     struct console_cursor cursor;
+    /** Where the console draws, the back buffer once it is enabled. */
     struct graphic_frame_buffer_data frame_buffer_data;
+    struct back_buffer back_buffer;
+    bool is_back_buffer_enabled;
     struct pixel_color foreground_color;
     struct pixel_color background_color;
     struct psf1_data psf1_data;
@@ -30,10 +37,15 @@ int console_initialize(struct graphic_frame_buffer_data frame_buffer_data,
         struct psf1_data psf1_data, struct pixel_color foreground_color,
         struct pixel_color background_color, uint64_t pixel_block_size)
 {
+    if (pixel_format_initialize(&frame_buffer_data) != 0) {
+        return -1;
+    }
+
     global_console_data.cursor.x = 0;
     global_console_data.cursor.y = 0;
 
     global_console_data.frame_buffer_data = frame_buffer_data;
+    global_console_data.is_back_buffer_enabled = false;
 
     global_console_data.foreground_color = foreground_color;
     global_console_data.background_color = background_color;
@@ -42,25 +54,53 @@ int console_initialize(struct graphic_frame_buffer_data frame_buffer_data,
 
     global_console_data.pixel_block_size = pixel_block_size;
 
+    glyph_cache_initialize();
+
     return 0;
 }
 
+int console_enable_back_buffer(void)
+{
+    if (back_buffer_initialize(&global_console_data.back_buffer,
+                &global_console_data.frame_buffer_data) != 0) {
+        return -1;
+    }
+
+    global_console_data.frame_buffer_data = global_console_data.back_buffer.back;
+    global_console_data.is_back_buffer_enabled = true;
+
+    return 0;
+}
+
+static inline void add_damage(uint64_t x, uint64_t y, uint64_t width, uint64_t height)
+{
+    if (global_console_data.is_back_buffer_enabled) {
+        back_buffer_add_damage(&global_console_data.back_buffer, x, y, width, height);
+    }
+}
+
+void console_flush(void)
+{
+    if (global_console_data.is_back_buffer_enabled) {
+        back_buffer_flush(&global_console_data.back_buffer);
+    }
+}
+
 void console_clear(void)
 {
     struct console_cursor *const cursor = &global_console_data.cursor;
     const struct graphic_frame_buffer_data *const frame_buffer_data = &global_console_data.frame_buffer_data;
 
-    for (uint64_t i = 0; i < frame_buffer_data->height; ++i) {
-        for (uint64_t j = 0; j < frame_buffer_data->width; ++j) {
-            screen_draw_block(frame_buffer_data, j, i, global_console_data.background_color, 1);
-        }
-    }
+    screen_clear(frame_buffer_data, global_console_data.background_color);
+
+    add_damage(0, 0, frame_buffer_data->width, frame_buffer_data->height);
+    console_flush();
 
     cursor->x = 0;
     cursor->y = 0;
 }
 
-int console_print_char(char ch)
+static int print_char(char ch)
 {
     const uint64_t pixel_block_size = global_console_data.pixel_block_size;
     struct console_cursor *const cursor = &global_console_data.cursor;
@@ -78,30 +118,31 @@ int console_print_char(char ch)
 
     const uint8_t *const glyph = &psf1_data->glyph_buffer[ch * psf1_data->header.glyph_size];
 
-    for (uint64_t y = 0; y < PSF1_GLYPH_HEIGHT; ++y) {
-        for (uint64_t x = 0; x < PSF1_GLYPH_WIDTH; ++x) {
-            if ((glyph[y] << x) & 0x80) {
-                screen_draw_block(frame_buffer_data,
-                        cursor->x + (x * pixel_block_size), cursor->y + (y * pixel_block_size),
-                        global_console_data.foreground_color, pixel_block_size);
-            } else {
-                screen_draw_block(frame_buffer_data,
-                        cursor->x + (x * pixel_block_size), cursor->y + (y * pixel_block_size),
-                        global_console_data.background_color, pixel_block_size);
-            }
-        }
-    }
+    glyph_cache_draw(frame_buffer_data, cursor->x, cursor->y, glyph, PSF1_GLYPH_HEIGHT,
+            global_console_data.foreground_color, global_console_data.background_color,
+            pixel_block_size);
+    add_damage(cursor->x, cursor->y, pixel_block_size * PSF1_GLYPH_WIDTH,
+            pixel_block_size * PSF1_GLYPH_HEIGHT);
 
     cursor->x += pixel_block_size * PSF1_GLYPH_WIDTH;
 
     return 0;
 }
 
+int console_print_char(char ch)
+{
+    const int result = print_char(ch);
+    console_flush();
+
+    return result;
+}
+
 int console_print_string(const char *const string)
 {
     for (uint64_t i = 0; string[i] != '\0'; ++i) {
-        console_print_char(string[i]);
+        print_char(string[i]);
     }
+    console_flush();
 
     return 0;
 }
@@ -135,6 +176,11 @@ struct console_cursor console_get_cursor(void)
     return global_console_data.cursor;
 }
 
+struct graphic_frame_buffer_data console_get_frame_buffer_data(void)
+{
+    return global_console_data.frame_buffer_data;
+}
+
 void console_set_foreground_color(struct pixel_color color)
 {
     global_console_data.foreground_color = color;
@@ -166,6 +212,30 @@ uint64_t console_get_height(void)
     return frame_buffer_data->height / (pixel_block_size * PSF1_GLYPH_HEIGHT);
 }
 
+void console_draw_cell(uint64_t row, uint64_t col, char ch)
+{
+    const uint64_t pixel_block_size = global_console_data.pixel_block_size;
+
+    global_console_data.cursor.x = col * pixel_block_size * PSF1_GLYPH_WIDTH;
+    global_console_data.cursor.y = row * pixel_block_size * PSF1_GLYPH_HEIGHT;
+
+    print_char(ch);
+}
+
+int console_move_rows(uint64_t destination_row, uint64_t source_row, uint64_t row_number)
+{
+    if (!global_console_data.is_back_buffer_enabled) {
+        return -1;
+    }
+
+    const uint64_t row_height = global_console_data.pixel_block_size * PSF1_GLYPH_HEIGHT;
+
+    back_buffer_move_rows(&global_console_data.back_buffer, destination_row * row_height,
+            source_row * row_height, row_number * row_height);
+
+    return 0;
+}
+
 void console_draw(const char *const buffer, uint64_t row_size, uint64_t col_size)
 {
     global_console_data.cursor.x = 0;
@@ -173,9 +243,11 @@ void console_draw(const char *const buffer, uint64_t row_size, uint64_t col_size
 
     for (uint64_t row = 0; row < row_size; ++row) {
         for (uint64_t col = 0; col < col_size; ++col) {
-            console_print_char(buffer[row * col_size + col]);
+            print_char(buffer[row * col_size + col]);
         }
         global_console_data.cursor.x = 0;
         global_console_data.cursor.y += global_console_data.pixel_block_size * PSF1_GLYPH_HEIGHT;
     }
+
+    console_flush();
 }
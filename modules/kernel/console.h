@@ -27,6 +27,17 @@ int console_initialize(struct graphic_frame_buffer_data frame_buffer_data,
         struct psf1_data psf1_data, struct pixel_color foreground_color,
         struct pixel_color background_color, uint64_t pixel_block_size);
 
+/**
+ * Draw into a back buffer in normal memory from now on, flushing changes to the screen at the end
+ * of every print. Call this once the frame allocator works.
+ *
+ * @return 0 on success, -1 if the back buffer could not be allocated.
+ */
+int console_enable_back_buffer(void);
+
+/** Copy what changed since the last flush to the screen. */
+void console_flush(void);
+
 void console_clear(void);
 
 int console_print_char(char ch);
@@ -39,6 +50,8 @@ void console_set_cursor(uint64_t x, uint64_t y);
 
 struct console_cursor console_get_cursor(void);
 
+struct graphic_frame_buffer_data console_get_frame_buffer_data(void);
+
 void console_set_foreground_color(struct pixel_color color);
 
 void console_set_background_color(struct pixel_color color);
@@ -51,4 +64,15 @@ uint64_t console_get_height(void);
 
 void console_draw(const char *const buffer, uint64_t row_size, uint64_t col_size);
 
+/**
+ * Move `row_number` rows of the console grid from `source_row` to `destination_row` without
+ * drawing them again. Call `console_flush` afterward.
+ *
+ * @return 0 on success, -1 if there is no back buffer to move them in.
+ */
+int console_move_rows(uint64_t destination_row, uint64_t source_row, uint64_t row_number);
+
+/** Draw a character in a cell of the console grid. Call `console_flush` after the last one. */
+void console_draw_cell(uint64_t row, uint64_t col, char ch);
+
 #endif
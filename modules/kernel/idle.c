@@ -0,0 +1,112 @@
+#include <cpu/cpuid.h>
+#include <cpu/local.h>
+#include <cpu/timestamp_counter.h>
+#include <debug/assert.h>
+#include <interrupts/control_register.h>
+#include <sync/rcu.h>
+#include <time/clock.h>
+
+#include "idle.h"
+
+/** Ask MWAIT to treat interrupts as break events even if they are masked. */
+#define IDLE_MWAIT_INTERRUPT_BREAK (0x01)
+/** Request the C1 state. Deeper states take longer to leave and the gain is small in a guest. */
+#define IDLE_MWAIT_HINT_C1         (0x00)
+
+/** Each processor monitors its own cache line, so waking one doesn't disturb the others. */
+struct idle_cpu_data {
+    volatile uint64_t wakeup;
+    uint64_t idle_cycles;
+} __attribute__((aligned(64)));
+
+struct idle_data {
+    struct idle_cpu_data cpus[CPU_MAX_NUMBER];
+    bool is_using_mwait;
+};
+
+static struct idle_data global_idle_data;
+
+static inline void monitor(const volatile void *const address)
+{
+    asm __volatile__("monitor" : : "a"(address), "c"(0), "d"(0));
+}
+
+static inline void mwait(void)
+{
+    asm __volatile__("mwait" : : "a"(IDLE_MWAIT_HINT_C1), "c"(IDLE_MWAIT_INTERRUPT_BREAK)
+            : "memory");
+}
+
+void idle_initialize(void)
+{
+    for (uint64_t i = 0; i < CPU_MAX_NUMBER; ++i) {
+        global_idle_data.cpus[i].wakeup = 0;
+        global_idle_data.cpus[i].idle_cycles = 0;
+    }
+
+    global_idle_data.is_using_mwait = cpuid_has_monitor_interrupt_break();
+}
+
+void idle_wait_until(idle_condition_t condition, void *const context)
+{
+    assert(get_rflags() & REGISTER_RFLAGS_INTERRUPT, "Waiting with interrupts disabled");
+
+    struct idle_cpu_data *const cpu = &global_idle_data.cpus[cpu_local_index()];
+
+    while (1) {
+        interrupts_disable();
+
+        if (condition(context)) {
+            interrupts_enable();
+            return;
+        }
+
+        const uint64_t start = timestamp_counter_read();
+
+        // Nothing ticks on a sleeping processor, so grace periods have to go on without it.
+        const bool is_rcu_idle = !rcu_is_reading();
+        if (is_rcu_idle) {
+            rcu_enter_idle();
+        }
+
+        if (global_idle_data.is_using_mwait) {
+            /*
+             * Arm the monitor before checking the condition again, so a write to `wakeup` after
+             * the check still wakes MWAIT. Pending interrupts are taken once they are enabled.
+             */
+            monitor(&cpu->wakeup);
+            if (!condition(context)) {
+                mwait();
+            }
+            // A write to `wakeup` ends MWAIT without an interrupt to leave the idle state.
+            if (is_rcu_idle) {
+                rcu_exit_idle();
+            }
+            interrupts_enable();
+        } else {
+            // STI delays interrupts until the next instruction completes, so HLT can't miss one.
+            asm __volatile__("sti \n\t"
+                             "hlt \n\t"
+                             : : : "memory");
+
+            // HLT only ends on an interrupt, which left the idle state already.
+        }
+
+        cpu->idle_cycles += timestamp_counter_read() - start;
+    }
+}
+
+void idle_wake(uint32_t cpu_index)
+{
+    ++global_idle_data.cpus[cpu_index].wakeup;
+}
+
+uint64_t idle_get_nanoseconds(uint32_t cpu_index)
+{
+    return clock_convert_cycles_to_nanoseconds(global_idle_data.cpus[cpu_index].idle_cycles);
+}
+
+bool idle_is_using_mwait(void)
+{
+    return global_idle_data.is_using_mwait;
+}
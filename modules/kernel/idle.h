@@ -0,0 +1,37 @@
+#ifndef _KERNEL_IDLE_H
+#define _KERNEL_IDLE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * A condition to wait for.
+ *
+ * It's evaluated with interrupts disabled, so it must be short and must not block.
+ */
+typedef bool (*idle_condition_t)(void *const context);
+
+void idle_initialize(void);
+
+/**
+ * Put the current processor to sleep until `condition` holds.
+ *
+ * The processor wakes up on every interrupt and checks the condition again, so the condition has
+ * to be made true by an interrupt handler, deferred work or `idle_wake`. The condition is checked
+ * with interrupts disabled right before sleeping, so a wakeup can't be lost in between.
+ *
+ * MWAIT is used when it can be woken up by masked interrupts, HLT otherwise.
+ *
+ * Call this with interrupts enabled.
+ */
+void idle_wait_until(idle_condition_t condition, void *const context);
+
+/** Wake up the processor `cpu_index` if it's waiting in MWAIT. */
+void idle_wake(uint32_t cpu_index);
+
+/** Return nanoseconds the processor `cpu_index` has spent asleep. */
+uint64_t idle_get_nanoseconds(uint32_t cpu_index);
+
+bool idle_is_using_mwait(void);
+
+#endif
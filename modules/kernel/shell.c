@@ -1,43 +1,87 @@
+#include <stdarg.h>
 #include <stddef.h>
 
 #include <drivers/keyboard/manager.h>
-#include <general/memory.h>
 #include <general/string.h>
 #include <kernel/console.h>
 #include <memory/frame_allocator.h>
+#include <sync/spinlock.h>
+#include <task/wait_queue.h>
+#include <time/clock.h>
 
+#include "benchmark.h"
+#include "command.h"
 #include "shell.h"
 
 #define PROMPT         ("$> ")
 #define PROMPT_SIZE    (string_length(PROMPT))
 #define SHELL_TAB_SIZE (4)
 
+#define SHELL_COMMAND_LINE_BUFFER_SIZE (256)
+#define SHELL_PRINT_FORMAT_BUFFER_SIZE (1024)
+
+/** Lines kept for scrolling back, counting those on the screen. */
+#define SHELL_SCROLLBACK_ROW_NUMBER (1000)
+
+#define SHELL_ECHO_BENCHMARK_DEFAULT_KEYSTROKE_NUMBER (1000)
+#define SHELL_SCROLL_BENCHMARK_DEFAULT_LINE_NUMBER    (200)
+/** Never a valid input, so a cell holding it always differs from what is rendered. */
+#define SHELL_INVALID_CELL ('\0')
+
 struct cursor {
     uint64_t row;
     uint64_t col;
 };
 
+/**
+ * Rows of characters kept as a ring, so scrolling moves `top` instead of the characters.
+ *
+ * Rows and columns passed to buffer functions count from the row at `top`.
+ */
 struct buffer_data {
     char *items;
     size_t size;
     size_t row_size;
     size_t col_size;
+    /** Row of `items` where the buffer starts. */
+    size_t top;
+    /** Rows dropped from the start since the buffer was initialized. */
+    uint64_t scrolled_row_number;
     struct cursor cursor;
 };
 
-// TODO: mutex
+/*
+ * Only the shell thread touches `render`, `screen`, `contents` and `command`. Any thread may print
+ * into `exchange`, so it's behind `lock`.
+ *
+ * `screen` holds what was last drawn, so only cells that differ from `render` are drawn again.
+ * `contents` keeps `SHELL_SCROLLBACK_ROW_NUMBER` rows, and `render` shows the rows ending
+ * `scroll_offset` rows above the last one.
+ *
+ * The shell thread sleeps on `wait_queue` until a key is pressed or something is printed.
+ */
 struct shell_data {
     struct buffer_data render;
+    struct buffer_data screen;
     struct buffer_data contents;
     struct buffer_data command;
     struct buffer_data exchange;
+    /**
+     * Row on top of the screen, counting rows of the contents followed by the command line from
+     * the first one ever printed.
+     */
+    uint64_t screen_top;
+    uint64_t scroll_offset;
+    struct spinlock lock;
+    struct lock_statistics lock_statistics;
+    struct wait_queue wait_queue;
 };
 
 static struct shell_data global_shell_data;
 
 static uint64_t buffer_get_index(const struct buffer_data *const buffer, uint64_t row, uint64_t col)
 {
-    return row * buffer->col_size + col;
+    return ((buffer->top + row) % buffer->row_size) * buffer->col_size + col;
 }
 
 static uint64_t buffer_get_next_index(const struct buffer_data *const buffer)
@@ -45,15 +89,29 @@ static uint64_t buffer_get_next_index(const struct buffer_data *const buffer)
     return buffer_get_index(buffer, buffer->cursor.row, buffer->cursor.col);
 }
 
-static void buffer_scroll_up(struct buffer_data *const buffer)
+/** Number of characters before the cursor. */
+static uint64_t buffer_get_length(const struct buffer_data *const buffer)
+{
+    return buffer->cursor.row * buffer->col_size + buffer->cursor.col;
+}
+
+/** Get the character at `offset` characters from the start of the buffer. */
+static char *buffer_get_item(const struct buffer_data *const buffer, uint64_t offset)
 {
-    memory_copy(buffer->items,
-            &buffer->items[buffer->col_size], (buffer->row_size - 1) * buffer->col_size);
+    return &buffer->items[buffer_get_index(buffer, offset / buffer->col_size,
+            offset % buffer->col_size)];
+}
 
+/** Drop the first row and reuse it as the last one. */
+static void buffer_scroll_up(struct buffer_data *const buffer)
+{
     for (uint64_t i = 0; i < buffer->col_size; ++i) {
-        buffer->items[buffer_get_index(buffer, buffer->row_size - 1, i)] = ' ';
+        buffer->items[buffer_get_index(buffer, 0, i)] = ' ';
     }
 
+    buffer->top = (buffer->top + 1) % buffer->row_size;
+    ++buffer->scrolled_row_number;
+
     if (buffer->cursor.row > 0) {
         --buffer->cursor.row;
     }
@@ -76,6 +134,8 @@ static void buffer_initialize(struct buffer_data *const buffer,
     buffer->size = size;
     buffer->row_size = row_size;
     buffer->col_size = col_size;
+    buffer->top = 0;
+    buffer->scrolled_row_number = 0;
     buffer->cursor.row = 0;
     buffer->cursor.col = 0;
 }
@@ -127,24 +187,43 @@ static int buffer_pop(struct buffer_data *const buffer)
     return 0;
 }
 
+static inline void buffer_push_prompt(struct buffer_data *const buffer)
+{
+    // Allocating buffer for prompt would be more flexible but complicated.
+    buffer_push_string(buffer, PROMPT);
+}
+
 static inline void process_command(void)
 {
-    for (uint64_t i = 0; i < buffer_get_index(&global_shell_data.command,
-                global_shell_data.command.cursor.row, global_shell_data.command.cursor.col); ++i) {
-        buffer_push(&global_shell_data.contents, global_shell_data.command.items[i]);
+    char line[SHELL_COMMAND_LINE_BUFFER_SIZE];
+    uint64_t line_size = 0;
+    const uint64_t command_length = buffer_get_length(&global_shell_data.command);
+
+    for (uint64_t i = 0; i < command_length; ++i) {
+        buffer_push(&global_shell_data.contents, *buffer_get_item(&global_shell_data.command, i));
     }
     buffer_newline(&global_shell_data.contents);
 
-    buffer_push_string(&global_shell_data.contents, "Unknown command: ");
+    for (uint64_t i = PROMPT_SIZE; i < command_length && line_size < sizeof(line) - 1; ++i) {
+        line[line_size++] = *buffer_get_item(&global_shell_data.command, i);
+    }
 
-    for (uint64_t i = PROMPT_SIZE; i < buffer_get_index(&global_shell_data.command,
-                global_shell_data.command.cursor.row, global_shell_data.command.cursor.col); ++i) {
-        buffer_push(&global_shell_data.contents, global_shell_data.command.items[i]);
+    while (line_size > 0 && line[line_size - 1] == ' ') {
+        --line_size;
     }
-    buffer_newline(&global_shell_data.contents);
+    line[line_size] = '\0';
 
+    // A long command line may have scrolled the prompt away, so write it again.
+    global_shell_data.command.top = 0;
     global_shell_data.command.cursor.row = 0;
-    global_shell_data.command.cursor.col = PROMPT_SIZE;
+    global_shell_data.command.cursor.col = 0;
+    buffer_push_prompt(&global_shell_data.command);
+
+    if (command_execute(line) != 0) {
+        buffer_push_string(&global_shell_data.contents, "Unknown command: ");
+        buffer_push_string(&global_shell_data.contents, line);
+        buffer_newline(&global_shell_data.contents);
+    }
 }
 
 static inline bool is_valid_input(char input)
@@ -170,8 +249,59 @@ static inline bool is_valid_input(char input)
     return false;
 }
 
+/** Rows of the contents followed by the command line, counting the row the cursor is on. */
+static uint64_t get_total_row_number(void)
+{
+    const struct buffer_data *const contents = &global_shell_data.contents;
+    const uint64_t end = contents->cursor.col + buffer_get_length(&global_shell_data.command);
+
+    return contents->cursor.row + end / contents->col_size + 1;
+}
+
+static inline bool is_scroll_input(char input)
+{
+    return input == (char)ASCII_PAGEUP || input == (char)ASCII_PAGEDOWN;
+}
+
+static void scroll_page_up(void)
+{
+    const uint64_t total_row_number = get_total_row_number();
+    const uint64_t row_size = global_shell_data.render.row_size;
+    const uint64_t max_offset = total_row_number > row_size ? total_row_number - row_size : 0;
+
+    global_shell_data.scroll_offset += row_size - 1;
+    if (global_shell_data.scroll_offset > max_offset) {
+        global_shell_data.scroll_offset = max_offset;
+    }
+}
+
+static void scroll_page_down(void)
+{
+    const uint64_t row_size = global_shell_data.render.row_size;
+
+    if (global_shell_data.scroll_offset < row_size - 1) {
+        global_shell_data.scroll_offset = 0;
+        return;
+    }
+
+    global_shell_data.scroll_offset -= row_size - 1;
+}
+
 static inline void process_input(char input)
 {
+    if (input == (char)ASCII_PAGEUP) {
+        scroll_page_up();
+        return;
+    }
+
+    if (input == (char)ASCII_PAGEDOWN) {
+        scroll_page_down();
+        return;
+    }
+
+    // Typing brings the command line back into view.
+    global_shell_data.scroll_offset = 0;
+
     if (input == '\n') {
         process_command();
         return;
@@ -192,12 +322,6 @@ static inline void process_input(char input)
     buffer_push(&global_shell_data.command, input);
 }
 
-static inline void buffer_push_prompt(struct buffer_data *const buffer)
-{
-    // Allocating buffer for prompt would be more flexible but complicated.
-    buffer_push_string(buffer, PROMPT);
-}
-
 static bool is_exchange_buffer_empty(void)
 {
     if (global_shell_data.exchange.cursor.row > 0 || global_shell_data.exchange.cursor.col > 0) {
@@ -209,17 +333,251 @@ static bool is_exchange_buffer_empty(void)
 
 static inline void process_exchange_buffer(void)
 {
-    for (uint64_t i = 0; i < buffer_get_index(&global_shell_data.exchange,
-                global_shell_data.exchange.cursor.row, global_shell_data.exchange.cursor.col); ++i) {
-        buffer_push(&global_shell_data.contents, global_shell_data.exchange.items[i]);
+    const uint64_t flags = spinlock_lock_save(&global_shell_data.lock);
+
+    const uint64_t exchange_length = buffer_get_length(&global_shell_data.exchange);
+
+    for (uint64_t i = 0; i < exchange_length; ++i) {
+        buffer_push(&global_shell_data.contents, *buffer_get_item(&global_shell_data.exchange, i));
+        *buffer_get_item(&global_shell_data.exchange, i) = ' ';
     }
 
+    global_shell_data.exchange.top = 0;
     global_shell_data.exchange.cursor.row = 0;
     global_shell_data.exchange.cursor.col = 0;
+
+    spinlock_unlock_restore(&global_shell_data.lock, flags);
+}
+
+static bool has_work(void *const context)
+{
+    (void)context;
+
+    return !keyboard_is_buffer_empty() || !is_exchange_buffer_empty();
+}
+
+static void wake_shell(void)
+{
+    wait_queue_wake_all(&global_shell_data.wait_queue);
+}
+
+/**
+ * Get a character of the contents followed by the command line, counting rows from the oldest
+ * row kept in the contents.
+ */
+static char get_composite_char(uint64_t row, uint64_t col)
+{
+    const struct buffer_data *const contents = &global_shell_data.contents;
+
+    if (row < contents->cursor.row || (row == contents->cursor.row && col < contents->cursor.col)) {
+        return contents->items[buffer_get_index(contents, row, col)];
+    }
+
+    const uint64_t offset = (row - contents->cursor.row) * contents->col_size
+        + col - contents->cursor.col;
+
+    if (offset < buffer_get_length(&global_shell_data.command)) {
+        return *buffer_get_item(&global_shell_data.command, offset);
+    }
+
+    return ' ';
+}
+
+/**
+ * Render the rows that fit on the screen, looking only at those rows, however long the
+ * scrollback is.
+ *
+ * @return The row shown on top of the screen, counting from the first row ever printed.
+ */
+static uint64_t composite(void)
+{
+    struct buffer_data *const render = &global_shell_data.render;
+    const uint64_t total_row_number = get_total_row_number();
+    uint64_t top = 0;
+
+    if (total_row_number > render->row_size) {
+        top = total_row_number - render->row_size;
+        top = global_shell_data.scroll_offset > top ? 0 : top - global_shell_data.scroll_offset;
+    }
+
+    for (uint64_t row = 0; row < render->row_size; ++row) {
+        for (uint64_t col = 0; col < render->col_size; ++col) {
+            render->items[buffer_get_index(render, row, col)] = get_composite_char(top + row, col);
+        }
+    }
+
+    return global_shell_data.contents.scrolled_row_number + top;
+}
+
+/**
+ * Move what is on the screen as far as the top row moved, so rows still shown are moved as pixels
+ * instead of being drawn again. Only the rows that come into view are left to draw.
+ */
+static void scroll_screen(uint64_t top)
+{
+    struct buffer_data *const screen = &global_shell_data.screen;
+    const uint64_t previous_top = global_shell_data.screen_top;
+
+    global_shell_data.screen_top = top;
+
+    const uint64_t distance = top > previous_top ? top - previous_top : previous_top - top;
+    if (distance == 0 || distance >= screen->row_size) {
+        return;
+    }
+
+    const uint64_t kept_row_number = screen->row_size - distance;
+    uint64_t exposed_row = 0;
+
+    if (top > previous_top) {
+        if (console_move_rows(0, distance, kept_row_number) != 0) {
+            return;
+        }
+        screen->top = (screen->top + distance) % screen->row_size;
+        exposed_row = kept_row_number;
+    } else {
+        if (console_move_rows(distance, 0, kept_row_number) != 0) {
+            return;
+        }
+        screen->top = (screen->top + screen->row_size - distance) % screen->row_size;
+    }
+
+    for (uint64_t row = exposed_row; row < exposed_row + distance; ++row) {
+        for (uint64_t col = 0; col < screen->col_size; ++col) {
+            screen->items[buffer_get_index(screen, row, col)] = SHELL_INVALID_CELL;
+        }
+    }
+}
+
+/**
+ * Draw the cells of `render` that differ from `screen`.
+ *
+ * @return The number of cells drawn.
+ */
+static uint64_t draw_changes(void)
+{
+    const struct buffer_data *const render = &global_shell_data.render;
+    struct buffer_data *const screen = &global_shell_data.screen;
+    uint64_t drawn_cell_number = 0;
+
+    for (uint64_t row = 0; row < render->row_size; ++row) {
+        for (uint64_t col = 0; col < render->col_size; ++col) {
+            const char item = render->items[buffer_get_index(render, row, col)];
+            char *const drawn_item = &screen->items[buffer_get_index(screen, row, col)];
+
+            if (item != *drawn_item) {
+                console_draw_cell(row, col, item);
+                *drawn_item = item;
+                ++drawn_cell_number;
+            }
+        }
+    }
+
+    console_flush();
+
+    return drawn_cell_number;
+}
+
+static inline uint64_t update_screen(void)
+{
+    scroll_screen(composite());
+
+    return draw_changes();
+}
+
+static void invalidate_screen(void)
+{
+    for (uint64_t i = 0; i < global_shell_data.screen.size; ++i) {
+        global_shell_data.screen.items[i] = SHELL_INVALID_CELL;
+    }
+}
+
+/**
+ * Type a character and erase it again, over and over, redrawing the screen after each keystroke
+ * the way the shell used to, in full, and by drawing only the cells that changed.
+ */
+static void benchmark_echo(const char *const arguments, string_print_t print)
+{
+    uint64_t keystroke_number = SHELL_ECHO_BENCHMARK_DEFAULT_KEYSTROKE_NUMBER;
+
+    if (*arguments != '\0'
+            && (string_to_unsigned(arguments, &keystroke_number) != 0 || keystroke_number == 0)) {
+        print("Usage: bench echo [keystrokes]\n");
+        return;
+    }
+
+    // Pairs of keystrokes, so the command line ends up as it was.
+    keystroke_number = (keystroke_number + 1) / 2 * 2;
+
+    for (uint64_t is_incremental = 0; is_incremental < 2; ++is_incremental) {
+        uint64_t drawn_cell_number = 0;
+        const uint64_t start = clock_get_nanoseconds();
+
+        for (uint64_t i = 0; i < keystroke_number; ++i) {
+            process_input(i % 2 == 0 ? 'x' : ASCII_BACKSPACE);
+
+            if (!is_incremental) {
+                invalidate_screen();
+            }
+
+            drawn_cell_number += update_screen();
+        }
+
+        const uint64_t time = clock_get_nanoseconds() - start;
+
+        print("%s: %lu ns/keystroke, %lu cells drawn/keystroke\n",
+                is_incremental ? "changed cells" : "full redraw  ", time / keystroke_number,
+                drawn_cell_number / keystroke_number);
+    }
+}
+
+/**
+ * Print lines one at a time, updating the screen after each, drawing every cell and by moving
+ * rows.
+ */
+static void benchmark_scroll(const char *const arguments, string_print_t print)
+{
+    uint64_t line_number = SHELL_SCROLL_BENCHMARK_DEFAULT_LINE_NUMBER;
+
+    if (*arguments != '\0'
+            && (string_to_unsigned(arguments, &line_number) != 0 || line_number == 0)) {
+        print("Usage: bench scroll [lines]\n");
+        return;
+    }
+
+    global_shell_data.scroll_offset = 0;
+
+    for (uint64_t is_moving = 0; is_moving < 2; ++is_moving) {
+        uint64_t drawn_cell_number = 0;
+        const uint64_t start = clock_get_nanoseconds();
+
+        for (uint64_t i = 0; i < line_number; ++i) {
+            buffer_push_string(&global_shell_data.contents,
+                    is_moving ? "scrolled by moving rows" : "scrolled by drawing every cell");
+            buffer_newline(&global_shell_data.contents);
+
+            if (!is_moving) {
+                invalidate_screen();
+            }
+
+            drawn_cell_number += update_screen();
+        }
+
+        const uint64_t time = clock_get_nanoseconds() - start;
+
+        print("%s: %lu ns/line, %lu cells drawn/line\n",
+                is_moving ? "moved rows " : "full redraw", time / line_number,
+                drawn_cell_number / line_number);
+    }
 }
 
 static inline int shell_initialize(void)
 {
+    spinlock_initialize(&global_shell_data.lock);
+    if (lock_statistics_register(&global_shell_data.lock_statistics, "shell") == 0) {
+        spinlock_set_statistics(&global_shell_data.lock, &global_shell_data.lock_statistics);
+    }
+    wait_queue_initialize(&global_shell_data.wait_queue);
+
     const uint64_t console_width = console_get_width();
     const uint64_t console_height = console_get_height();
     const size_t required_buffer_size = console_width * console_height;
@@ -227,9 +585,17 @@ static inline int shell_initialize(void)
     const size_t render_frame_number = required_buffer_size % MEMORY_FRAME_SIZE == 0
         ? required_buffer_size / MEMORY_FRAME_SIZE
         : required_buffer_size / MEMORY_FRAME_SIZE + 1;
-    const size_t contents_frame_number = render_frame_number;
+    const size_t screen_frame_number = render_frame_number;
+    const uint64_t contents_row_size = console_height > SHELL_SCROLLBACK_ROW_NUMBER
+        ? console_height : SHELL_SCROLLBACK_ROW_NUMBER;
+    const size_t contents_frame_number =
+        (contents_row_size * console_width + MEMORY_FRAME_SIZE - 1) / MEMORY_FRAME_SIZE;
     const size_t command_frame_number = render_frame_number;
-    const size_t exchange_frame_number = render_frame_number;
+    /*
+     * A command prints into the exchange buffer until it returns to the shell loop, so it keeps
+     * as many rows as the scrollback. Otherwise long output would wrap there and be lost first.
+     */
+    const size_t exchange_frame_number = contents_frame_number;
 
     // TODO: This implementation suffers from internal fragmentation. We need a better allocator.
 
@@ -238,69 +604,78 @@ static inline int shell_initialize(void)
         return -1;
     }
 
+    frame_t screen_frame = frame_allcoator_request(screen_frame_number);
+    if (screen_frame == MEMORY_FRAME_NULL) {
+        frame_allocator_free(render_frame, render_frame_number);
+        return -2;
+    }
+
     frame_t contents_frame = frame_allcoator_request(contents_frame_number);
     if (contents_frame == MEMORY_FRAME_NULL) {
         frame_allocator_free(render_frame, render_frame_number);
-        return -2;
+        frame_allocator_free(screen_frame, screen_frame_number);
+        return -3;
     }
 
     frame_t command_frame = frame_allcoator_request(command_frame_number);
     if (command_frame == MEMORY_FRAME_NULL) {
         frame_allocator_free(render_frame, render_frame_number);
+        frame_allocator_free(screen_frame, screen_frame_number);
         frame_allocator_free(contents_frame, contents_frame_number);
-        return -3;
+        return -4;
     }
 
     frame_t exchange_frame = frame_allcoator_request(exchange_frame_number);
     if (exchange_frame == MEMORY_FRAME_NULL) {
         frame_allocator_free(render_frame, render_frame_number);
+        frame_allocator_free(screen_frame, screen_frame_number);
         frame_allocator_free(contents_frame, contents_frame_number);
         frame_allocator_free(command_frame, command_frame_number);
-        return -4;
+        return -5;
     }
 
     buffer_initialize(&global_shell_data.render, render_frame,
             render_frame_number * MEMORY_FRAME_SIZE, console_height, console_width);
 
+    buffer_initialize(&global_shell_data.screen, screen_frame,
+            screen_frame_number * MEMORY_FRAME_SIZE, console_height, console_width);
+
     buffer_initialize(&global_shell_data.contents, contents_frame,
-            contents_frame_number * MEMORY_FRAME_SIZE, console_height, console_width);
+            contents_frame_number * MEMORY_FRAME_SIZE, contents_row_size, console_width);
 
     buffer_initialize(&global_shell_data.command, command_frame,
             command_frame_number * MEMORY_FRAME_SIZE, console_height, console_width);
     buffer_push_prompt(&global_shell_data.command);
 
     buffer_initialize(&global_shell_data.exchange, exchange_frame,
-            exchange_frame_number * MEMORY_FRAME_SIZE, console_height, console_width);
+            exchange_frame_number * MEMORY_FRAME_SIZE, contents_row_size, console_width);
 
     for (uint64_t i = 0; i < global_shell_data.render.size; ++i) {
         global_shell_data.render.items[i] = ' ';
     }
 
+    global_shell_data.screen_top = 0;
+    global_shell_data.scroll_offset = 0;
+
+    // Nothing the shell rendered is on the screen yet.
+    for (uint64_t i = 0; i < global_shell_data.screen.size; ++i) {
+        global_shell_data.screen.items[i] = SHELL_INVALID_CELL;
+    }
+
     for (uint64_t i = 0; i < global_shell_data.contents.size; ++i) {
         global_shell_data.contents.items[i] = ' ';
     }
 
-    return 0;
-}
-
-static void composite(void)
-{
-    for (uint64_t i = 0; i < global_shell_data.render.size; ++i) {
-        global_shell_data.render.items[i] = ' ';
+    for (uint64_t i = 0; i < global_shell_data.exchange.size; ++i) {
+        global_shell_data.exchange.items[i] = ' ';
     }
 
-    global_shell_data.render.cursor.row = 0;
-    global_shell_data.render.cursor.col = 0;
-
-    for (uint64_t i = 0; i < buffer_get_index(&global_shell_data.contents,
-                global_shell_data.contents.cursor.row, global_shell_data.contents.cursor.col); ++i) {
-        buffer_push(&global_shell_data.render, global_shell_data.contents.items[i]);
-    }
+    command_initialize();
+    benchmark_initialize();
+    benchmark_register("echo", benchmark_echo);
+    benchmark_register("scroll", benchmark_scroll);
 
-    for (uint64_t i = 0; i < buffer_get_index(&global_shell_data.command,
-                global_shell_data.command.cursor.row, global_shell_data.command.cursor.col); ++i) {
-        buffer_push(&global_shell_data.render, global_shell_data.command.items[i]);
-    }
+    return 0;
 }
 
 int shell_start(void)
@@ -318,30 +693,30 @@ int shell_start(void)
         return -2;
     }
 
+    keyboard_set_handler(wake_shell);
+
     while (1) {
+        wait_queue_wait(&global_shell_data.wait_queue, has_work, NULL);
+
         if (!keyboard_is_buffer_empty()) {
             result = keyboard_get_input(&input);
-            if (result == 0 && is_valid_input(input)) {
+            if (result == 0 && (is_valid_input(input) || is_scroll_input(input))) {
                 process_input(input);
-                composite();
-                console_draw(global_shell_data.render.items,
-                        global_shell_data.render.row_size,
-                        global_shell_data.render.col_size);
+                update_screen();
             }
         }
 
         if (!is_exchange_buffer_empty()) {
             process_exchange_buffer();
-            composite();
-            console_draw(global_shell_data.render.items,
-                    global_shell_data.render.row_size,
-                    global_shell_data.render.col_size);
+            update_screen();
         }
     }
 }
 
 int shell_insert(const byte_t *const data, size_t size)
 {
+    const uint64_t flags = spinlock_lock_save(&global_shell_data.lock);
+
     for (uint64_t i = 0; i < size; ++i) {
         if (!is_valid_input(data[i])) {
             continue;
@@ -367,5 +742,30 @@ int shell_insert(const byte_t *const data, size_t size)
         buffer_push(&global_shell_data.exchange, data[i]);
     }
 
+    spinlock_unlock_restore(&global_shell_data.lock, flags);
+
+    wake_shell();
+
     return 0;
 }
+
+void shell_redraw(void)
+{
+    invalidate_screen();
+}
+
+int shell_print_format(const char *const format, ...)
+{
+    char buffer[SHELL_PRINT_FORMAT_BUFFER_SIZE];
+
+    va_list ap;
+    va_start(ap, format);
+    int result = string_format_va(buffer, sizeof(buffer), format, ap);
+    va_end(ap);
+
+    if (result != 0) {
+        return -1;
+    }
+
+    return shell_insert((const byte_t *)buffer, string_length(buffer));
+}
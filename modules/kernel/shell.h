@@ -8,4 +8,19 @@ int shell_insert(const byte_t *const data, size_t size);
 
 int shell_start(void);
 
+/**
+ * Draw every cell again on the next update, after something else drew over the shell.
+ *
+ * Call this from the shell thread, such as from a command.
+ */
+void shell_redraw(void);
+
+/**
+ * Print formatted string on the shell.
+ *
+ * The output shows up after the shell processes its exchange buffer. Do not call this function in
+ * interrupt handlers.
+ */
+int shell_print_format(const char *const format, ...);
+
 #endif
@@ -0,0 +1,217 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <acpi/madt.h>
+#include <asm/kernel/trampoline.h>
+#include <cpu/local.h>
+#include <cpu/model_specific_register.h>
+#include <general/memory.h>
+#include <interrupts/control_register.h>
+#include <interrupts/initialize.h>
+#include <interrupts/local_apic.h>
+#include <memory/frame_allocator.h>
+#include <memory/page.h>
+#include <memory/segment.h>
+#include <memory/stack.h>
+#include <task/thread.h>
+#include <time/clock.h>
+#include <time/clock_event.h>
+
+#include "smp.h"
+
+/** 16 KiB of stack for the idle thread of each application processor, plus a guard page. */
+#define SMP_STACK_PAGE_NUMBER (4)
+
+/** Waits of the INIT-SIPI-SIPI sequence recommended by the Intel SDM. */
+#define SMP_INIT_DELAY    (10 * CLOCK_NANOSECONDS_PER_MILLISECOND)
+#define SMP_STARTUP_DELAY (200 * CLOCK_NANOSECONDS_PER_MICROSECOND)
+
+/** How long to wait for a started processor to come online. */
+#define SMP_ONLINE_TIMEOUT (100 * CLOCK_NANOSECONDS_PER_MILLISECOND)
+
+struct smp_cpu_data {
+    uint32_t local_apic_id;
+    struct stack stack;
+    /** Set by the processor itself once it's ready to run threads. */
+    bool is_online;
+};
+
+struct smp_data {
+    struct smp_cpu_data cpus[CPU_MAX_NUMBER];
+    uint32_t cpu_number;
+};
+
+static struct smp_data global_smp_data;
+
+/** Called by the startup code on the stack the bootstrap processor allocated. */
+static __attribute__((noreturn)) void start_application_processor(uint64_t cpu_index)
+{
+    cpu_local_initialize(cpu_index);
+    segment_initialize();
+    interrupts_initialize_application_processor();
+    clock_event_initialize_application_processor();
+
+    const int result = thread_initialize_application_processor();
+
+    /*
+     * The bootstrap processor gives up on the processor if it stays silent, so it must not run
+     * anything without threads. Leave it halted with interrupts disabled.
+     */
+    if (result != 0) {
+        while (1) {
+            asm __volatile__("cli; hlt");
+        }
+    }
+
+    __atomic_store_n(&global_smp_data.cpus[cpu_index].is_online, true, __ATOMIC_RELEASE);
+
+    interrupts_enable();
+    thread_idle();
+}
+
+static void prepare_trampoline(address_t trampoline_address, uint32_t cpu_index)
+{
+    const address_t start_address = (address_t)smp_trampoline_start;
+    const uint64_t size = (address_t)smp_trampoline_end - start_address;
+
+    // The startup code patches itself, so each processor needs a fresh copy.
+    memory_copy((void *)trampoline_address, (const void *)start_address, size);
+
+    struct smp_trampoline_data *const data = (struct smp_trampoline_data *)(trampoline_address
+            + ((address_t)smp_trampoline_data - start_address));
+
+    uint64_t control_register0;
+    uint64_t control_register3;
+    uint64_t control_register4;
+    asm __volatile__("mov %%cr0, %0" : "=r"(control_register0));
+    asm __volatile__("mov %%cr3, %0" : "=r"(control_register3));
+    asm __volatile__("mov %%cr4, %0" : "=r"(control_register4));
+
+    data->control_register0 = control_register0;
+    data->control_register3 = control_register3;
+    data->control_register4 = control_register4;
+    data->efer = model_specific_register_read(MODEL_SPECIFIC_REGISTER_EFER)
+        & ~(uint64_t)MODEL_SPECIFIC_REGISTER_EFER_LMA;
+    data->stack_pointer = global_smp_data.cpus[cpu_index].stack.top_address;
+    data->entry_address = (address_t)start_application_processor;
+    data->argument = cpu_index;
+}
+
+static bool is_online(uint32_t cpu_index)
+{
+    return __atomic_load_n(&global_smp_data.cpus[cpu_index].is_online, __ATOMIC_ACQUIRE);
+}
+
+static bool wait_online(uint32_t cpu_index, uint64_t timeout)
+{
+    const uint64_t deadline = clock_get_nanoseconds() + timeout;
+
+    while (clock_get_nanoseconds() < deadline) {
+        if (is_online(cpu_index)) {
+            return true;
+        }
+        asm __volatile__("pause");
+    }
+
+    return is_online(cpu_index);
+}
+
+/** Start a processor with the INIT-SIPI-SIPI sequence. */
+static bool start_processor(uint32_t cpu_index, address_t trampoline_address)
+{
+    const uint32_t local_apic_id = global_smp_data.cpus[cpu_index].local_apic_id;
+    const uint8_t page_number = trampoline_address / PAGE_SIZE;
+
+    local_apic_send_init(local_apic_id);
+    clock_delay(SMP_INIT_DELAY);
+
+    // The second startup IPI is only for processors that missed the first one.
+    local_apic_send_startup(local_apic_id, page_number);
+    if (wait_online(cpu_index, SMP_STARTUP_DELAY)) {
+        return true;
+    }
+
+    local_apic_send_startup(local_apic_id, page_number);
+
+    return wait_online(cpu_index, SMP_ONLINE_TIMEOUT);
+}
+
+int smp_initialize(void)
+{
+    for (uint64_t i = 0; i < CPU_MAX_NUMBER; ++i) {
+        global_smp_data.cpus[i].local_apic_id = 0;
+        global_smp_data.cpus[i].is_online = false;
+    }
+
+    global_smp_data.cpus[0].local_apic_id = local_apic_get_id();
+    global_smp_data.cpus[0].is_online = true;
+    global_smp_data.cpu_number = 1;
+
+    uint8_t local_apic_ids[CPU_MAX_NUMBER];
+    const int local_apic_number = madt_get_local_apic_ids(local_apic_ids, CPU_MAX_NUMBER);
+    if (local_apic_number < 0) {
+        return -1;
+    }
+
+    // The startup code loads CR3 in protected mode.
+    const struct page_data page_data = page_get_loaded();
+    if ((address_t)page_data.level4_table > UINT32_MAX) {
+        return -2;
+    }
+
+    const frame_t trampoline = frame_allocator_request_low(1);
+    if (trampoline == MEMORY_FRAME_NULL) {
+        return -2;
+    }
+
+    bool has_failed = false;
+    int result = 0;
+
+    for (int i = 0; i < local_apic_number; ++i) {
+        if (local_apic_ids[i] == global_smp_data.cpus[0].local_apic_id) {
+            continue;
+        }
+        if (global_smp_data.cpu_number == CPU_MAX_NUMBER) {
+            break;
+        }
+
+        const uint32_t cpu_index = global_smp_data.cpu_number;
+        struct smp_cpu_data *const cpu = &global_smp_data.cpus[cpu_index];
+        cpu->local_apic_id = local_apic_ids[i];
+
+        if (stack_allocate(&cpu->stack, SMP_STACK_PAGE_NUMBER) != 0) {
+            result = -3;
+            break;
+        }
+
+        prepare_trampoline((address_t)trampoline, cpu_index);
+
+        /*
+         * A processor that misses the deadline may still start later, so its index, stack and
+         * startup code are never given to another one. Stop here instead.
+         */
+        if (!start_processor(cpu_index, (address_t)trampoline)) {
+            has_failed = true;
+            result = -3;
+            break;
+        }
+
+        ++global_smp_data.cpu_number;
+    }
+
+    // The startup code of a late processor may still run.
+    if (!has_failed) {
+        frame_allocator_free(trampoline, 1);
+    }
+
+    return result;
+}
+
+uint32_t smp_get_cpu_number(void)
+{
+    return global_smp_data.cpu_number;
+}
+
+uint32_t smp_get_local_apic_id(uint32_t cpu_index)
+{
+    return global_smp_data.cpus[cpu_index].local_apic_id;
+}
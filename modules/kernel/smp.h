@@ -0,0 +1,29 @@
+#ifndef _KERNEL_SMP_H
+#define _KERNEL_SMP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Start the application processors listed in the MADT.
+ *
+ * Processors are started one at a time with the INIT-SIPI-SIPI sequence and numbered from 1 in
+ * the order the MADT lists them. Each gets its own GDT, TSS, interrupt stacks and per-processor
+ * data, enables its local APIC and clock events, and runs its idle thread.
+ *
+ * Call this after `thread_initialize` and `acpi_initialize`.
+ *
+ * On failure, the processors started so far keep running, and at least the bootstrap processor
+ * does, so the kernel can go on with `smp_get_cpu_number` processors.
+ *
+ * @return 0 on success, -1 if the MADT is missing, -2 if memory for the startup code can't be
+ * allocated, -3 if an application processor failed to start.
+ */
+int smp_initialize(void);
+
+/** Return the number of processors running, including the bootstrap processor. */
+uint32_t smp_get_cpu_number(void);
+
+uint32_t smp_get_local_apic_id(uint32_t cpu_index);
+
+#endif
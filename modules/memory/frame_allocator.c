@@ -3,6 +3,7 @@
 #include <stdbool.h>
 #include <debug/assert.h>
 #include <general/address.h>
+#include <sync/mcs_lock.h>
 
 #include "frame_allocator.h"
 
@@ -21,6 +22,13 @@ struct frame_allocator_data {
     uint64_t bitmap_size;
     uint64_t total_frame_number;
     uint64_t free_frame_number;
+    /**
+     * Taken with interrupts disabled, as a thread switch frees the stack of a dead thread.
+     *
+     * Every processor creating threads comes here, so waiters queue on their own cache lines.
+     */
+    struct mcs_lock lock;
+    struct lock_statistics lock_statistics;
 };
 
 static struct frame_allocator_data global_frame_allocator_data;
@@ -118,6 +126,13 @@ int frame_allocator_initialize(struct uefi_memory_map_data memory_map_data)
         total_uefi_frame_number = MEMORY_FRAME_BITMAP_MAX_PAGE_NUMBER;
     }
 
+    mcs_lock_initialize(&global_frame_allocator_data.lock);
+    if (lock_statistics_register(&global_frame_allocator_data.lock_statistics,
+                "frame allocator") == 0) {
+        mcs_lock_set_statistics(&global_frame_allocator_data.lock,
+                &global_frame_allocator_data.lock_statistics);
+    }
+
     global_frame_allocator_data.bitmap_size = ((total_uefi_frame_number - 1) / 8) + 1;
 
     for (uint64_t i = 0; i < global_frame_allocator_data.bitmap_size; ++i) {
@@ -141,18 +156,25 @@ uint64_t frame_allocator_get_total_frame_number(void)
     return global_frame_allocator_data.total_frame_number;
 }
 
-frame_t frame_allcoator_request(uint64_t requested_size)
+static frame_t request_frames(uint64_t requested_size, uint64_t start_index, uint64_t end_index)
 {
+    struct mcs_lock_node node;
+    const uint64_t flags = mcs_lock_lock_save(&global_frame_allocator_data.lock, &node);
+
     if (global_frame_allocator_data.free_frame_number < requested_size) {
+        mcs_lock_unlock_restore(&global_frame_allocator_data.lock, &node, flags);
         return MEMORY_FRAME_NULL;
     }
 
+    if (end_index > global_frame_allocator_data.total_frame_number) {
+        end_index = global_frame_allocator_data.total_frame_number;
+    }
+
     frame_t allocated_frames = MEMORY_FRAME_NULL;
     uint8_t *const bitmap = global_frame_allocator_data.bitmap;
 
     uint64_t current_frame_size = 0;
-    for (uint64_t current_bit_index = 0;
-            current_bit_index < global_frame_allocator_data.total_frame_number;
+    for (uint64_t current_bit_index = start_index; current_bit_index < end_index;
             ++current_bit_index) {
         if (get_bit(bitmap, current_bit_index) == true) {
             current_frame_size = 0;
@@ -167,14 +189,30 @@ frame_t frame_allcoator_request(uint64_t requested_size)
         current_frame_size++;
     }
 
+    mcs_lock_unlock_restore(&global_frame_allocator_data.lock, &node, flags);
+
     return allocated_frames;
 }
 
+frame_t frame_allcoator_request(uint64_t requested_size)
+{
+    return request_frames(requested_size, MEMORY_FRAME_LOW_LIMIT / MEMORY_FRAME_SIZE,
+            global_frame_allocator_data.total_frame_number);
+}
+
+frame_t frame_allocator_request_low(uint64_t requested_size)
+{
+    return request_frames(requested_size, 0, MEMORY_FRAME_LOW_LIMIT / MEMORY_FRAME_SIZE);
+}
+
 void frame_allocator_free(frame_t frame, uint64_t size)
 {
     address_t frame_address = (address_t)frame;
     assert(frame_address % MEMORY_FRAME_SIZE == 0, "Not aligned page frame");
 
+    struct mcs_lock_node node;
+    const uint64_t flags = mcs_lock_lock_save(&global_frame_allocator_data.lock, &node);
+
     uint8_t *const bitmap = global_frame_allocator_data.bitmap;
     uint64_t frame_index = convert_address_to_index(frame_address);
     for (uint64_t i = 0; i < size; ++i) {
@@ -183,4 +221,6 @@ void frame_allocator_free(frame_t frame, uint64_t size)
 
     set_bits(bitmap, frame_index, size, false);
     global_frame_allocator_data.free_frame_number += size;
+
+    mcs_lock_unlock_restore(&global_frame_allocator_data.lock, &node, flags);
 }
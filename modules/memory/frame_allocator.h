@@ -7,6 +7,12 @@
 
 #define MEMORY_FRAME_NULL ((frame_t)(0xFFFFFFFFFFFFFFFF))
 
+/**
+ * Frames below this address are kept for code that runs in real mode, such as the startup code of
+ * application processors. `frame_allcoator_request` never returns them.
+ */
+#define MEMORY_FRAME_LOW_LIMIT (0x100000)
+
 typedef void *frame_t;
 
 int frame_allocator_initialize(struct uefi_memory_map_data memory_map_data);
@@ -20,6 +26,13 @@ uint64_t frame_allocator_get_total_frame_number(void);
  */
 frame_t frame_allcoator_request(uint64_t size);
 
+/**
+ * Return `size` numbers of continuous page frame below `MEMORY_FRAME_LOW_LIMIT`.
+ *
+ * @return On success, start address of the requested page frame. `MEMORY_FRAME_NULL` otherwise.
+ */
+frame_t frame_allocator_request_low(uint64_t size);
+
 void frame_allocator_free(frame_t frame, uint64_t size);
 
 #endif
@@ -139,6 +139,54 @@ int page_map(struct page_data *const page_data,
     return 0;
 }
 
+int page_unmap(struct page_data *const page_data, address_t virtual_page_address)
+{
+    assert(virtual_page_address % PAGE_SIZE == 0, "Not aligned virtual address");
+
+    uint64_t *const level4_table = page_data->level4_table;
+    uint64_t level4_table_offset = get_level4_table_offset(virtual_page_address);
+    if (page_not_present(level4_table, level4_table_offset)) {
+        return 1;
+    }
+
+    uint64_t *const level3_table = get_next_page_structure(level4_table[level4_table_offset]);
+    uint64_t level3_table_offset = get_level3_table_offset(virtual_page_address);
+    if (page_not_present(level3_table, level3_table_offset)) {
+        return 1;
+    }
+
+    uint64_t *const level2_table = get_next_page_structure(level3_table[level3_table_offset]);
+    uint64_t level2_table_offset = get_level2_table_offset(virtual_page_address);
+    if (page_not_present(level2_table, level2_table_offset)) {
+        return 1;
+    }
+
+    uint64_t *const level1_table = get_next_page_structure(level2_table[level2_table_offset]);
+    uint64_t level1_offset = get_level1_table_offset(virtual_page_address);
+    if (page_not_present(level1_table, level1_offset)) {
+        return 1;
+    }
+
+    level1_table[level1_offset] &= ~PAGE_STRUCTURE_ENTRY_PRESENT;
+
+    asm __volatile__("invlpg (%0)" : : "r"(virtual_page_address) : "memory");
+
+    return 0;
+}
+
+struct page_data page_get_loaded(void)
+{
+    address_t level4_table_address;
+
+    asm __volatile__("mov %%cr3, %0" : "=r"(level4_table_address));
+
+    struct page_data page_data = {
+        .level4_table = (uint64_t *)(level4_table_address & PAGE_STRUCTURE_ENTRY_BASE_ADDRESS)
+    };
+
+    return page_data;
+}
+
 void page_load(struct page_data page_data)
 {
     address_t level4_table_address = (address_t)page_data.level4_table;
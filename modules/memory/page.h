@@ -18,6 +18,16 @@ int page_initialize_kernel_map(struct page_data *const page_data);
 int page_map(struct page_data *const page_data,
         address_t virtual_address, address_t physical_address);
 
+/**
+ * Remove the mapping of `virtual_address` so any access to the page raises a page fault.
+ *
+ * @return 0 on success, 1 if the page is not mapped.
+ */
+int page_unmap(struct page_data *const page_data, address_t virtual_address);
+
+/** Return the page structure currently loaded in the CR3 register. */
+struct page_data page_get_loaded(void);
+
 void page_load(struct page_data page_data);
 
 #endif
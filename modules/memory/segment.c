@@ -1,8 +1,9 @@
 #include <stddef.h>
 #include <asm/memory/segment_load_table.h>
 #include <debug/assert.h>
+#include <cpu/local.h>
 #include <general/address.h>
-#include <memory/frame_allocator.h>
+#include <interrupts/stack.h>
 
 #include "global_descriptor_table.h"
 #include "task_state_segment.h"
@@ -17,22 +18,30 @@
 }
 
 /**
- * A static, constant global variable that represents the TSS.
+ * TSS of each processor.
  *
  * Base address of this structure should be aligned on an eight-byte boundary to yield the best
  * processor performance.
  */
 __attribute__((aligned(0x08)))
-static struct task_state_segment global_task_state_segment;
+static struct task_state_segment global_task_state_segments[CPU_MAX_NUMBER];
 
 /**
- * A static, constant global variable that represents the GDT.
+ * GDT of each processor, copied from `global_descriptor_table_template`.
  *
- * Base address of this structure should be aligned on an eight-byte boundary to yield the best
- * processor performance.
+ * Each processor needs its own GDT because the TSS descriptor points to its own TSS, and the busy
+ * flag `ltr` sets in the descriptor would make loading a shared one fail on other processors.
  */
 __attribute__((aligned(0x08)))
-static struct global_descriptor_table global_descriptor_table = {
+static struct global_descriptor_table global_descriptor_tables[CPU_MAX_NUMBER];
+
+/**
+ * A static, constant global variable that holds the segment descriptors of the GDT.
+ *
+ * The TSS descriptor is filled for each processor after the copy.
+ */
+__attribute__((aligned(0x08)))
+static const struct global_descriptor_table global_descriptor_table_template = {
     .null = application_segment_descriptor(0, 0, 0x00),
     /*
      * SEGMENT_ATTRIBUTE_G = 1          // Interpret the segment limit field in 4KB units.
@@ -85,39 +94,35 @@ static struct global_descriptor_table global_descriptor_table = {
     .user_data = application_segment_descriptor(0, 0, 0xCFF2)
 };
 
-static inline void initialize_task_state_segment(void)
+static inline void initialize_task_state_segment(uint32_t cpu_index,
+        struct task_state_segment *const task_state_segment)
 {
-    global_task_state_segment.reserved0 = 0;
-    global_task_state_segment.reserved1 = 0;
-    global_task_state_segment.reserved2 = 0;
-    global_task_state_segment.reserved3 = 0;
-    global_task_state_segment.reserved4 = 0;
-
-    global_task_state_segment.rsp[0] = 0x00;
-    global_task_state_segment.rsp[1] = 0x00;
-    global_task_state_segment.rsp[2] = 0x00;
-
-    const frame_t interrupt_stack = frame_allcoator_request(512);
-
-    global_task_state_segment.interrupt_stack_table[0] = (uint64_t)interrupt_stack;
-    global_task_state_segment.interrupt_stack_table[1] = (uint64_t)interrupt_stack;
-    global_task_state_segment.interrupt_stack_table[2] = (uint64_t)interrupt_stack;
-    global_task_state_segment.interrupt_stack_table[3] = (uint64_t)interrupt_stack;
-    global_task_state_segment.interrupt_stack_table[4] = (uint64_t)interrupt_stack;
-    global_task_state_segment.interrupt_stack_table[5] = (uint64_t)interrupt_stack;
-    global_task_state_segment.interrupt_stack_table[6] = (uint64_t)interrupt_stack;
+    task_state_segment->reserved0 = 0;
+    task_state_segment->reserved1 = 0;
+    task_state_segment->reserved2 = 0;
+    task_state_segment->reserved3 = 0;
+    task_state_segment->reserved4 = 0;
+
+    task_state_segment->rsp[0] = 0x00;
+    task_state_segment->rsp[1] = 0x00;
+    task_state_segment->rsp[2] = 0x00;
+
+    int result = interrupt_stack_initialize(cpu_index, task_state_segment);
+    assert(result == 0, "Failed to allocate interrupt stacks.");
 
     // This effectively disables the bitmap field of the TSS.
-    global_task_state_segment.io_bitmap_base = sizeof(global_task_state_segment) + 1;
+    task_state_segment->io_bitmap_base = sizeof(*task_state_segment) + 1;
 }
 
-static inline void register_task_state_segment(void)
+static inline void register_task_state_segment(
+        struct global_descriptor_table *const global_descriptor_table,
+        const struct task_state_segment *const task_state_segment)
 {
-    const address_t task_state_segment_address = (address_t)&global_task_state_segment;
+    const address_t task_state_segment_address = (address_t)task_state_segment;
 
-    global_descriptor_table.task_state.limit     = sizeof(global_task_state_segment);
-    global_descriptor_table.task_state.address0  = task_state_segment_address;
-    global_descriptor_table.task_state.address1  = (task_state_segment_address >> 16) & 0xFF;
+    global_descriptor_table->task_state.limit     = sizeof(*task_state_segment);
+    global_descriptor_table->task_state.address0  = task_state_segment_address;
+    global_descriptor_table->task_state.address1  = (task_state_segment_address >> 16) & 0xFF;
     /*
      * SEGMENT_ATTRIBUTE_G = 1          // Interpret the segment limit field in 4KB units.
      * SEGMENT_ATTRIBUTE_DB = 0         // This flag is not used in TSS descriptor.
@@ -129,10 +134,11 @@ static inline void register_task_state_segment(void)
      * SEGMENT_ATTRIBUTE_S = 0          // This is a system segment.
      * SEGMENT_ATTRIBUTE_TYPE = 0b1001  // This is 64-bit Availabe TSS.
      */
-    global_descriptor_table.task_state.attribute = 0x8089;
-    global_descriptor_table.task_state.address2  = (task_state_segment_address >> 24) & 0xFF;
-    global_descriptor_table.task_state.address3  = (task_state_segment_address >> 32) & 0xFFFFFFFF;
-    global_descriptor_table.task_state.reserved  = 0;
+    global_descriptor_table->task_state.attribute = 0x8089;
+    global_descriptor_table->task_state.address2  = (task_state_segment_address >> 24) & 0xFF;
+    global_descriptor_table->task_state.address3  =
+        (task_state_segment_address >> 32) & 0xFFFFFFFF;
+    global_descriptor_table->task_state.reserved  = 0;
 }
 
 void segment_initialize(void)
@@ -142,12 +148,19 @@ void segment_initialize(void)
     assert(sizeof(struct application_segment_descriptor) == 8, "Segment Descriptor is not packed");
     assert(sizeof(struct task_state_segment) % 8 == 0, "TSS is not packed");
 
-    initialize_task_state_segment();
-    register_task_state_segment();
+    const uint32_t cpu_index = cpu_local_index();
+    struct global_descriptor_table *const global_descriptor_table =
+        &global_descriptor_tables[cpu_index];
+    struct task_state_segment *const task_state_segment = &global_task_state_segments[cpu_index];
+
+    *global_descriptor_table = global_descriptor_table_template;
+
+    initialize_task_state_segment(cpu_index, task_state_segment);
+    register_task_state_segment(global_descriptor_table, task_state_segment);
 
     const struct global_descriptor_table_register_entry register_entry = {
-        .table_limit = sizeof(global_descriptor_table) - 1,
-        .table_address = (uint64_t)&global_descriptor_table
+        .table_limit = sizeof(*global_descriptor_table) - 1,
+        .table_address = (uint64_t)global_descriptor_table
     };
 
     segment_load_table(&register_entry);
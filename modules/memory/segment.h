@@ -1,6 +1,12 @@
 #ifndef MEMORY_SEGMENT_INITIALIZE_H
 #define MEMORY_SEGMENT_INITIALIZE_H
 
+/**
+ * Load the GDT and the TSS of the current processor.
+ *
+ * Each processor gets its own copy of the GDT, its own TSS and its own interrupt stacks. Call this
+ * after `cpu_local_initialize`.
+ */
 void segment_initialize(void);
 
 #endif
@@ -0,0 +1,33 @@
+#include "frame_allocator.h"
+#include "page.h"
+#include "stack.h"
+
+int stack_allocate(struct stack *const stack, uint64_t page_number)
+{
+    const frame_t frame = frame_allcoator_request(page_number + 1);
+    if (frame == MEMORY_FRAME_NULL) {
+        return -1;
+    }
+
+    // The kernel maps memory identically, so the frame address is also the virtual address.
+    struct page_data page_data = page_get_loaded();
+    if (page_unmap(&page_data, (address_t)frame) != 0) {
+        frame_allocator_free(frame, page_number + 1);
+        return -2;
+    }
+
+    stack->guard_address = (address_t)frame;
+    stack->bottom_address = stack->guard_address + PAGE_SIZE;
+    stack->top_address = stack->bottom_address + page_number * PAGE_SIZE;
+
+    return 0;
+}
+
+void stack_free(struct stack *const stack)
+{
+    struct page_data page_data = page_get_loaded();
+    page_map(&page_data, stack->guard_address, stack->guard_address);
+
+    const uint64_t frame_number = (stack->top_address - stack->guard_address) / PAGE_SIZE;
+    frame_allocator_free((frame_t)stack->guard_address, frame_number);
+}
@@ -0,0 +1,33 @@
+#ifndef _MEMORY_STACK_H
+#define _MEMORY_STACK_H
+
+#include <stdint.h>
+#include <general/address.h>
+
+/**
+ * A stack guarded by an unmapped page below it.
+ *
+ * Overflowing the stack touches the guard page and raises a page fault instead of silently
+ * corrupting memory below the stack.
+ */
+struct stack {
+    /** The unmapped guard page. */
+    address_t guard_address;
+    /** The lowest usable address. */
+    address_t bottom_address;
+    /** Initial stack pointer. The stack grows down from here. */
+    address_t top_address;
+};
+
+/**
+ * Allocate a stack of `page_number` usable pages and a guard page.
+ *
+ * The stack is unmapped from the page structure currently loaded.
+ *
+ * @return 0 on success, -1 if frames are not available, -2 if the guard page can't be unmapped.
+ */
+int stack_allocate(struct stack *const stack, uint64_t page_number);
+
+void stack_free(struct stack *const stack);
+
+#endif
@@ -0,0 +1,111 @@
+#include <cpu/timestamp_counter.h>
+
+#include "lock_statistics.h"
+#include "spinlock.h"
+
+struct lock_statistics_data {
+    struct lock_statistics *statistics[LOCK_STATISTICS_MAX_NUMBER];
+    uint64_t statistics_number;
+    /** Protects the list. It has no statistics itself. */
+    struct spinlock lock;
+};
+
+static struct lock_statistics_data global_lock_statistics_data;
+
+static void clear(struct lock_statistics *const statistics)
+{
+    statistics->acquisition_number = 0;
+    statistics->contention_number = 0;
+    statistics->wait_cycles = 0;
+    statistics->acquire_time = 0;
+    histogram_initialize(&statistics->hold_cycles);
+}
+
+void lock_statistics_initialize(void)
+{
+    global_lock_statistics_data.statistics_number = 0;
+    spinlock_initialize(&global_lock_statistics_data.lock);
+}
+
+int lock_statistics_register(struct lock_statistics *const statistics, const char *const name)
+{
+    int result = 0;
+
+    clear(statistics);
+
+    uint64_t length = 0;
+    while (name[length] != '\0' && length < LOCK_STATISTICS_NAME_SIZE - 1) {
+        statistics->name[length] = name[length];
+        ++length;
+    }
+    statistics->name[length] = '\0';
+
+    const uint64_t flags = spinlock_lock_save(&global_lock_statistics_data.lock);
+
+    if (global_lock_statistics_data.statistics_number >= LOCK_STATISTICS_MAX_NUMBER) {
+        result = -1;
+    } else {
+        global_lock_statistics_data.statistics[global_lock_statistics_data.statistics_number++]
+            = statistics;
+    }
+
+    spinlock_unlock_restore(&global_lock_statistics_data.lock, flags);
+
+    return result;
+}
+
+void lock_statistics_reset(void)
+{
+    const uint64_t flags = spinlock_lock_save(&global_lock_statistics_data.lock);
+
+    for (uint64_t i = 0; i < global_lock_statistics_data.statistics_number; ++i) {
+        clear(global_lock_statistics_data.statistics[i]);
+    }
+
+    spinlock_unlock_restore(&global_lock_statistics_data.lock, flags);
+}
+
+void lock_statistics_print(string_print_t print)
+{
+    // Registration only ever appends, so the list can be walked without the lock.
+    const uint64_t statistics_number =
+        __atomic_load_n(&global_lock_statistics_data.statistics_number, __ATOMIC_ACQUIRE);
+
+    for (uint64_t i = 0; i < statistics_number; ++i) {
+        const struct lock_statistics *const statistics = global_lock_statistics_data.statistics[i];
+
+        if (statistics->acquisition_number == 0) {
+            continue;
+        }
+
+        print("%s: %lu acquisitions, %lu contended, %lu cycles waited on average\n",
+                statistics->name, statistics->acquisition_number, statistics->contention_number,
+                statistics->contention_number == 0
+                    ? 0 : statistics->wait_cycles / statistics->contention_number);
+        histogram_print(print, "hold (cycles)", &statistics->hold_cycles);
+    }
+}
+
+void lock_statistics_record_acquire(struct lock_statistics *const statistics, bool is_contended,
+        uint64_t wait_start, bool is_shared)
+{
+    const uint64_t now = timestamp_counter_read();
+
+    // Shared holders count at the same time, so the counters are updated atomically.
+    __atomic_add_fetch(&statistics->acquisition_number, 1, __ATOMIC_RELAXED);
+
+    if (is_contended) {
+        __atomic_add_fetch(&statistics->contention_number, 1, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&statistics->wait_cycles, now - wait_start, __ATOMIC_RELAXED);
+    }
+
+    if (!is_shared) {
+        statistics->acquire_time = now;
+    }
+}
+
+void lock_statistics_record_release(struct lock_statistics *const statistics)
+{
+    histogram_record(&statistics->hold_cycles,
+            timestamp_counter_read() - statistics->acquire_time);
+}
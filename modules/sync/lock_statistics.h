@@ -0,0 +1,74 @@
+#ifndef _SYNC_LOCK_STATISTICS_H
+#define _SYNC_LOCK_STATISTICS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <general/histogram.h>
+#include <general/string.h>
+
+#define LOCK_STATISTICS_MAX_NUMBER (64)
+#define LOCK_STATISTICS_NAME_SIZE  (24)
+
+/**
+ * Counters of a single lock, to find the locks processors fight over.
+ *
+ * A lock records into its statistics only if they are attached to it, so locks without them pay
+ * a single comparison. Times are in cycles of the time-stamp counter.
+ */
+struct lock_statistics {
+    char name[LOCK_STATISTICS_NAME_SIZE];
+    uint64_t acquisition_number;
+    /** Acquisitions that found the lock taken and had to wait. */
+    uint64_t contention_number;
+    uint64_t wait_cycles;
+    /** When the exclusive holder took the lock. Only the holder writes it. */
+    uint64_t acquire_time;
+    /** How long exclusive holders kept the lock, recorded by the holder. */
+    struct histogram hold_cycles;
+};
+
+void lock_statistics_initialize(void);
+
+/**
+ * Clear `statistics`, name it and list it in `lock_statistics_print`.
+ *
+ * @return 0 on success, -1 if too many statistics are registered.
+ */
+int lock_statistics_register(struct lock_statistics *const statistics, const char *const name);
+
+/** Clear every registered statistics. Locks taken meanwhile may be counted partially. */
+void lock_statistics_reset(void);
+
+/** Print the statistics of registered locks that were taken at least once. */
+void lock_statistics_print(string_print_t print);
+
+/**
+ * Record an acquisition. Call it right after the lock is taken.
+ *
+ * @param wait_start The time-stamp counter value when waiting started, if `is_contended`.
+ * @param is_shared Whether other holders may have the lock at the same time, like readers. No
+ * hold time is recorded for them.
+ */
+void lock_statistics_record_acquire(struct lock_statistics *const statistics, bool is_contended,
+        uint64_t wait_start, bool is_shared);
+
+/** Record the hold time of an exclusive holder. Call it right before the lock is released. */
+void lock_statistics_record_release(struct lock_statistics *const statistics);
+
+static inline void lock_statistics_acquire(struct lock_statistics *const statistics,
+        bool is_contended, uint64_t wait_start, bool is_shared)
+{
+    if (statistics != NULL) {
+        lock_statistics_record_acquire(statistics, is_contended, wait_start, is_shared);
+    }
+}
+
+static inline void lock_statistics_release(struct lock_statistics *const statistics)
+{
+    if (statistics != NULL) {
+        lock_statistics_record_release(statistics);
+    }
+}
+
+#endif
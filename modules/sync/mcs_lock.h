@@ -0,0 +1,136 @@
+#ifndef _SYNC_MCS_LOCK_H
+#define _SYNC_MCS_LOCK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <cpu/timestamp_counter.h>
+#include <interrupts/control_register.h>
+
+#include "lock_statistics.h"
+
+/**
+ * A place in the queue of an MCS lock.
+ *
+ * Each waiter brings its own node, usually on its stack, and spins on it. Pass the same node to
+ * the lock and unlock functions.
+ */
+struct mcs_lock_node {
+    struct mcs_lock_node *next;
+    bool is_waiting;
+};
+
+/**
+ * A queue lock of Mellor-Crummey and Scott.
+ *
+ * Waiters form a linked list and each one spins on its own node, so handing the lock over only
+ * touches the cache line of the next waiter. It's fair like `struct spinlock` and scales better
+ * when many processors wait, at the cost of an atomic exchange on release when nobody waits.
+ *
+ * The same rules as for `struct spinlock` apply to interrupts and context switches.
+ */
+struct mcs_lock {
+    /** The last waiter, or the holder if nobody waits. NULL if the lock is free. */
+    struct mcs_lock_node *tail;
+    /** NULL unless set by `mcs_lock_set_statistics`. */
+    struct lock_statistics *statistics;
+};
+
+static inline void mcs_lock_initialize(struct mcs_lock *const lock)
+{
+    lock->tail = NULL;
+    lock->statistics = NULL;
+}
+
+/** Record the use of the lock in `statistics`. Set it before the lock is used. */
+static inline void mcs_lock_set_statistics(struct mcs_lock *const lock,
+        struct lock_statistics *const statistics)
+{
+    lock->statistics = statistics;
+}
+
+static inline bool mcs_lock_try_lock(struct mcs_lock *const lock, struct mcs_lock_node *const node)
+{
+    struct mcs_lock_node *expected = NULL;
+
+    node->next = NULL;
+    node->is_waiting = false;
+
+    if (!__atomic_compare_exchange_n(&lock->tail, &expected, node, false, __ATOMIC_ACQUIRE,
+                __ATOMIC_RELAXED)) {
+        return false;
+    }
+
+    lock_statistics_acquire(lock->statistics, false, 0, false);
+
+    return true;
+}
+
+static inline void mcs_lock_lock(struct mcs_lock *const lock, struct mcs_lock_node *const node)
+{
+    node->next = NULL;
+    node->is_waiting = true;
+
+    struct mcs_lock_node *const previous = __atomic_exchange_n(&lock->tail, node, __ATOMIC_ACQ_REL);
+    if (previous == NULL) {
+        lock_statistics_acquire(lock->statistics, false, 0, false);
+        return;
+    }
+
+    const uint64_t wait_start = timestamp_counter_read();
+
+    // The previous holder clears `is_waiting` once it finds the node linked behind its own.
+    __atomic_store_n(&previous->next, node, __ATOMIC_RELEASE);
+
+    while (__atomic_load_n(&node->is_waiting, __ATOMIC_ACQUIRE)) {
+        asm __volatile__("pause");
+    }
+
+    lock_statistics_acquire(lock->statistics, true, wait_start, false);
+}
+
+static inline void mcs_lock_unlock(struct mcs_lock *const lock, struct mcs_lock_node *const node)
+{
+    lock_statistics_release(lock->statistics);
+
+    struct mcs_lock_node *next = __atomic_load_n(&node->next, __ATOMIC_ACQUIRE);
+
+    if (next == NULL) {
+        struct mcs_lock_node *expected = node;
+
+        if (__atomic_compare_exchange_n(&lock->tail, &expected, NULL, false, __ATOMIC_RELEASE,
+                    __ATOMIC_RELAXED)) {
+            return;
+        }
+
+        // A waiter swapped itself in as the tail but hasn't linked its node yet.
+        while ((next = __atomic_load_n(&node->next, __ATOMIC_ACQUIRE)) == NULL) {
+            asm __volatile__("pause");
+        }
+    }
+
+    __atomic_store_n(&next->is_waiting, false, __ATOMIC_RELEASE);
+}
+
+/**
+ * Disable interrupts and take the lock.
+ *
+ * @return The flags to pass to `mcs_lock_unlock_restore`.
+ */
+static inline uint64_t mcs_lock_lock_save(struct mcs_lock *const lock,
+        struct mcs_lock_node *const node)
+{
+    const uint64_t flags = interrupts_save_and_disable();
+    mcs_lock_lock(lock, node);
+
+    return flags;
+}
+
+static inline void mcs_lock_unlock_restore(struct mcs_lock *const lock,
+        struct mcs_lock_node *const node, uint64_t flags)
+{
+    mcs_lock_unlock(lock, node);
+    interrupts_restore(flags);
+}
+
+#endif
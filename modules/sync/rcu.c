@@ -0,0 +1,361 @@
+#include <stddef.h>
+#include <general/address.h>
+#include <interrupts/control_register.h>
+#include <interrupts/deferred_work.h>
+#include <task/thread.h>
+#include <time/clock.h>
+#include <time/timer.h>
+
+#include "rcu.h"
+#include "spinlock.h"
+
+/** How often a processor with callbacks checks whether their grace period is over. */
+#define RCU_CHECK_PERIOD (1 * CLOCK_NANOSECONDS_PER_MILLISECOND)
+
+struct rcu_callback_list {
+    struct rcu_head *first;
+    struct rcu_head **last_next;
+};
+
+/**
+ * Callbacks move from `next` to `waiting` when the processor asks for a grace period, and from
+ * `waiting` to `done` when it is over.
+ */
+struct rcu_cpu_data {
+    /** The last grace period the processor went through a quiescent state in. */
+    uint64_t quiescent_period;
+    /**
+     * Set while the processor sleeps in the idle loop, where it reads nothing and notes no
+     * quiescent state as no tick wakes it up. Grace periods don't wait for it then.
+     */
+    bool is_idle;
+    bool is_online;
+    struct rcu_callback_list next;
+    struct rcu_callback_list waiting;
+    /** The grace period `waiting` is for. */
+    uint64_t waiting_period;
+    struct rcu_callback_list done;
+    bool is_work_queued;
+    struct timer timer;
+    uint64_t batch_number;
+    uint64_t invoked_number;
+} __attribute__((aligned(64)));
+
+struct rcu_data {
+    /** The last grace period started. It ends when every processor has gone past it. */
+    uint64_t current_period;
+    /** The last grace period over. */
+    uint64_t completed_period;
+    /** The last grace period some processor waits for. */
+    uint64_t requested_period;
+    /** Serializes starting and ending grace periods. Readers never take it. */
+    struct spinlock lock;
+    struct rcu_cpu_data cpus[CPU_MAX_NUMBER];
+};
+
+static struct rcu_data global_rcu_data;
+
+static inline void initialize_list(struct rcu_callback_list *const list)
+{
+    list->first = NULL;
+    list->last_next = &list->first;
+}
+
+static inline bool is_list_empty(const struct rcu_callback_list *const list)
+{
+    return list->first == NULL;
+}
+
+/** Move every callback of `source` to the end of `destination`. */
+static inline void splice_list(struct rcu_callback_list *const destination,
+        struct rcu_callback_list *const source)
+{
+    if (is_list_empty(source)) {
+        return;
+    }
+
+    *destination->last_next = source->first;
+    destination->last_next = source->last_next;
+    initialize_list(source);
+}
+
+static uint32_t get_online_number(void)
+{
+    uint32_t online_number = 0;
+
+    for (uint32_t i = 0; i < CPU_MAX_NUMBER; ++i) {
+        if (__atomic_load_n(&global_rcu_data.cpus[i].is_online, __ATOMIC_ACQUIRE)) {
+            ++online_number;
+        }
+    }
+
+    return online_number;
+}
+
+/**
+ * End the current grace period if every processor went past it, and start the next one if it is
+ * asked for. Called with the lock held.
+ */
+static void advance_grace_period(void)
+{
+    struct rcu_data *const data = &global_rcu_data;
+
+    if (data->completed_period < data->current_period) {
+        for (uint32_t i = 0; i < CPU_MAX_NUMBER; ++i) {
+            const struct rcu_cpu_data *const cpu = &data->cpus[i];
+
+            /*
+             * The period was started with a sequentially consistent store, so a processor seen
+             * idle here reads after the store once it wakes up and can't see removed data.
+             */
+            if (__atomic_load_n(&cpu->is_online, __ATOMIC_ACQUIRE)
+                    && !__atomic_load_n(&cpu->is_idle, __ATOMIC_SEQ_CST)
+                    && __atomic_load_n(&cpu->quiescent_period, __ATOMIC_ACQUIRE)
+                        < data->current_period) {
+                return;
+            }
+        }
+
+        __atomic_store_n(&data->completed_period, data->current_period, __ATOMIC_RELEASE);
+    }
+
+    if (data->requested_period > data->current_period) {
+        // Removals before the request are visible to whoever sees the new period.
+        __atomic_store_n(&data->current_period, data->current_period + 1, __ATOMIC_SEQ_CST);
+    }
+}
+
+/**
+ * Ask for a grace period that starts after the call.
+ *
+ * A grace period already running may have started before a reader the caller worries about, so
+ * the next one is asked for. Called with the lock held.
+ */
+static uint64_t request_grace_period(void)
+{
+    struct rcu_data *const data = &global_rcu_data;
+    const uint64_t period = data->current_period + 1;
+
+    if (data->requested_period < period) {
+        data->requested_period = period;
+    }
+
+    advance_grace_period();
+
+    return period;
+}
+
+static void run_callbacks(uint64_t data)
+{
+    struct rcu_cpu_data *const cpu = &global_rcu_data.cpus[data];
+
+    const uint64_t flags = interrupts_save_and_disable();
+
+    struct rcu_head *head = cpu->done.first;
+    initialize_list(&cpu->done);
+    cpu->is_work_queued = false;
+
+    interrupts_restore(flags);
+
+    while (head != NULL) {
+        struct rcu_head *const next = head->next;
+
+        head->callback(head);
+        ++cpu->invoked_number;
+
+        head = next;
+    }
+}
+
+/** Move the callbacks of the processor along. Runs in the interrupt context. */
+static void handle_timer(uint64_t data)
+{
+    struct rcu_cpu_data *const cpu = &global_rcu_data.cpus[data];
+
+    spinlock_lock(&global_rcu_data.lock);
+
+    advance_grace_period();
+
+    if (!is_list_empty(&cpu->waiting)
+            && global_rcu_data.completed_period >= cpu->waiting_period) {
+        splice_list(&cpu->done, &cpu->waiting);
+    }
+
+    if (is_list_empty(&cpu->waiting) && !is_list_empty(&cpu->next)) {
+        splice_list(&cpu->waiting, &cpu->next);
+        cpu->waiting_period = request_grace_period();
+        ++cpu->batch_number;
+    }
+
+    spinlock_unlock(&global_rcu_data.lock);
+
+    if (!is_list_empty(&cpu->done) && !cpu->is_work_queued) {
+        cpu->is_work_queued = deferred_work_queue(run_callbacks, data) == 0;
+    }
+
+    // A full deferred work queue leaves `done` for the next check.
+    if (!is_list_empty(&cpu->next) || !is_list_empty(&cpu->waiting)
+            || (!is_list_empty(&cpu->done) && !cpu->is_work_queued)) {
+        timer_add(&cpu->timer, clock_get_nanoseconds() + RCU_CHECK_PERIOD);
+    }
+}
+
+void rcu_initialize(void)
+{
+    global_rcu_data.current_period = 0;
+    global_rcu_data.completed_period = 0;
+    global_rcu_data.requested_period = 0;
+    spinlock_initialize(&global_rcu_data.lock);
+
+    for (uint64_t i = 0; i < CPU_MAX_NUMBER; ++i) {
+        struct rcu_cpu_data *const cpu = &global_rcu_data.cpus[i];
+
+        cpu->quiescent_period = 0;
+        cpu->is_idle = false;
+        cpu->is_online = false;
+        initialize_list(&cpu->next);
+        initialize_list(&cpu->waiting);
+        cpu->waiting_period = 0;
+        initialize_list(&cpu->done);
+        cpu->is_work_queued = false;
+        timer_setup(&cpu->timer, handle_timer, i);
+        cpu->batch_number = 0;
+        cpu->invoked_number = 0;
+    }
+}
+
+void rcu_add_cpu(void)
+{
+    struct rcu_cpu_data *const cpu = &global_rcu_data.cpus[cpu_local_index()];
+
+    // The processor has read nothing yet, so it is past every grace period started so far.
+    cpu->quiescent_period = __atomic_load_n(&global_rcu_data.current_period, __ATOMIC_ACQUIRE);
+    __atomic_store_n(&cpu->is_online, true, __ATOMIC_RELEASE);
+}
+
+void rcu_note_quiescent_state(void)
+{
+    struct rcu_cpu_data *const cpu = &global_rcu_data.cpus[cpu_local_index()];
+    const uint64_t period = __atomic_load_n(&global_rcu_data.current_period, __ATOMIC_ACQUIRE);
+
+    // Only write when a grace period waits for it, so the cache line stays shared otherwise.
+    if (cpu->quiescent_period != period) {
+        __atomic_store_n(&cpu->quiescent_period, period, __ATOMIC_RELEASE);
+    }
+}
+
+void rcu_enter_idle(void)
+{
+    struct rcu_cpu_data *const cpu = &global_rcu_data.cpus[cpu_local_index()];
+
+    rcu_note_quiescent_state();
+    __atomic_store_n(&cpu->is_idle, true, __ATOMIC_SEQ_CST);
+}
+
+void rcu_exit_idle(void)
+{
+    struct rcu_cpu_data *const cpu = &global_rcu_data.cpus[cpu_local_index()];
+
+    // The store is a full barrier, so reads after it can't be reordered before it.
+    if (cpu->is_idle) {
+        __atomic_store_n(&cpu->is_idle, false, __ATOMIC_SEQ_CST);
+    }
+}
+
+void rcu_call(struct rcu_head *const head, rcu_callback_t callback)
+{
+    head->next = NULL;
+    head->callback = callback;
+
+    const uint64_t flags = interrupts_save_and_disable();
+
+    struct rcu_cpu_data *const cpu = &global_rcu_data.cpus[cpu_local_index()];
+
+    *cpu->next.last_next = head;
+    cpu->next.last_next = &head->next;
+
+    if (!cpu->timer.is_pending) {
+        timer_add(&cpu->timer, clock_get_nanoseconds() + RCU_CHECK_PERIOD);
+    }
+
+    interrupts_restore(flags);
+}
+
+struct rcu_waiter {
+    struct rcu_head head;
+    struct thread *thread;
+    bool is_done;
+};
+
+static void wake_waiter(struct rcu_head *const head)
+{
+    struct rcu_waiter *const waiter = container_of(head, struct rcu_waiter, head);
+    // The waiter is on the stack of a thread that may return as soon as it sees `is_done`.
+    struct thread *const thread = waiter->thread;
+
+    __atomic_store_n(&waiter->is_done, true, __ATOMIC_RELEASE);
+    thread_wakeup(thread);
+}
+
+void rcu_synchronize(void)
+{
+    // Readers on a single processor are interrupt handlers that are done by now.
+    if (get_online_number() <= 1) {
+        return;
+    }
+
+    struct rcu_waiter waiter = { .thread = thread_get_current(), .is_done = false };
+
+    rcu_call(&waiter.head, wake_waiter);
+
+    const uint64_t flags = interrupts_save_and_disable();
+    while (!__atomic_load_n(&waiter.is_done, __ATOMIC_ACQUIRE)) {
+        thread_block();
+    }
+    interrupts_restore(flags);
+}
+
+uint64_t rcu_get_state(void)
+{
+    if (get_online_number() <= 1) {
+        return __atomic_load_n(&global_rcu_data.completed_period, __ATOMIC_ACQUIRE);
+    }
+
+    const uint64_t flags = spinlock_lock_save(&global_rcu_data.lock);
+    const uint64_t state = request_grace_period();
+    spinlock_unlock_restore(&global_rcu_data.lock, flags);
+
+    return state;
+}
+
+bool rcu_is_state_completed(uint64_t state)
+{
+    if (__atomic_load_n(&global_rcu_data.completed_period, __ATOMIC_ACQUIRE) >= state) {
+        return true;
+    }
+
+    const uint64_t flags = spinlock_lock_save(&global_rcu_data.lock);
+    advance_grace_period();
+    spinlock_unlock_restore(&global_rcu_data.lock, flags);
+
+    return __atomic_load_n(&global_rcu_data.completed_period, __ATOMIC_ACQUIRE) >= state;
+}
+
+void rcu_print(string_print_t print)
+{
+    print("Grace periods: %lu completed, %lu started\n",
+            __atomic_load_n(&global_rcu_data.completed_period, __ATOMIC_ACQUIRE),
+            __atomic_load_n(&global_rcu_data.current_period, __ATOMIC_ACQUIRE));
+
+    for (uint32_t i = 0; i < CPU_MAX_NUMBER; ++i) {
+        const struct rcu_cpu_data *const cpu = &global_rcu_data.cpus[i];
+
+        if (!__atomic_load_n(&cpu->is_online, __ATOMIC_ACQUIRE)) {
+            continue;
+        }
+
+        print("CPU %u: quiescent in %lu%s, %lu batches, %lu callbacks invoked\n", i,
+                cpu->quiescent_period, cpu->is_idle ? " (idle)" : "", cpu->batch_number,
+                cpu->invoked_number);
+    }
+}
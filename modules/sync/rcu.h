@@ -0,0 +1,131 @@
+#ifndef _SYNC_RCU_H
+#define _SYNC_RCU_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <cpu/local.h>
+#include <general/string.h>
+
+/**
+ * Read-copy-update based on quiescent states.
+ *
+ * Readers find shared data through a pointer read with `rcu_dereference`. Writers never change
+ * what readers may see: they publish a new version with `rcu_assign_pointer` and free the old one
+ * once a grace period has passed, that is, once every processor has gone through a quiescent
+ * state, a point where it can't be in the middle of a read.
+ *
+ * Quiescent states are noted by the thread code on every context switch and every time an
+ * interrupt returns to a thread that may be preempted, which includes the idle thread. Readers
+ * therefore only have to stay on the processor, which they do by not blocking and by making the
+ * interrupt exit skip preemption. Entering and leaving a read-side critical section only changes
+ * a counter of the current processor and costs no atomic operation, barrier or shared write.
+ *
+ * An idle processor may sleep with no tick for as long as nothing happens on it, so sleeping is
+ * an extended quiescent state: grace periods don't wait for a processor between
+ * `rcu_enter_idle` and `rcu_exit_idle`. Every interrupt leaves it before any handler runs.
+ *
+ * Interrupt handlers and deferred work are never preempted, so they may read without
+ * `rcu_read_lock`, although taking it documents the intent.
+ */
+
+#define rcu_dereference(Pointer) __atomic_load_n(&(Pointer), __ATOMIC_CONSUME)
+
+/** Publish `Value` after everything it points to has been written. */
+#define rcu_assign_pointer(Pointer, Value) __atomic_store_n(&(Pointer), (Value), __ATOMIC_RELEASE)
+
+struct rcu_head;
+
+/**
+ * A function called after a grace period.
+ *
+ * It runs as deferred work with interrupts enabled on the processor that queued it, so it must
+ * not block.
+ */
+typedef void (*rcu_callback_t)(struct rcu_head *const head);
+
+/** Embedded in the data to free, which is found back with `container_of`. */
+struct rcu_head {
+    struct rcu_head *next;
+    rcu_callback_t callback;
+};
+
+/**
+ * Set up the grace period state.
+ *
+ * Call this before anything is registered on interrupt vectors. Callbacks can be queued once
+ * timers are running.
+ */
+void rcu_initialize(void);
+
+/** Start tracking the current processor. Call this once it can be interrupted by timers. */
+void rcu_add_cpu(void);
+
+/**
+ * Note that the current processor is not reading.
+ *
+ * Called by the thread code with interrupts disabled. Outside of it, only code that knows it is
+ * not inside a read-side critical section may call this.
+ */
+void rcu_note_quiescent_state(void);
+
+/**
+ * Note that the current processor goes to sleep and reads nothing until `rcu_exit_idle`.
+ *
+ * Called by the idle loop with interrupts disabled, outside of read-side critical sections.
+ */
+void rcu_enter_idle(void);
+
+/** Note that the current processor may read again. Called with interrupts disabled. */
+void rcu_exit_idle(void);
+
+/**
+ * Call `callback` with `head` once every reader that may see the data is done.
+ *
+ * Callbacks queued on a processor are handed to the same grace period together and invoked in a
+ * single batch.
+ */
+void rcu_call(struct rcu_head *const head, rcu_callback_t callback);
+
+/**
+ * Block until every reader that started before the call is done.
+ *
+ * Call this from a thread outside of read-side critical sections.
+ */
+void rcu_synchronize(void);
+
+/**
+ * Return a state that `rcu_is_state_completed` tells the end of, for readers that started
+ * before this call.
+ */
+uint64_t rcu_get_state(void);
+
+bool rcu_is_state_completed(uint64_t state);
+
+void rcu_print(string_print_t print);
+
+static inline void rcu_read_lock(void)
+{
+    asm __volatile__("incl %%gs:%c0"
+            : : "i"(offsetof(struct cpu_local_data, rcu_read_depth)) : "memory");
+}
+
+static inline void rcu_read_unlock(void)
+{
+    asm __volatile__("decl %%gs:%c0"
+            : : "i"(offsetof(struct cpu_local_data, rcu_read_depth)) : "memory");
+}
+
+/** Return whether the current processor is inside a read-side critical section. */
+static inline bool rcu_is_reading(void)
+{
+    uint32_t depth;
+
+    asm __volatile__("movl %%gs:%c1, %0"
+            : "=r"(depth)
+            : "i"(offsetof(struct cpu_local_data, rcu_read_depth)));
+
+    return depth != 0;
+}
+
+#endif
@@ -0,0 +1,158 @@
+#ifndef _SYNC_RWLOCK_H
+#define _SYNC_RWLOCK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <cpu/timestamp_counter.h>
+#include <interrupts/control_register.h>
+
+#include "lock_statistics.h"
+
+/** Set while a writer holds the lock. */
+#define RWLOCK_WRITER         (1U << 31)
+/** Set while a writer waits. New readers wait too, so writers don't starve. */
+#define RWLOCK_WRITER_WAITING (1U << 30)
+/** The lower bits count the readers holding the lock. */
+#define RWLOCK_READER_MASK    (RWLOCK_WRITER_WAITING - 1)
+
+/**
+ * A lock that any number of readers or a single writer may hold.
+ *
+ * Writers are preferred: once a writer waits, new readers wait until it's done. Hold times are
+ * only recorded for writers.
+ *
+ * The same rules as for `struct spinlock` apply to interrupts and context switches.
+ */
+struct rwlock {
+    uint32_t state;
+    /** NULL unless set by `rwlock_set_statistics`. */
+    struct lock_statistics *statistics;
+};
+
+static inline void rwlock_initialize(struct rwlock *const lock)
+{
+    lock->state = 0;
+    lock->statistics = NULL;
+}
+
+/** Record the use of the lock in `statistics`. Set it before the lock is used. */
+static inline void rwlock_set_statistics(struct rwlock *const lock,
+        struct lock_statistics *const statistics)
+{
+    lock->statistics = statistics;
+}
+
+static inline bool rwlock_try_read_lock(struct rwlock *const lock)
+{
+    uint32_t state = __atomic_load_n(&lock->state, __ATOMIC_RELAXED);
+
+    if (state & (RWLOCK_WRITER | RWLOCK_WRITER_WAITING)) {
+        return false;
+    }
+
+    return __atomic_compare_exchange_n(&lock->state, &state, state + 1, false, __ATOMIC_ACQUIRE,
+            __ATOMIC_RELAXED);
+}
+
+static inline void rwlock_read_lock(struct rwlock *const lock)
+{
+    if (rwlock_try_read_lock(lock)) {
+        lock_statistics_acquire(lock->statistics, false, 0, true);
+        return;
+    }
+
+    const uint64_t wait_start = timestamp_counter_read();
+
+    while (!rwlock_try_read_lock(lock)) {
+        asm __volatile__("pause");
+    }
+
+    lock_statistics_acquire(lock->statistics, true, wait_start, true);
+}
+
+static inline void rwlock_read_unlock(struct rwlock *const lock)
+{
+    __atomic_fetch_sub(&lock->state, 1, __ATOMIC_RELEASE);
+}
+
+static inline bool rwlock_try_write_lock(struct rwlock *const lock)
+{
+    uint32_t state = __atomic_load_n(&lock->state, __ATOMIC_RELAXED);
+
+    // Any waiting flag is taken over, as the writer that set it is this one or will set it again.
+    if (state & (RWLOCK_WRITER | RWLOCK_READER_MASK)) {
+        return false;
+    }
+
+    return __atomic_compare_exchange_n(&lock->state, &state, RWLOCK_WRITER, false,
+            __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}
+
+static inline void rwlock_write_lock(struct rwlock *const lock)
+{
+    if (rwlock_try_write_lock(lock)) {
+        lock_statistics_acquire(lock->statistics, false, 0, false);
+        return;
+    }
+
+    const uint64_t wait_start = timestamp_counter_read();
+
+    while (!rwlock_try_write_lock(lock)) {
+        // Another writer may take the lock and clear the flag, so it's set again on every try.
+        if (!(__atomic_load_n(&lock->state, __ATOMIC_RELAXED) & RWLOCK_WRITER_WAITING)) {
+            __atomic_fetch_or(&lock->state, RWLOCK_WRITER_WAITING, __ATOMIC_RELAXED);
+        }
+        asm __volatile__("pause");
+    }
+
+    lock_statistics_acquire(lock->statistics, true, wait_start, false);
+}
+
+static inline void rwlock_write_unlock(struct rwlock *const lock)
+{
+    lock_statistics_release(lock->statistics);
+
+    // Keep the flag of writers that came meanwhile.
+    __atomic_fetch_and(&lock->state, ~RWLOCK_WRITER, __ATOMIC_RELEASE);
+}
+
+/**
+ * Disable interrupts and take the lock for reading.
+ *
+ * @return The flags to pass to `rwlock_read_unlock_restore`.
+ */
+static inline uint64_t rwlock_read_lock_save(struct rwlock *const lock)
+{
+    const uint64_t flags = interrupts_save_and_disable();
+    rwlock_read_lock(lock);
+
+    return flags;
+}
+
+static inline void rwlock_read_unlock_restore(struct rwlock *const lock, uint64_t flags)
+{
+    rwlock_read_unlock(lock);
+    interrupts_restore(flags);
+}
+
+/**
+ * Disable interrupts and take the lock for writing.
+ *
+ * @return The flags to pass to `rwlock_write_unlock_restore`.
+ */
+static inline uint64_t rwlock_write_lock_save(struct rwlock *const lock)
+{
+    const uint64_t flags = interrupts_save_and_disable();
+    rwlock_write_lock(lock);
+
+    return flags;
+}
+
+static inline void rwlock_write_unlock_restore(struct rwlock *const lock, uint64_t flags)
+{
+    rwlock_write_unlock(lock);
+    interrupts_restore(flags);
+}
+
+#endif
@@ -0,0 +1,104 @@
+#ifndef _SYNC_SPINLOCK_H
+#define _SYNC_SPINLOCK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <cpu/timestamp_counter.h>
+#include <interrupts/control_register.h>
+
+#include "lock_statistics.h"
+
+/**
+ * A ticket lock processors spin on until it's free.
+ *
+ * Each processor takes the next ticket and waits until the owner ticket reaches it, so the lock
+ * is handed over in the order processors came and none of them starves. All waiters spin on the
+ * same cache line, so use `struct mcs_lock` for locks many processors fight over.
+ *
+ * Hold it for short sections only, and never across a context switch. Take it with interrupts
+ * disabled, or with `spinlock_lock_save`, if an interrupt handler may take it too, otherwise the
+ * handler spins forever on the lock its own processor holds.
+ */
+struct spinlock {
+    uint32_t next_ticket;
+    uint32_t owner_ticket;
+    /** NULL unless set by `spinlock_set_statistics`. */
+    struct lock_statistics *statistics;
+};
+
+static inline void spinlock_initialize(struct spinlock *const lock)
+{
+    lock->next_ticket = 0;
+    lock->owner_ticket = 0;
+    lock->statistics = NULL;
+}
+
+/** Record the use of the lock in `statistics`. Set it before the lock is used. */
+static inline void spinlock_set_statistics(struct spinlock *const lock,
+        struct lock_statistics *const statistics)
+{
+    lock->statistics = statistics;
+}
+
+static inline bool spinlock_try_lock(struct spinlock *const lock)
+{
+    uint32_t owner_ticket = __atomic_load_n(&lock->owner_ticket, __ATOMIC_RELAXED);
+
+    // The lock is free if no ticket was taken after the one of the owner.
+    if (!__atomic_compare_exchange_n(&lock->next_ticket, &owner_ticket, owner_ticket + 1, false,
+                __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        return false;
+    }
+
+    lock_statistics_acquire(lock->statistics, false, 0, false);
+
+    return true;
+}
+
+static inline void spinlock_lock(struct spinlock *const lock)
+{
+    const uint32_t ticket = __atomic_fetch_add(&lock->next_ticket, 1, __ATOMIC_RELAXED);
+
+    if (__atomic_load_n(&lock->owner_ticket, __ATOMIC_ACQUIRE) == ticket) {
+        lock_statistics_acquire(lock->statistics, false, 0, false);
+        return;
+    }
+
+    const uint64_t wait_start = timestamp_counter_read();
+
+    while (__atomic_load_n(&lock->owner_ticket, __ATOMIC_ACQUIRE) != ticket) {
+        asm __volatile__("pause");
+    }
+
+    lock_statistics_acquire(lock->statistics, true, wait_start, false);
+}
+
+static inline void spinlock_unlock(struct spinlock *const lock)
+{
+    lock_statistics_release(lock->statistics);
+
+    // Only the holder writes the owner ticket, so it doesn't need an atomic increment.
+    __atomic_store_n(&lock->owner_ticket, lock->owner_ticket + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Disable interrupts and take the lock.
+ *
+ * @return The flags to pass to `spinlock_unlock_restore`.
+ */
+static inline uint64_t spinlock_lock_save(struct spinlock *const lock)
+{
+    const uint64_t flags = interrupts_save_and_disable();
+    spinlock_lock(lock);
+
+    return flags;
+}
+
+static inline void spinlock_unlock_restore(struct spinlock *const lock, uint64_t flags)
+{
+    spinlock_unlock(lock);
+    interrupts_restore(flags);
+}
+
+#endif
@@ -0,0 +1,86 @@
+#include "spsc_ring.h"
+
+int spsc_ring_initialize(struct spsc_ring *const ring, void *const buffer, uint64_t entry_number,
+        uint64_t entry_size)
+{
+    if (entry_number == 0 || (entry_number & (entry_number - 1)) != 0) {
+        return -1;
+    }
+
+    ring->buffer = buffer;
+    ring->entry_size = entry_size;
+    ring->mask = entry_number - 1;
+    ring->head = 0;
+    ring->tail_cache = 0;
+    ring->tail = 0;
+    ring->head_cache = 0;
+
+    return 0;
+}
+
+/**
+ * Copy `number` entries between `entries` and the ring from `index` on.
+ *
+ * The entries may wrap around the end of the buffer, so the copy is done in up to two spans.
+ */
+static void copy_entries(struct spsc_ring *const ring, uint64_t index, void *const entries,
+        uint64_t number, bool is_push)
+{
+    const uint64_t position = index & ring->mask;
+    const uint64_t first_number = number < ring->mask + 1 - position
+        ? number : ring->mask + 1 - position;
+    uint8_t *const bytes = entries;
+    uint8_t *const slot = &ring->buffer[position * ring->entry_size];
+    const uint64_t first_size = first_number * ring->entry_size;
+    const uint64_t second_size = (number - first_number) * ring->entry_size;
+
+    if (is_push) {
+        memory_copy(slot, bytes, first_size);
+        memory_copy(ring->buffer, &bytes[first_size], second_size);
+    } else {
+        memory_copy(bytes, slot, first_size);
+        memory_copy(&bytes[first_size], ring->buffer, second_size);
+    }
+}
+
+uint64_t spsc_ring_push_bulk(struct spsc_ring *const ring, const void *const entries,
+        uint64_t number)
+{
+    const uint64_t tail = ring->tail;
+    uint64_t free_number = ring->mask + 1 - (tail - ring->head_cache);
+
+    if (free_number < number) {
+        ring->head_cache = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        free_number = ring->mask + 1 - (tail - ring->head_cache);
+    }
+
+    if (number > free_number) {
+        number = free_number;
+    }
+
+    copy_entries(ring, tail, (void *)entries, number, true);
+    __atomic_store_n(&ring->tail, tail + number, __ATOMIC_RELEASE);
+
+    return number;
+}
+
+uint64_t spsc_ring_pop_bulk(struct spsc_ring *const ring, void *const destination,
+        uint64_t number)
+{
+    const uint64_t head = ring->head;
+    uint64_t ready_number = ring->tail_cache - head;
+
+    if (ready_number < number) {
+        ring->tail_cache = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+        ready_number = ring->tail_cache - head;
+    }
+
+    if (number > ready_number) {
+        number = ready_number;
+    }
+
+    copy_entries(ring, head, destination, number, false);
+    __atomic_store_n(&ring->head, head + number, __ATOMIC_RELEASE);
+
+    return number;
+}
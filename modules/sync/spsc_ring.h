@@ -0,0 +1,118 @@
+#ifndef _SYNC_SPSC_RING_H
+#define _SYNC_SPSC_RING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <general/memory.h>
+
+/**
+ * A lock-free ring buffer for a single producer and a single consumer.
+ *
+ * The producer only writes `tail` and the consumer only writes `head`, so neither needs a lock
+ * or an atomic read-modify-write. Each publishes its index with a release store after touching
+ * the entries, and the other reads it with an acquire load before touching them.
+ *
+ * The indices keep increasing and are masked into the buffer, which holds a power of two of
+ * entries, so no division is needed and a full ring is told apart from an empty one. Both sides
+ * keep a copy of the index of the other one and only read the cache line of the other side when
+ * the copy says the ring is full or empty.
+ *
+ * The producer and the consumer may be on different processors, or one may interrupt the other,
+ * as long as there is only one of each.
+ */
+struct spsc_ring {
+    uint8_t *buffer;
+    uint64_t entry_size;
+    /** The number of entries minus one. */
+    uint64_t mask;
+
+    /** Index of the next entry to pop. Written by the consumer. */
+    uint64_t head __attribute__((aligned(64)));
+    /** What the consumer last read of `tail`. */
+    uint64_t tail_cache;
+
+    /** Index of the next entry to push. Written by the producer. */
+    uint64_t tail __attribute__((aligned(64)));
+    /** What the producer last read of `head`. */
+    uint64_t head_cache;
+} __attribute__((aligned(64)));
+
+/**
+ * Set up a ring over `buffer` of `entry_number` entries of `entry_size` bytes.
+ *
+ * @return 0 on success, -1 if `entry_number` is not a power of two.
+ */
+int spsc_ring_initialize(struct spsc_ring *const ring, void *const buffer, uint64_t entry_number,
+        uint64_t entry_size);
+
+/**
+ * Push as many of `number` entries as there is room for. Called by the producer only.
+ *
+ * @return The number of entries pushed.
+ */
+uint64_t spsc_ring_push_bulk(struct spsc_ring *const ring, const void *const entries,
+        uint64_t number);
+
+/**
+ * Pop up to `number` entries into `destination`. Called by the consumer only.
+ *
+ * @return The number of entries popped.
+ */
+uint64_t spsc_ring_pop_bulk(struct spsc_ring *const ring, void *const destination,
+        uint64_t number);
+
+/**
+ * Push an entry. Called by the producer only.
+ *
+ * @return 0 on success, -1 if the ring is full.
+ */
+static inline int spsc_ring_push(struct spsc_ring *const ring, const void *const entry)
+{
+    const uint64_t tail = ring->tail;
+
+    if (tail - ring->head_cache > ring->mask) {
+        ring->head_cache = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+        if (tail - ring->head_cache > ring->mask) {
+            return -1;
+        }
+    }
+
+    memory_copy(&ring->buffer[(tail & ring->mask) * ring->entry_size], entry, ring->entry_size);
+    __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+/**
+ * Pop an entry into `destination`. Called by the consumer only.
+ *
+ * @return 0 on success, -1 if the ring is empty.
+ */
+static inline int spsc_ring_pop(struct spsc_ring *const ring, void *const destination)
+{
+    const uint64_t head = ring->head;
+
+    if (head == ring->tail_cache) {
+        ring->tail_cache = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+        if (head == ring->tail_cache) {
+            return -1;
+        }
+    }
+
+    memory_copy(destination, &ring->buffer[(head & ring->mask) * ring->entry_size],
+            ring->entry_size);
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+/** It may be called from anywhere, but only the consumer can rely on a ring staying non-empty. */
+static inline bool spsc_ring_is_empty(const struct spsc_ring *const ring)
+{
+    return __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE)
+        == __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+}
+
+#endif
@@ -0,0 +1,702 @@
+#include <stddef.h>
+#include <cpu/local.h>
+#include <general/red_black_tree.h>
+#include <general/string.h>
+#include <interrupts/handler.h>
+#include <interrupts/local_apic.h>
+#include <kernel/smp.h>
+#include <sync/spinlock.h>
+#include <time/clock.h>
+#include <time/timer.h>
+
+#include "scheduler.h"
+
+/** Every ready thread runs at least once in this period, unless there are too many threads. */
+#define SCHEDULER_LATENCY             (6 * CLOCK_NANOSECONDS_PER_MILLISECOND)
+/** The shortest time slice, so switches don't eat up the processor with many threads. */
+#define SCHEDULER_MINIMUM_GRANULARITY (750 * CLOCK_NANOSECONDS_PER_MICROSECOND)
+/** A woken thread preempts the running one if it's behind by more than this. */
+#define SCHEDULER_WAKEUP_GRANULARITY  (1 * CLOCK_NANOSECONDS_PER_MILLISECOND)
+/**
+ * A woken thread gets at most this much credit for the time it slept.
+ *
+ * Threads that sleep a lot get to run as soon as they wake up, but they can't save up the
+ * time to monopolize the processor afterwards.
+ */
+#define SCHEDULER_SLEEPER_CREDIT      (SCHEDULER_LATENCY / 2)
+/** A thread that stopped running more recently than this is left on its processor if possible. */
+#define SCHEDULER_MIGRATION_COST      (500 * CLOCK_NANOSECONDS_PER_MICROSECOND)
+/** How often a processor running threads compares its load with the others. */
+#define SCHEDULER_BALANCE_INTERVAL    (10 * CLOCK_NANOSECONDS_PER_MILLISECOND)
+
+#define SCHEDULER_NICE_0_WEIGHT (1024)
+#define SCHEDULER_NICE_NUMBER   (SCHEDULER_NICE_MAX - SCHEDULER_NICE_MIN + 1)
+
+/**
+ * Weights of nice values from -20 to 19, taken from Linux.
+ *
+ * Each step changes the share of the processor by about 10% against a thread of the default
+ * nice value.
+ */
+static const uint32_t global_nice_to_weight[SCHEDULER_NICE_NUMBER] = {
+    88761, 71755, 56483, 46273, 36291,
+    29154, 23254, 18705, 14949, 11916,
+    9548,  7620,  6100,  4904,  3906,
+    3121,  2501,  1991,  1586,  1277,
+    1024,  820,   655,   526,   423,
+    335,   272,   215,   172,   137,
+    110,   87,    70,    56,    45,
+    36,    29,    23,    18,    15
+};
+
+/**
+ * The ready threads of a processor.
+ *
+ * Other processors take the lock to queue threads here and to steal them. They read the load
+ * without the lock, as a hint only. Queues are aligned on cache lines so processors working on
+ * their own queues don't disturb each other.
+ */
+struct scheduler_run_queue {
+    struct spinlock lock;
+    struct lock_statistics lock_statistics;
+    struct red_black_tree ready_threads;
+    /** Total weight of threads in `ready_threads`. */
+    uint64_t ready_weight;
+    uint64_t ready_thread_number;
+    /** Never decreases, so threads joining the queue don't start too far behind. */
+    uint64_t min_virtual_runtime;
+    /** NULL while the idle thread runs. */
+    struct thread *current;
+    struct timer slice_timer;
+    uint64_t slice_end;
+    /** Runs every `SCHEDULER_BALANCE_INTERVAL` while a thread runs. */
+    struct timer balance_timer;
+    uint64_t migration_number;
+    uint32_t cpu_index;
+    bool is_preemption_needed;
+    bool is_online;
+} __attribute__((aligned(64)));
+
+static struct scheduler_run_queue global_run_queues[CPU_MAX_NUMBER];
+
+static inline struct scheduler_run_queue *get_run_queue(void)
+{
+    return &global_run_queues[cpu_local_index()];
+}
+
+static inline struct scheduler_entity *get_entity(const struct red_black_tree_node *const node)
+{
+    return container_of(node, struct scheduler_entity, node);
+}
+
+static inline struct thread *get_thread(struct scheduler_entity *const entity)
+{
+    return container_of(entity, struct thread, scheduler_entity);
+}
+
+/** Compare through the difference so the order survives an overflow of the runtime. */
+static inline bool is_before(uint64_t a, uint64_t b)
+{
+    return (int64_t)(a - b) < 0;
+}
+
+static bool is_less(const struct red_black_tree_node *const a,
+        const struct red_black_tree_node *const b)
+{
+    return is_before(get_entity(a)->virtual_runtime, get_entity(b)->virtual_runtime);
+}
+
+static inline bool is_online(const struct scheduler_run_queue *const run_queue)
+{
+    return __atomic_load_n(&run_queue->is_online, __ATOMIC_ACQUIRE);
+}
+
+/** Return the number of threads running or ready on the processor, read without the lock. */
+static inline uint64_t get_load(const struct scheduler_run_queue *const run_queue)
+{
+    const uint64_t ready_thread_number =
+        __atomic_load_n(&run_queue->ready_thread_number, __ATOMIC_RELAXED);
+    const bool is_running = __atomic_load_n(&run_queue->current, __ATOMIC_RELAXED) != NULL;
+
+    return ready_thread_number + (is_running ? 1 : 0);
+}
+
+static uint64_t get_time_slice(const struct scheduler_run_queue *const run_queue,
+        const struct scheduler_entity *const entity)
+{
+    const uint64_t thread_number = run_queue->ready_thread_number + 1;
+    const uint64_t total_weight = run_queue->ready_weight + entity->weight;
+
+    uint64_t period = SCHEDULER_LATENCY;
+    if (thread_number * SCHEDULER_MINIMUM_GRANULARITY > SCHEDULER_LATENCY) {
+        period = thread_number * SCHEDULER_MINIMUM_GRANULARITY;
+    }
+
+    const uint64_t slice = period * entity->weight / total_weight;
+
+    return slice < SCHEDULER_MINIMUM_GRANULARITY ? SCHEDULER_MINIMUM_GRANULARITY : slice;
+}
+
+static void update_min_virtual_runtime(struct scheduler_run_queue *const run_queue)
+{
+    const struct red_black_tree_node *const first =
+        red_black_tree_get_first(&run_queue->ready_threads);
+    uint64_t virtual_runtime = run_queue->min_virtual_runtime;
+    bool has_candidate = false;
+
+    if (run_queue->current != NULL) {
+        virtual_runtime = run_queue->current->scheduler_entity.virtual_runtime;
+        has_candidate = true;
+    }
+
+    if (first != NULL) {
+        if (!has_candidate || is_before(get_entity(first)->virtual_runtime, virtual_runtime)) {
+            virtual_runtime = get_entity(first)->virtual_runtime;
+        }
+        has_candidate = true;
+    }
+
+    if (has_candidate && is_before(run_queue->min_virtual_runtime, virtual_runtime)) {
+        run_queue->min_virtual_runtime = virtual_runtime;
+    }
+}
+
+static void update_current(struct scheduler_run_queue *const run_queue)
+{
+    if (run_queue->current == NULL) {
+        return;
+    }
+
+    struct scheduler_entity *const entity = &run_queue->current->scheduler_entity;
+    const uint64_t now = clock_get_nanoseconds();
+    const uint64_t delta = now - entity->start_time;
+
+    entity->runtime += delta;
+    entity->virtual_runtime += delta * SCHEDULER_NICE_0_WEIGHT / entity->weight;
+    entity->start_time = now;
+
+    update_min_virtual_runtime(run_queue);
+}
+
+static void insert_entity(struct scheduler_run_queue *const run_queue,
+        struct scheduler_entity *const entity)
+{
+    red_black_tree_insert(&run_queue->ready_threads, &entity->node, is_less);
+    entity->is_queued = true;
+    entity->queued_weight = entity->weight;
+    run_queue->ready_weight += entity->queued_weight;
+    ++run_queue->ready_thread_number;
+}
+
+static void remove_entity(struct scheduler_run_queue *const run_queue,
+        struct scheduler_entity *const entity)
+{
+    red_black_tree_remove(&run_queue->ready_threads, &entity->node);
+    entity->is_queued = false;
+    run_queue->ready_weight -= entity->queued_weight;
+    --run_queue->ready_thread_number;
+}
+
+/**
+ * Bring a thread from the processor it ran on last to the one of `run_queue`, which is locked.
+ *
+ * Virtual runtimes of different queues don't compare, so the thread keeps its lead or lag
+ * against the minimum instead. The minimum of the old queue is read without its lock. It never
+ * decreases, so a stale value only gives the thread a little more credit.
+ */
+static void move_entity(struct scheduler_run_queue *const run_queue,
+        struct scheduler_entity *const entity)
+{
+    if (entity->cpu_index == run_queue->cpu_index) {
+        return;
+    }
+
+    const struct scheduler_run_queue *const previous = &global_run_queues[entity->cpu_index];
+    const uint64_t previous_min_virtual_runtime =
+        __atomic_load_n(&previous->min_virtual_runtime, __ATOMIC_RELAXED);
+
+    entity->virtual_runtime =
+        entity->virtual_runtime - previous_min_virtual_runtime + run_queue->min_virtual_runtime;
+    entity->cpu_index = run_queue->cpu_index;
+    ++run_queue->migration_number;
+}
+
+/** Interrupt another processor to make it look at its run queue. */
+static void kick_cpu(uint32_t cpu_index)
+{
+    local_apic_send_interrupt(smp_get_local_apic_id(cpu_index), LOCAL_APIC_RESCHEDULE_VECTOR);
+}
+
+/**
+ * Choose the processor to queue a new or woken thread on.
+ *
+ * An idle processor runs the thread right away. The one the thread ran on last comes first, as
+ * it may still have the data of the thread in its cache. If none is idle, a woken thread goes
+ * back there, and a new thread, which has nothing in any cache, goes to the least loaded one.
+ */
+static uint32_t select_cpu(const struct scheduler_entity *const entity,
+        enum scheduler_enqueue_type type)
+{
+    const uint32_t previous = entity->cpu_index;
+
+    if (entity->is_pinned || get_load(&global_run_queues[previous]) == 0) {
+        return previous;
+    }
+
+    uint32_t least_loaded = previous;
+    uint64_t least_load = get_load(&global_run_queues[previous]);
+
+    for (uint32_t i = 0; i < CPU_MAX_NUMBER; ++i) {
+        const struct scheduler_run_queue *const run_queue = &global_run_queues[i];
+
+        if (!is_online(run_queue)) {
+            continue;
+        }
+
+        const uint64_t load = get_load(run_queue);
+        if (load == 0) {
+            return i;
+        }
+        if (load < least_load) {
+            least_loaded = i;
+            least_load = load;
+        }
+    }
+
+    return type == SCHEDULER_ENQUEUE_NEW ? least_loaded : previous;
+}
+
+/** Return the queue of another processor with the most ready threads, or NULL if all are empty. */
+static struct scheduler_run_queue *find_busiest(uint32_t cpu_index)
+{
+    struct scheduler_run_queue *busiest = NULL;
+    uint64_t busiest_number = 0;
+
+    for (uint32_t i = 0; i < CPU_MAX_NUMBER; ++i) {
+        struct scheduler_run_queue *const run_queue = &global_run_queues[i];
+
+        if (i == cpu_index || !is_online(run_queue)) {
+            continue;
+        }
+
+        const uint64_t number =
+            __atomic_load_n(&run_queue->ready_thread_number, __ATOMIC_RELAXED);
+        if (number > busiest_number) {
+            busiest = run_queue;
+            busiest_number = number;
+        }
+    }
+
+    return busiest;
+}
+
+/** Return an idle processor other than `cpu_index`, or `CPU_MAX_NUMBER` if none is idle. */
+static uint32_t find_idle(uint32_t cpu_index)
+{
+    for (uint32_t i = 0; i < CPU_MAX_NUMBER; ++i) {
+        const struct scheduler_run_queue *const run_queue = &global_run_queues[i];
+
+        if (i != cpu_index && is_online(run_queue) && get_load(run_queue) == 0) {
+            return i;
+        }
+    }
+
+    return CPU_MAX_NUMBER;
+}
+
+/**
+ * Take a ready thread out of the queue of another processor.
+ *
+ * Pinned threads stay, and so do threads whose processor is still switching away from them. A
+ * thread that stopped running long enough ago to have left the cache is taken first.
+ *
+ * Only the queue of `victim` is locked, so processors stealing from each other can't deadlock.
+ *
+ * @return The thread, which is in no queue, or NULL if nothing can be taken.
+ */
+static struct scheduler_entity *steal(struct scheduler_run_queue *const victim)
+{
+    const uint64_t now = clock_get_nanoseconds();
+    struct scheduler_entity *candidate = NULL;
+
+    spinlock_lock(&victim->lock);
+
+    for (struct red_black_tree_node *node = red_black_tree_get_first(&victim->ready_threads);
+            node != NULL; node = red_black_tree_get_next(node)) {
+        struct scheduler_entity *const entity = get_entity(node);
+
+        if (entity->is_pinned || __atomic_load_n(&get_thread(entity)->is_on_cpu,
+                    __ATOMIC_ACQUIRE)) {
+            continue;
+        }
+
+        if (now - entity->stop_time >= SCHEDULER_MIGRATION_COST) {
+            candidate = entity;
+            break;
+        }
+
+        if (candidate == NULL) {
+            candidate = entity;
+        }
+    }
+
+    if (candidate != NULL) {
+        remove_entity(victim, candidate);
+    }
+
+    spinlock_unlock(&victim->lock);
+
+    return candidate;
+}
+
+static void handle_slice_end(uint64_t data)
+{
+    struct scheduler_run_queue *const run_queue = (struct scheduler_run_queue *)data;
+
+    spinlock_lock(&run_queue->lock);
+
+    /*
+     * Nothing else to run, so let the thread keep running without a timer. `scheduler_enqueue`
+     * arms the timer again when another thread becomes ready.
+     */
+    if (run_queue->current != NULL && run_queue->ready_thread_number > 0) {
+        run_queue->is_preemption_needed = true;
+    }
+
+    spinlock_unlock(&run_queue->lock);
+}
+
+/**
+ * Decide whether a thread just queued in `run_queue`, which is locked, should preempt the running
+ * one.
+ *
+ * @return Whether the processor of the queue is another one that has to be interrupted to notice.
+ */
+static bool check_preemption(struct scheduler_run_queue *const run_queue,
+        const struct scheduler_entity *const entity)
+{
+    const bool is_local = run_queue->cpu_index == cpu_local_index();
+
+    if (run_queue->current == NULL) {
+        run_queue->is_preemption_needed = true;
+        return !is_local;
+    }
+
+    update_current(run_queue);
+
+    const uint64_t current_virtual_runtime = run_queue->current->scheduler_entity.virtual_runtime;
+    if (is_before(entity->virtual_runtime + SCHEDULER_WAKEUP_GRANULARITY,
+                current_virtual_runtime)) {
+        run_queue->is_preemption_needed = true;
+        return !is_local;
+    }
+
+    // Timers run on the processor that adds them, so another processor arms its own.
+    if (!run_queue->slice_timer.is_pending) {
+        if (!is_local) {
+            return true;
+        }
+        timer_add(&run_queue->slice_timer, run_queue->slice_end);
+    }
+
+    return false;
+}
+
+static void handle_balance(uint64_t data)
+{
+    struct scheduler_run_queue *const run_queue = (struct scheduler_run_queue *)data;
+    struct scheduler_run_queue *const busiest = find_busiest(run_queue->cpu_index);
+
+    // Moving a thread between two queues whose loads differ by one only swaps the loads.
+    if (busiest != NULL && get_load(busiest) > get_load(run_queue) + 1) {
+        struct scheduler_entity *const entity = steal(busiest);
+
+        if (entity != NULL) {
+            spinlock_lock(&run_queue->lock);
+            move_entity(run_queue, entity);
+            insert_entity(run_queue, entity);
+            check_preemption(run_queue, entity);
+            spinlock_unlock(&run_queue->lock);
+        }
+    }
+
+    // An idle processor sleeps until interrupted, so hand it the threads waiting here.
+    if (__atomic_load_n(&run_queue->ready_thread_number, __ATOMIC_RELAXED) > 0) {
+        const uint32_t idle = find_idle(run_queue->cpu_index);
+        if (idle < CPU_MAX_NUMBER) {
+            kick_cpu(idle);
+        }
+    }
+
+    spinlock_lock(&run_queue->lock);
+    if (run_queue->current != NULL) {
+        timer_add(&run_queue->balance_timer,
+                clock_get_nanoseconds() + SCHEDULER_BALANCE_INTERVAL);
+    }
+    spinlock_unlock(&run_queue->lock);
+}
+
+/**
+ * Another processor queued a thread here or found this processor idle.
+ *
+ * The switch itself happens on the way out of the interrupt, where the idle thread also steals
+ * a thread if the queue is empty.
+ */
+static int handle_reschedule(const struct interrupt_frame *const frame, void *const context)
+{
+    (void)frame;
+    (void)context;
+
+    struct scheduler_run_queue *const run_queue = get_run_queue();
+
+    spinlock_lock(&run_queue->lock);
+
+    if (run_queue->current == NULL) {
+        run_queue->is_preemption_needed = true;
+    } else if (run_queue->ready_thread_number > 0 && !run_queue->slice_timer.is_pending) {
+        timer_add(&run_queue->slice_timer, run_queue->slice_end);
+    }
+
+    spinlock_unlock(&run_queue->lock);
+
+    return INTERRUPT_HANDLED;
+}
+
+int scheduler_initialize(void)
+{
+    char name[LOCK_STATISTICS_NAME_SIZE];
+
+    for (uint32_t i = 0; i < CPU_MAX_NUMBER; ++i) {
+        struct scheduler_run_queue *const run_queue = &global_run_queues[i];
+
+        spinlock_initialize(&run_queue->lock);
+        string_format(name, sizeof(name), "run queue %u", i);
+        if (lock_statistics_register(&run_queue->lock_statistics, name) == 0) {
+            spinlock_set_statistics(&run_queue->lock, &run_queue->lock_statistics);
+        }
+        red_black_tree_initialize(&run_queue->ready_threads);
+        run_queue->ready_weight = 0;
+        run_queue->ready_thread_number = 0;
+        run_queue->min_virtual_runtime = 0;
+        run_queue->current = NULL;
+        timer_setup(&run_queue->slice_timer, handle_slice_end, (uint64_t)run_queue);
+        run_queue->slice_end = 0;
+        timer_setup(&run_queue->balance_timer, handle_balance, (uint64_t)run_queue);
+        run_queue->migration_number = 0;
+        run_queue->cpu_index = i;
+        run_queue->is_preemption_needed = false;
+        run_queue->is_online = false;
+    }
+
+    return interrupt_register(LOCAL_APIC_RESCHEDULE_VECTOR, handle_reschedule, NULL);
+}
+
+void scheduler_add_cpu(void)
+{
+    __atomic_store_n(&get_run_queue()->is_online, true, __ATOMIC_RELEASE);
+}
+
+bool scheduler_is_cpu_online(uint32_t cpu_index)
+{
+    return cpu_index < CPU_MAX_NUMBER && is_online(&global_run_queues[cpu_index]);
+}
+
+void scheduler_initialize_entity(struct scheduler_entity *const entity)
+{
+    entity->virtual_runtime = 0;
+    entity->runtime = 0;
+    entity->start_time = 0;
+    entity->stop_time = 0;
+    entity->weight = SCHEDULER_NICE_0_WEIGHT;
+    entity->queued_weight = 0;
+    entity->cpu_index = cpu_local_index();
+    entity->nice = SCHEDULER_NICE_DEFAULT;
+    entity->is_queued = false;
+    entity->is_pinned = false;
+}
+
+void scheduler_enqueue(struct thread *const thread, enum scheduler_enqueue_type type)
+{
+    struct scheduler_entity *const entity = &thread->scheduler_entity;
+    const bool is_placed = type == SCHEDULER_ENQUEUE_NEW || type == SCHEDULER_ENQUEUE_WAKEUP;
+    const uint32_t cpu_index = is_placed ? select_cpu(entity, type) : cpu_local_index();
+    struct scheduler_run_queue *const run_queue = &global_run_queues[cpu_index];
+    bool is_kick_needed = false;
+
+    spinlock_lock(&run_queue->lock);
+
+    switch (type) {
+    case SCHEDULER_ENQUEUE_NEW:
+        entity->virtual_runtime = run_queue->min_virtual_runtime;
+        entity->cpu_index = cpu_index;
+        break;
+    case SCHEDULER_ENQUEUE_WAKEUP: {
+        move_entity(run_queue, entity);
+
+        const uint64_t min_virtual_runtime =
+            run_queue->min_virtual_runtime - SCHEDULER_SLEEPER_CREDIT;
+        if (is_before(entity->virtual_runtime, min_virtual_runtime)) {
+            entity->virtual_runtime = min_virtual_runtime;
+        }
+        break;
+    }
+    case SCHEDULER_ENQUEUE_PREEMPT:
+        break;
+    case SCHEDULER_ENQUEUE_YIELD: {
+        // Equal runtimes go after, so this lets the first thread run before the yielding one.
+        const struct red_black_tree_node *const first =
+            red_black_tree_get_first(&run_queue->ready_threads);
+        if (first == NULL) {
+            break;
+        }
+        const uint64_t first_virtual_runtime = get_entity(first)->virtual_runtime;
+        if (is_before(entity->virtual_runtime, first_virtual_runtime)) {
+            entity->virtual_runtime = first_virtual_runtime;
+        }
+        break;
+    }
+    }
+
+    insert_entity(run_queue, entity);
+
+    if (is_placed) {
+        is_kick_needed = check_preemption(run_queue, entity);
+    }
+
+    spinlock_unlock(&run_queue->lock);
+
+    if (is_kick_needed) {
+        kick_cpu(cpu_index);
+    }
+}
+
+struct thread *scheduler_pick_next(void)
+{
+    struct scheduler_run_queue *const run_queue = get_run_queue();
+    struct scheduler_entity *entity = NULL;
+
+    spinlock_lock(&run_queue->lock);
+
+    struct red_black_tree_node *const first = red_black_tree_get_first(&run_queue->ready_threads);
+    if (first != NULL) {
+        entity = get_entity(first);
+        remove_entity(run_queue, entity);
+    }
+
+    spinlock_unlock(&run_queue->lock);
+
+    if (entity != NULL) {
+        return get_thread(entity);
+    }
+
+    struct scheduler_run_queue *const busiest = find_busiest(run_queue->cpu_index);
+    if (busiest == NULL) {
+        return NULL;
+    }
+
+    entity = steal(busiest);
+    if (entity == NULL) {
+        return NULL;
+    }
+
+    spinlock_lock(&run_queue->lock);
+    move_entity(run_queue, entity);
+    spinlock_unlock(&run_queue->lock);
+
+    return get_thread(entity);
+}
+
+void scheduler_start(struct thread *const thread)
+{
+    struct scheduler_run_queue *const run_queue = get_run_queue();
+
+    spinlock_lock(&run_queue->lock);
+
+    run_queue->current = thread;
+    run_queue->is_preemption_needed = false;
+
+    if (thread == NULL) {
+        timer_cancel(&run_queue->slice_timer);
+        timer_cancel(&run_queue->balance_timer);
+        spinlock_unlock(&run_queue->lock);
+        return;
+    }
+
+    struct scheduler_entity *const entity = &thread->scheduler_entity;
+    const uint64_t now = clock_get_nanoseconds();
+
+    entity->start_time = now;
+    run_queue->slice_end = now + get_time_slice(run_queue, entity);
+
+    if (run_queue->ready_thread_number > 0) {
+        timer_add(&run_queue->slice_timer, run_queue->slice_end);
+    } else {
+        timer_cancel(&run_queue->slice_timer);
+    }
+
+    if (!run_queue->balance_timer.is_pending) {
+        timer_add(&run_queue->balance_timer, now + SCHEDULER_BALANCE_INTERVAL);
+    }
+
+    spinlock_unlock(&run_queue->lock);
+}
+
+void scheduler_stop(struct thread *const thread)
+{
+    struct scheduler_run_queue *const run_queue = get_run_queue();
+
+    spinlock_lock(&run_queue->lock);
+
+    if (run_queue->current == thread) {
+        update_current(run_queue);
+        thread->scheduler_entity.stop_time = thread->scheduler_entity.start_time;
+    }
+
+    spinlock_unlock(&run_queue->lock);
+}
+
+bool scheduler_has_ready_thread(void)
+{
+    return __atomic_load_n(&get_run_queue()->ready_thread_number, __ATOMIC_RELAXED) > 0;
+}
+
+bool scheduler_is_preemption_needed(void)
+{
+    return __atomic_load_n(&get_run_queue()->is_preemption_needed, __ATOMIC_RELAXED);
+}
+
+int scheduler_set_nice(struct thread *const thread, int8_t nice)
+{
+    if (nice < SCHEDULER_NICE_MIN || SCHEDULER_NICE_MAX < nice) {
+        return -1;
+    }
+
+    struct scheduler_entity *const entity = &thread->scheduler_entity;
+    const uint64_t weight = global_nice_to_weight[nice - SCHEDULER_NICE_MIN];
+
+    /*
+     * The thread may move to another queue meanwhile. It takes `queued_weight` out of the queue
+     * it leaves, so the total weights stay right even if the check below misses it.
+     */
+    const uint32_t cpu_index = entity->cpu_index;
+    struct scheduler_run_queue *const run_queue = &global_run_queues[cpu_index];
+
+    spinlock_lock(&run_queue->lock);
+
+    if (entity->is_queued && entity->cpu_index == cpu_index) {
+        run_queue->ready_weight = run_queue->ready_weight - entity->queued_weight + weight;
+        entity->queued_weight = weight;
+    }
+
+    entity->nice = nice;
+    entity->weight = weight;
+
+    spinlock_unlock(&run_queue->lock);
+
+    return 0;
+}
+
+uint64_t scheduler_get_migration_number(uint32_t cpu_index)
+{
+    return global_run_queues[cpu_index].migration_number;
+}
@@ -0,0 +1,91 @@
+#ifndef _TASK_SCHEDULER_H
+#define _TASK_SCHEDULER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "thread.h"
+
+/**
+ * A fair scheduler in the manner of the Linux CFS.
+ *
+ * Threads ready to run wait in a red-black tree ordered by their virtual runtime, the time they
+ * have run scaled down by their weight. The thread that has run the least is picked next, so each
+ * thread gets a share of the processor proportional to its weight.
+ *
+ * The running thread and the idle thread are never in the run queue.
+ *
+ * Each processor has its own run queue behind a spinlock. New and woken threads are placed on an
+ * idle processor if there is one, preferring the one they ran on last. A processor whose queue
+ * runs dry steals a thread from the busiest queue, and busy processors pull threads from busier
+ * ones periodically and interrupt idle ones to take their surplus. A thread that ran recently is
+ * moved last, as its data is likely still in the cache.
+ *
+ * Call the functions below with interrupts disabled.
+ */
+
+enum scheduler_enqueue_type {
+    /** A thread that never ran. */
+    SCHEDULER_ENQUEUE_NEW,
+    /** A thread that was blocked. */
+    SCHEDULER_ENQUEUE_WAKEUP,
+    /** The running thread whose time slice is over. */
+    SCHEDULER_ENQUEUE_PREEMPT,
+    /** The running thread giving up the processor. It goes after the next thread. */
+    SCHEDULER_ENQUEUE_YIELD
+};
+
+/** @return 0 on success, -1 if the reschedule interrupt can't be registered. */
+int scheduler_initialize(void);
+
+/** Let threads be queued on the current processor. */
+void scheduler_add_cpu(void);
+
+bool scheduler_is_cpu_online(uint32_t cpu_index);
+
+void scheduler_initialize_entity(struct scheduler_entity *const entity);
+
+/**
+ * Make `thread` ready.
+ *
+ * New and woken threads may go to another processor, which is interrupted if it should switch to
+ * the thread. Other threads stay on the current processor.
+ */
+void scheduler_enqueue(struct thread *const thread, enum scheduler_enqueue_type type);
+
+/**
+ * Remove the thread with the smallest virtual runtime from the queue of the current processor.
+ *
+ * A thread is stolen from another processor if the queue is empty.
+ *
+ * @return NULL if no thread is ready.
+ */
+struct thread *scheduler_pick_next(void);
+
+/**
+ * Start accounting `thread` as the running thread and give it a time slice.
+ *
+ * Pass NULL when the processor switches to the idle thread.
+ */
+void scheduler_start(struct thread *const thread);
+
+/** Account the time the running thread has run since `scheduler_start`. */
+void scheduler_stop(struct thread *const thread);
+
+/** Return whether the queue of the current processor has a thread ready. */
+bool scheduler_has_ready_thread(void);
+
+/** Return whether the running thread should give the processor to another thread. */
+bool scheduler_is_preemption_needed(void);
+
+/**
+ * Set the nice value of `thread`. Lower values get a larger share of the processor.
+ *
+ * @return 0 on success, -1 if `nice` is out of the range.
+ */
+int scheduler_set_nice(struct thread *const thread, int8_t nice);
+
+/** Return the number of threads moved to the processor `cpu_index` from another one. */
+uint64_t scheduler_get_migration_number(uint32_t cpu_index);
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef _TASK_SCHEDULER_ENTITY_H
+#define _TASK_SCHEDULER_ENTITY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <general/red_black_tree.h>
+
+#define SCHEDULER_NICE_MIN     (-20)
+#define SCHEDULER_NICE_MAX     (19)
+#define SCHEDULER_NICE_DEFAULT (0)
+
+/** What the fair scheduler keeps for each thread. */
+struct scheduler_entity {
+    /** Links the thread in the run queue, ordered by `virtual_runtime`. */
+    struct red_black_tree_node node;
+    /** Nanoseconds run, scaled by the inverse of `weight`. */
+    uint64_t virtual_runtime;
+    /** Nanoseconds actually run. */
+    uint64_t runtime;
+    /** When the thread started running for the last time. */
+    uint64_t start_time;
+    /** When the thread stopped running for the last time. Its data may still be in the cache. */
+    uint64_t stop_time;
+    uint64_t weight;
+    /** The weight added to the run queue, which `weight` may have changed from since. */
+    uint64_t queued_weight;
+    /** The processor the thread is queued on or ran on last. */
+    uint32_t cpu_index;
+    int8_t nice;
+    bool is_queued;
+    /** Never move the thread off `cpu_index`. */
+    bool is_pinned;
+};
+
+#endif
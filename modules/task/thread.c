@@ -0,0 +1,478 @@
+#include <stddef.h>
+#include <asm/task/context_switch.h>
+#include <cpu/local.h>
+#include <debug/assert.h>
+#include <interrupts/control_register.h>
+#include <interrupts/deferred_work.h>
+#include <interrupts/handler.h>
+#include <sync/rcu.h>
+#include <time/clock.h>
+
+#include "scheduler.h"
+#include "thread.h"
+
+struct thread_cpu_data {
+    struct thread *current;
+    struct thread *idle;
+    /** The thread switched away from, until the switch is over. */
+    struct thread *previous;
+    /** A thread that exited. Its stack is freed once the processor has switched away from it. */
+    struct thread *dead;
+};
+
+/*
+ * Thread control blocks come from a fixed pool. The kernel has no allocator for small objects,
+ * and a control block at the bottom of the stack would be the first thing an overflow destroys.
+ */
+struct thread_data {
+    struct thread threads[THREAD_MAX_NUMBER];
+    uint64_t next_id;
+    /** Protects `threads` and `next_id`. */
+    struct spinlock lock;
+    struct lock_statistics lock_statistics;
+    struct thread_cpu_data cpus[CPU_MAX_NUMBER];
+};
+
+static struct thread_data global_thread_data;
+
+static inline struct thread_cpu_data *get_cpu_data(void)
+{
+    return &global_thread_data.cpus[cpu_local_index()];
+}
+
+static struct thread *allocate_thread(const char *const name)
+{
+    struct thread *allocated_thread = NULL;
+
+    const uint64_t flags = spinlock_lock_save(&global_thread_data.lock);
+
+    for (uint64_t i = 0; i < THREAD_MAX_NUMBER; ++i) {
+        struct thread *const thread = &global_thread_data.threads[i];
+
+        if (!thread->is_used) {
+            thread->is_used = true;
+            thread->stack_pointer = 0;
+            thread->stack.guard_address = 0;
+            thread->stack.bottom_address = 0;
+            thread->stack.top_address = 0;
+            thread->state = THREAD_STATE_READY;
+            thread->id = global_thread_data.next_id++;
+            thread->name = name;
+            thread->switch_number = 0;
+            thread->is_wakeup_pending = false;
+            thread->is_on_cpu = false;
+            spinlock_initialize(&thread->lock);
+            scheduler_initialize_entity(&thread->scheduler_entity);
+            timer_setup(&thread->timer, NULL, 0);
+            allocated_thread = thread;
+            break;
+        }
+    }
+
+    spinlock_unlock_restore(&global_thread_data.lock, flags);
+
+    return allocated_thread;
+}
+
+static void free_thread(struct thread *const thread)
+{
+    if (thread->stack.top_address != 0) {
+        stack_free(&thread->stack);
+    }
+
+    const uint64_t flags = spinlock_lock_save(&global_thread_data.lock);
+    thread->is_used = false;
+    spinlock_unlock_restore(&global_thread_data.lock, flags);
+}
+
+/** Clean up after a switch. Runs on the stack of the thread switched to. */
+static void finish_switch(struct thread_cpu_data *const cpu)
+{
+    // The registers of the previous thread are saved, so another processor may run it now.
+    if (cpu->previous != NULL) {
+        __atomic_store_n(&cpu->previous->is_on_cpu, false, __ATOMIC_RELEASE);
+        cpu->previous = NULL;
+    }
+
+    if (cpu->dead != NULL) {
+        free_thread(cpu->dead);
+        cpu->dead = NULL;
+    }
+}
+
+/**
+ * Switch to the next ready thread, or to the idle thread if none is ready.
+ *
+ * The caller stops accounting the current thread, sets its state and queues it if it stays
+ * ready.
+ */
+static void schedule(void)
+{
+    struct thread_cpu_data *const cpu = get_cpu_data();
+    struct thread *const previous = cpu->current;
+
+    assert(!rcu_is_reading(), "Switching threads inside an RCU read-side critical section");
+    rcu_note_quiescent_state();
+
+    struct thread *next = scheduler_pick_next();
+    if (next == NULL) {
+        next = cpu->idle;
+    }
+
+    scheduler_start(next != cpu->idle ? next : NULL);
+
+    if (next == previous) {
+        previous->state = THREAD_STATE_RUNNING;
+        return;
+    }
+
+    next->state = THREAD_STATE_RUNNING;
+    next->is_on_cpu = true;
+    ++next->switch_number;
+    cpu->current = next;
+    cpu->previous = previous;
+
+    context_switch(&previous->stack_pointer, next->stack_pointer);
+
+    // The processor may be another one by the time the thread runs again.
+    finish_switch(get_cpu_data());
+}
+
+/** Called by `context_switch_entry` when a new thread runs for the first time. */
+void thread_entry(thread_function_t function, void *const argument)
+{
+    finish_switch(get_cpu_data());
+    interrupts_enable();
+
+    function(argument);
+
+    thread_exit();
+}
+
+static bool has_ready_thread(void *const context)
+{
+    (void)context;
+
+    return scheduler_has_ready_thread();
+}
+
+void thread_idle(void)
+{
+    while (1) {
+        idle_wait_until(has_ready_thread, NULL);
+        thread_yield();
+    }
+}
+
+static void idle_thread(void *const argument)
+{
+    (void)argument;
+
+    thread_idle();
+}
+
+int thread_initialize(void)
+{
+    global_thread_data.next_id = 0;
+    spinlock_initialize(&global_thread_data.lock);
+    if (lock_statistics_register(&global_thread_data.lock_statistics, "thread pool") == 0) {
+        spinlock_set_statistics(&global_thread_data.lock, &global_thread_data.lock_statistics);
+    }
+
+    for (uint64_t i = 0; i < THREAD_MAX_NUMBER; ++i) {
+        global_thread_data.threads[i].is_used = false;
+    }
+
+    for (uint64_t i = 0; i < CPU_MAX_NUMBER; ++i) {
+        global_thread_data.cpus[i].current = NULL;
+        global_thread_data.cpus[i].idle = NULL;
+        global_thread_data.cpus[i].previous = NULL;
+        global_thread_data.cpus[i].dead = NULL;
+    }
+
+    if (scheduler_initialize() != 0) {
+        return -2;
+    }
+
+    scheduler_add_cpu();
+    rcu_add_cpu();
+
+    struct thread_cpu_data *const cpu = get_cpu_data();
+
+    cpu->current = allocate_thread("boot");
+    cpu->current->state = THREAD_STATE_RUNNING;
+    cpu->current->is_on_cpu = true;
+    cpu->current->scheduler_entity.is_pinned = true;
+
+    // The idle thread only runs when the run queue is empty, so it's taken out right away.
+    cpu->idle = thread_create("idle", idle_thread, NULL);
+    if (cpu->idle == NULL) {
+        return -1;
+    }
+
+    const uint64_t flags = interrupts_save_and_disable();
+    struct thread *const idle = scheduler_pick_next();
+    interrupts_restore(flags);
+
+    assert(idle == cpu->idle, "The run queue must only have the idle thread");
+
+    const uint64_t start_flags = interrupts_save_and_disable();
+    scheduler_start(cpu->current);
+    interrupts_restore(start_flags);
+
+    interrupt_set_exit_handler(thread_preempt);
+
+    return 0;
+}
+
+int thread_initialize_application_processor(void)
+{
+    struct thread_cpu_data *const cpu = get_cpu_data();
+
+    const uint64_t flags = interrupts_save_and_disable();
+
+    struct thread *const thread = allocate_thread("idle");
+    if (thread == NULL) {
+        interrupts_restore(flags);
+        return -1;
+    }
+
+    thread->state = THREAD_STATE_RUNNING;
+    thread->is_on_cpu = true;
+    thread->scheduler_entity.is_pinned = true;
+    cpu->current = thread;
+    cpu->idle = thread;
+    scheduler_add_cpu();
+    rcu_add_cpu();
+    scheduler_start(NULL);
+
+    interrupts_restore(flags);
+
+    return 0;
+}
+
+static struct thread *create_thread(const char *const name, thread_function_t function,
+        void *const argument, uint32_t cpu_index, bool is_pinned)
+{
+    struct thread *const thread = allocate_thread(name);
+    if (thread == NULL) {
+        return NULL;
+    }
+
+    if (stack_allocate(&thread->stack, THREAD_STACK_PAGE_NUMBER) != 0) {
+        free_thread(thread);
+        return NULL;
+    }
+
+    thread->stack_pointer = context_switch_initialize_stack(thread->stack.top_address,
+            (address_t)function, (address_t)argument);
+    thread->scheduler_entity.cpu_index = cpu_index;
+    thread->scheduler_entity.is_pinned = is_pinned;
+
+    const uint64_t flags = interrupts_save_and_disable();
+    scheduler_enqueue(thread, SCHEDULER_ENQUEUE_NEW);
+    interrupts_restore(flags);
+
+    return thread;
+}
+
+struct thread *thread_create(const char *const name, thread_function_t function,
+        void *const argument)
+{
+    // Only a hint of where to start looking for a processor, so it doesn't matter if it's stale.
+    return create_thread(name, function, argument, cpu_local_index(), false);
+}
+
+struct thread *thread_create_pinned(const char *const name, thread_function_t function,
+        void *const argument, uint32_t cpu_index)
+{
+    if (!scheduler_is_cpu_online(cpu_index)) {
+        return NULL;
+    }
+
+    return create_thread(name, function, argument, cpu_index, true);
+}
+
+struct thread *thread_get_current(void)
+{
+    return get_cpu_data()->current;
+}
+
+void thread_yield(void)
+{
+    const uint64_t flags = interrupts_save_and_disable();
+
+    struct thread_cpu_data *const cpu = get_cpu_data();
+    struct thread *const current = cpu->current;
+
+    if (current != cpu->idle) {
+        scheduler_stop(current);
+        current->state = THREAD_STATE_READY;
+        scheduler_enqueue(current, SCHEDULER_ENQUEUE_YIELD);
+    }
+
+    schedule();
+
+    interrupts_restore(flags);
+}
+
+void thread_block(void)
+{
+    struct thread *const current = get_cpu_data()->current;
+
+    assert(!(get_rflags() & REGISTER_RFLAGS_INTERRUPT), "Blocking with interrupts enabled");
+    assert(current != get_cpu_data()->idle, "The idle thread must not block");
+
+    scheduler_stop(current);
+
+    spinlock_lock(&current->lock);
+
+    if (current->is_wakeup_pending) {
+        current->is_wakeup_pending = false;
+        spinlock_unlock(&current->lock);
+        return;
+    }
+
+    current->state = THREAD_STATE_BLOCKED;
+
+    spinlock_unlock(&current->lock);
+
+    schedule();
+}
+
+int thread_wakeup(struct thread *const thread)
+{
+    int result = 0;
+
+    const uint64_t flags = interrupts_save_and_disable();
+
+    spinlock_lock(&thread->lock);
+
+    if (thread->state != THREAD_STATE_BLOCKED) {
+        thread->is_wakeup_pending = true;
+        spinlock_unlock(&thread->lock);
+        result = -1;
+        goto END;
+    }
+
+    thread->state = THREAD_STATE_READY;
+
+    spinlock_unlock(&thread->lock);
+
+    // The processor the thread blocked on may still be switching away from it.
+    while (__atomic_load_n(&thread->is_on_cpu, __ATOMIC_ACQUIRE)) {
+        asm __volatile__("pause");
+    }
+
+    scheduler_enqueue(thread, SCHEDULER_ENQUEUE_WAKEUP);
+
+    // Switch right away if the woken thread should run first, unless this is an interrupt handler.
+    if (flags & REGISTER_RFLAGS_INTERRUPT) {
+        thread_preempt();
+    }
+
+END:
+    interrupts_restore(flags);
+
+    return result;
+}
+
+void thread_preempt(void)
+{
+    struct thread_cpu_data *const cpu = get_cpu_data();
+    struct thread *const current = cpu->current;
+
+    // The preemption is left to a later interrupt, as readers must not leave the processor.
+    if (deferred_work_is_running() || rcu_is_reading()) {
+        return;
+    }
+
+    // The interrupted code could have been switched away from, so it holds no RCU references.
+    rcu_note_quiescent_state();
+
+    if (!scheduler_is_preemption_needed()) {
+        return;
+    }
+
+    if (current != cpu->idle) {
+        scheduler_stop(current);
+        current->state = THREAD_STATE_READY;
+        scheduler_enqueue(current, SCHEDULER_ENQUEUE_PREEMPT);
+    }
+
+    schedule();
+}
+
+static void wake_sleeping_thread(uint64_t data)
+{
+    thread_wakeup((struct thread *)data);
+}
+
+void thread_sleep(uint64_t nanoseconds)
+{
+    struct thread *const current = thread_get_current();
+
+    const uint64_t flags = interrupts_save_and_disable();
+
+    timer_setup(&current->timer, wake_sleeping_thread, (uint64_t)current);
+    timer_add(&current->timer, clock_get_nanoseconds() + nanoseconds);
+
+    while (current->timer.is_pending) {
+        thread_block();
+    }
+
+    interrupts_restore(flags);
+}
+
+struct wait_condition {
+    idle_condition_t condition;
+    void *context;
+};
+
+static bool is_condition_met_or_thread_ready(void *const context)
+{
+    const struct wait_condition *const wait = context;
+
+    return scheduler_has_ready_thread() || wait->condition(wait->context);
+}
+
+void thread_wait_until(idle_condition_t condition, void *const context)
+{
+    struct wait_condition wait = { .condition = condition, .context = context };
+
+    while (1) {
+        idle_wait_until(is_condition_met_or_thread_ready, &wait);
+
+        if (condition(context)) {
+            return;
+        }
+
+        thread_yield();
+    }
+}
+
+void thread_exit(void)
+{
+    interrupts_disable();
+
+    struct thread_cpu_data *const cpu = get_cpu_data();
+
+    assert(cpu->current != cpu->idle, "The idle thread must not exit");
+
+    scheduler_stop(cpu->current);
+    cpu->current->state = THREAD_STATE_DEAD;
+    cpu->dead = cpu->current;
+    schedule();
+
+    assert(false, "A dead thread was scheduled");
+    while (1);
+}
+
+int thread_set_nice(struct thread *const thread, int8_t nice)
+{
+    const uint64_t flags = interrupts_save_and_disable();
+    const int result = scheduler_set_nice(thread, nice);
+    interrupts_restore(flags);
+
+    return result;
+}
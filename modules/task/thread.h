@@ -0,0 +1,136 @@
+#ifndef _TASK_THREAD_H
+#define _TASK_THREAD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <kernel/idle.h>
+#include <memory/stack.h>
+#include <sync/spinlock.h>
+#include <time/timer.h>
+
+#include "scheduler_entity.h"
+
+#define THREAD_MAX_NUMBER       (64)
+/** 16 KiB of stack for each thread, plus a guard page. */
+#define THREAD_STACK_PAGE_NUMBER (4)
+
+enum thread_state {
+    THREAD_STATE_READY,
+    THREAD_STATE_RUNNING,
+    THREAD_STATE_BLOCKED,
+    THREAD_STATE_DEAD
+};
+
+typedef void (*thread_function_t)(void *const argument);
+
+/** A thread control block. */
+struct thread {
+    /** Saved by `context_switch` while the thread is not running. */
+    uint64_t stack_pointer;
+    struct stack stack;
+    struct scheduler_entity scheduler_entity;
+    /** Wakes the thread up from `thread_sleep`. */
+    struct timer timer;
+    /** Orders blocking against wakeups from other processors. */
+    struct spinlock lock;
+    enum thread_state state;
+    uint64_t id;
+    const char *name;
+    uint64_t switch_number;
+    bool is_used;
+    /** Set by a wakeup that came while the thread was not blocked. The next block returns. */
+    bool is_wakeup_pending;
+    /** Set from the switch to the thread until the switch away from it is over. */
+    bool is_on_cpu;
+};
+
+/**
+ * Turn the flow of control running `_start` into the first thread and create the idle thread.
+ *
+ * The first thread keeps running on the stack given by the boot loader. It's pinned to the
+ * bootstrap processor, which gets the interrupts of the 8259A it waits for.
+ *
+ * @return 0 on success, -1 if the idle thread can't be created, -2 if the scheduler can't be
+ * initialized.
+ */
+int thread_initialize(void);
+
+/**
+ * Turn the flow of control of an application processor into its idle thread.
+ *
+ * The thread keeps the stack the processor started on. Call `thread_idle` afterwards.
+ *
+ * @return 0 on success, -1 if there are too many threads.
+ */
+int thread_initialize_application_processor(void);
+
+/** Run the idle loop of the current processor. Interrupts must be enabled. */
+__attribute__((noreturn)) void thread_idle(void);
+
+/**
+ * Create a thread running `function(argument)` and make it ready.
+ *
+ * The thread exits when `function` returns. `name` is not copied.
+ *
+ * @return The new thread, or NULL if there are too many threads or no memory for the stack.
+ */
+struct thread *thread_create(const char *const name, thread_function_t function,
+        void *const argument);
+
+/**
+ * Create a thread like `thread_create` that only ever runs on the processor `cpu_index`.
+ *
+ * @return The new thread, or NULL if the processor is not online or the thread can't be created.
+ */
+struct thread *thread_create_pinned(const char *const name, thread_function_t function,
+        void *const argument, uint32_t cpu_index);
+
+struct thread *thread_get_current(void);
+
+/** Let other ready threads run. The current thread stays ready. */
+void thread_yield(void);
+
+/**
+ * Stop running the current thread until `thread_wakeup` is called on it.
+ *
+ * Call this with interrupts disabled, right after checking the condition to wait for. A wakeup
+ * from another processor that comes before the thread blocks makes this return right away, so it
+ * isn't lost, but it may also make a later call return early. Check the condition again in a
+ * loop. Interrupts are disabled again when this returns.
+ */
+void thread_block(void);
+
+/**
+ * Make a blocked thread ready. It may be called in interrupt handlers.
+ *
+ * If the thread is not blocked, its next `thread_block` returns right away instead.
+ *
+ * @return 0 on success, -1 if the thread was not blocked.
+ */
+int thread_wakeup(struct thread *const thread);
+
+/**
+ * Switch to another thread if the scheduler asks to preempt the current one.
+ *
+ * Called with interrupts disabled on the way out of interrupts. Nothing happens while deferred
+ * work runs, as it borrows the stack of the interrupted thread, or inside an RCU read-side
+ * critical section. Otherwise the processor is in a quiescent state for RCU.
+ */
+void thread_preempt(void);
+
+/** Block the current thread for at least `nanoseconds`. */
+void thread_sleep(uint64_t nanoseconds);
+
+/**
+ * Wait until `condition` holds, running other threads or sleeping the processor meanwhile.
+ *
+ * Use this to wait for conditions set by interrupts when no thread is there to wake the waiter.
+ */
+void thread_wait_until(idle_condition_t condition, void *const context);
+
+/** @return 0 on success, -1 if `nice` is out of the range. */
+int thread_set_nice(struct thread *const thread, int8_t nice);
+
+__attribute__((noreturn)) void thread_exit(void);
+
+#endif
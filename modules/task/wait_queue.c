@@ -0,0 +1,99 @@
+#include <stddef.h>
+#include <general/address.h>
+#include <interrupts/control_register.h>
+
+#include "thread.h"
+#include "wait_queue.h"
+
+/** Lives on the stack of the waiter, so it's only touched under the lock of the queue. */
+struct wait_queue_entry {
+    struct linked_list_node node;
+    struct thread *thread;
+    bool is_queued;
+};
+
+void wait_queue_initialize(struct wait_queue *const queue)
+{
+    spinlock_initialize(&queue->lock);
+    linked_list_initialize(&queue->waiters);
+}
+
+void wait_queue_wait(struct wait_queue *const queue, wait_queue_condition_t condition,
+        void *const context)
+{
+    struct wait_queue_entry entry = { .thread = thread_get_current(), .is_queued = false };
+
+    const uint64_t flags = interrupts_save_and_disable();
+
+    while (1) {
+        spinlock_lock(&queue->lock);
+
+        if (condition(context)) {
+            spinlock_unlock(&queue->lock);
+            break;
+        }
+
+        linked_list_append(&queue->waiters, &entry.node);
+        entry.is_queued = true;
+
+        spinlock_unlock(&queue->lock);
+
+        // A wakeup between the unlock and the block is kept by the thread, so this returns.
+        thread_block();
+
+        // The wakeup may have been meant for something else, leaving the entry queued.
+        spinlock_lock(&queue->lock);
+        if (entry.is_queued) {
+            linked_list_remove(&entry.node);
+            entry.is_queued = false;
+        }
+        spinlock_unlock(&queue->lock);
+    }
+
+    interrupts_restore(flags);
+}
+
+/** Take the first waiter out and wake it up. Called with the lock held. */
+static void wake_first(struct wait_queue *const queue)
+{
+    struct wait_queue_entry *const entry =
+        container_of(queue->waiters.next, struct wait_queue_entry, node);
+    struct thread *const thread = entry->thread;
+
+    linked_list_remove(&entry->node);
+    entry->is_queued = false;
+
+    thread_wakeup(thread);
+}
+
+uint64_t wait_queue_wake_all(struct wait_queue *const queue)
+{
+    uint64_t woken_number = 0;
+
+    const uint64_t flags = spinlock_lock_save(&queue->lock);
+
+    while (!linked_list_is_empty(&queue->waiters)) {
+        wake_first(queue);
+        ++woken_number;
+    }
+
+    spinlock_unlock_restore(&queue->lock, flags);
+
+    return woken_number;
+}
+
+int wait_queue_wake_one(struct wait_queue *const queue)
+{
+    int result = -1;
+
+    const uint64_t flags = spinlock_lock_save(&queue->lock);
+
+    if (!linked_list_is_empty(&queue->waiters)) {
+        wake_first(queue);
+        result = 0;
+    }
+
+    spinlock_unlock_restore(&queue->lock, flags);
+
+    return result;
+}
@@ -0,0 +1,49 @@
+#ifndef _TASK_WAIT_QUEUE_H
+#define _TASK_WAIT_QUEUE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <general/linked_list.h>
+#include <sync/spinlock.h>
+
+/** A condition a waiter sleeps on. It is checked under the lock of the queue, so keep it short. */
+typedef bool (*wait_queue_condition_t)(void *const context);
+
+/**
+ * Threads blocked until a condition holds.
+ *
+ * A waiter checks the condition and queues itself under the lock, and whoever makes the condition
+ * true wakes the queue after doing so, so a wakeup can't fall between the check and the block.
+ */
+struct wait_queue {
+    struct spinlock lock;
+    struct linked_list_node waiters;
+};
+
+void wait_queue_initialize(struct wait_queue *const queue);
+
+/**
+ * Block the current thread until `condition` holds.
+ *
+ * Call this from a thread. It returns right away if the condition already holds.
+ */
+void wait_queue_wait(struct wait_queue *const queue, wait_queue_condition_t condition,
+        void *const context);
+
+/**
+ * Wake every thread waiting on `queue`, which check their condition again.
+ *
+ * Safe to call from interrupt handlers and deferred work.
+ *
+ * @return The number of threads woken up.
+ */
+uint64_t wait_queue_wake_all(struct wait_queue *const queue);
+
+/**
+ * Wake the thread that has waited the longest.
+ *
+ * @return 0 if a thread was woken up, -1 if none was waiting.
+ */
+int wait_queue_wake_one(struct wait_queue *const queue);
+
+#endif
@@ -0,0 +1,128 @@
+#include <cpu/cpuid.h>
+#include <cpu/timestamp_counter.h>
+#include <drivers/timer/pit.h>
+#include <interrupts/control_register.h>
+
+#include "clock.h"
+
+/**
+ * The monotonic clock, driven by the time-stamp counter.
+ *
+ * Cycles are converted to nanoseconds with a multiplication and a shift instead of a division,
+ * so reading the clock costs little more than RDTSC itself:
+ *
+ * nanoseconds = (cycles * mult) >> CLOCK_SHIFT
+ *
+ * The product is computed in 128 bits so it doesn't overflow however long the system runs.
+ */
+
+/** Measure over 10 milliseconds of PIT ticks. */
+#define CLOCK_CALIBRATION_TICK_NUMBER (PIT_FREQUENCY / 100)
+/**
+ * Calibrate a few times and keep the shortest run.
+ *
+ * Anything stealing time from the loop, such as a system management interrupt or the host
+ * preempting the virtual processor, only makes a run longer.
+ */
+#define CLOCK_CALIBRATION_NUMBER      (5)
+
+struct clock_data {
+    uint64_t frequency;
+    uint64_t mult;
+    /** Multiplier back from nanoseconds to cycles. */
+    uint64_t cycle_mult;
+    uint64_t base_timestamp;
+    bool is_invariant;
+};
+
+static struct clock_data global_clock_data;
+
+static uint64_t measure_calibration_cycles(void)
+{
+    uint64_t minimum_cycles = UINT64_MAX;
+
+    for (uint64_t i = 0; i < CLOCK_CALIBRATION_NUMBER; ++i) {
+        const uint64_t flags = interrupts_save_and_disable();
+
+        const uint64_t start = timestamp_counter_read();
+        pit_wait(CLOCK_CALIBRATION_TICK_NUMBER);
+        const uint64_t end = timestamp_counter_read();
+
+        interrupts_restore(flags);
+
+        if (end - start < minimum_cycles) {
+            minimum_cycles = end - start;
+        }
+    }
+
+    return minimum_cycles;
+}
+
+int clock_initialize(void)
+{
+    const uint64_t cycles = measure_calibration_cycles();
+    if (cycles == 0) {
+        return -1;
+    }
+
+    global_clock_data.frequency = cycles * PIT_FREQUENCY / CLOCK_CALIBRATION_TICK_NUMBER;
+    global_clock_data.mult = (CLOCK_NANOSECONDS_PER_SECOND << CLOCK_SHIFT)
+        / global_clock_data.frequency;
+    global_clock_data.cycle_mult = clock_make_tick_mult(global_clock_data.frequency);
+    global_clock_data.is_invariant = cpuid_has_invariant_tsc();
+    global_clock_data.base_timestamp = timestamp_counter_read();
+
+    pit_stop();
+
+    return 0;
+}
+
+uint64_t clock_get_nanoseconds(void)
+{
+    return clock_convert_cycles_to_nanoseconds(
+            timestamp_counter_read() - global_clock_data.base_timestamp);
+}
+
+uint64_t clock_convert_cycles_to_nanoseconds(uint64_t cycles)
+{
+    return ((unsigned __int128)cycles * global_clock_data.mult) >> CLOCK_SHIFT;
+}
+
+uint64_t clock_convert_nanoseconds_to_cycles(uint64_t nanoseconds)
+{
+    return clock_convert_nanoseconds_to_ticks(nanoseconds, global_clock_data.cycle_mult);
+}
+
+uint64_t clock_make_tick_mult(uint64_t frequency)
+{
+    // Whole gigahertz and the rest apart, so that shifting either can't overflow 64 bits.
+    const uint64_t whole = frequency / CLOCK_NANOSECONDS_PER_SECOND;
+    const uint64_t rest = frequency % CLOCK_NANOSECONDS_PER_SECOND;
+
+    return (whole << CLOCK_SHIFT) + (rest << CLOCK_SHIFT) / CLOCK_NANOSECONDS_PER_SECOND;
+}
+
+uint64_t clock_convert_nanoseconds_to_timestamp(uint64_t nanoseconds)
+{
+    return global_clock_data.base_timestamp + clock_convert_nanoseconds_to_cycles(nanoseconds);
+}
+
+uint64_t clock_get_frequency(void)
+{
+    return global_clock_data.frequency;
+}
+
+bool clock_is_invariant(void)
+{
+    return global_clock_data.is_invariant;
+}
+
+void clock_delay(uint64_t nanoseconds)
+{
+    const uint64_t cycles = clock_convert_nanoseconds_to_cycles(nanoseconds);
+    const uint64_t end = timestamp_counter_read() + cycles;
+
+    while (timestamp_counter_read() < end) {
+        asm __volatile__("pause");
+    }
+}
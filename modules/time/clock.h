@@ -0,0 +1,63 @@
+#ifndef _TIME_CLOCK_H
+#define _TIME_CLOCK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define CLOCK_NANOSECONDS_PER_SECOND      (1000000000ULL)
+#define CLOCK_NANOSECONDS_PER_MILLISECOND (1000000ULL)
+#define CLOCK_NANOSECONDS_PER_MICROSECOND (1000ULL)
+
+/** Fraction bits of the multipliers that convert between nanoseconds and ticks. */
+#define CLOCK_SHIFT (32)
+
+/**
+ * Calibrate the time-stamp counter against the PIT and start the monotonic clock.
+ *
+ * This also stops the periodic interrupt of the PIT, as nothing uses it.
+ *
+ * @return 0 on success, -1 if the calibration failed.
+ */
+int clock_initialize(void);
+
+/** Return nanoseconds elapsed since `clock_initialize`. */
+uint64_t clock_get_nanoseconds(void);
+
+uint64_t clock_convert_cycles_to_nanoseconds(uint64_t cycles);
+
+uint64_t clock_convert_nanoseconds_to_cycles(uint64_t nanoseconds);
+
+/** Return the time-stamp counter value at `nanoseconds` on the monotonic clock. */
+uint64_t clock_convert_nanoseconds_to_timestamp(uint64_t nanoseconds);
+
+/** Return the frequency of the time-stamp counter in Hz. */
+uint64_t clock_get_frequency(void);
+
+/**
+ * Return whether the time-stamp counter runs at a constant rate in every power state.
+ *
+ * The clock is still usable otherwise, but drifts when the processor changes its frequency.
+ */
+bool clock_is_invariant(void);
+
+/**
+ * Return the multiplier for `clock_convert_nanoseconds_to_ticks` of a counter running at
+ * `frequency` Hz.
+ */
+uint64_t clock_make_tick_mult(uint64_t frequency);
+
+/**
+ * Convert nanoseconds to ticks with a multiplication and a shift.
+ *
+ * The kernel isn't linked with libgcc, so a 128-bit division, which would call `__udivti3`, can't
+ * be used. A 128-bit multiplication and shift are single instructions.
+ */
+static inline uint64_t clock_convert_nanoseconds_to_ticks(uint64_t nanoseconds, uint64_t mult)
+{
+    return ((unsigned __int128)nanoseconds * mult) >> CLOCK_SHIFT;
+}
+
+/** Busy-wait for at least `nanoseconds`. */
+void clock_delay(uint64_t nanoseconds);
+
+#endif
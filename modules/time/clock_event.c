@@ -0,0 +1,189 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <cpu/cpuid.h>
+#include <cpu/local.h>
+#include <cpu/model_specific_register.h>
+#include <interrupts/control_register.h>
+#include <interrupts/handler.h>
+#include <interrupts/local_apic.h>
+
+#include "clock.h"
+#include "clock_event.h"
+
+/** Measure the local APIC timer over 10 milliseconds. */
+#define CLOCK_EVENT_CALIBRATION_DURATION (10 * CLOCK_NANOSECONDS_PER_MILLISECOND)
+
+#define CLOCK_EVENT_LOCAL_APIC_MAX_COUNT (0xFFFFFFFF)
+
+struct clock_event_cpu_data {
+    uint64_t deadline;
+    bool is_armed;
+};
+
+struct clock_event_data {
+    enum clock_event_mode mode;
+    /** Frequency of the local APIC timer in Hz. Used only in `CLOCK_EVENT_MODE_LOCAL_APIC`. */
+    uint64_t frequency;
+    /** Converts nanoseconds to timer counts. */
+    uint64_t mult;
+    clock_event_handler_t handler;
+    struct clock_event_cpu_data cpus[CPU_MAX_NUMBER];
+};
+
+static struct clock_event_data global_clock_event_data;
+
+static uint64_t calibrate_local_apic_timer(void)
+{
+    const uint64_t flags = interrupts_save_and_disable();
+
+    local_apic_timer_set_mode(LOCAL_APIC_TIMER_MODE_ONESHOT, true);
+
+    const uint64_t start = clock_get_nanoseconds();
+    local_apic_timer_set_count(CLOCK_EVENT_LOCAL_APIC_MAX_COUNT);
+    clock_delay(CLOCK_EVENT_CALIBRATION_DURATION);
+    const uint32_t count = local_apic_timer_get_count();
+    const uint64_t end = clock_get_nanoseconds();
+
+    local_apic_timer_set_count(0);
+
+    interrupts_restore(flags);
+
+    return (CLOCK_EVENT_LOCAL_APIC_MAX_COUNT - count) * CLOCK_NANOSECONDS_PER_SECOND
+        / (end - start);
+}
+
+static void program_local_apic_timer(uint64_t deadline)
+{
+    const uint64_t now = clock_get_nanoseconds();
+    const uint64_t delta = deadline > now ? deadline - now : 0;
+
+    uint64_t count = clock_convert_nanoseconds_to_ticks(delta, global_clock_event_data.mult);
+
+    /*
+     * A count of 0 stops the timer, so fire on the next tick instead. Deadlines too far away fire
+     * early and the interrupt handler programs the rest.
+     */
+    if (count == 0) {
+        count = 1;
+    }
+    if (count > CLOCK_EVENT_LOCAL_APIC_MAX_COUNT) {
+        count = CLOCK_EVENT_LOCAL_APIC_MAX_COUNT;
+    }
+
+    local_apic_timer_set_count(count);
+}
+
+static void program_hardware(uint64_t deadline)
+{
+    if (global_clock_event_data.mode == CLOCK_EVENT_MODE_TSC_DEADLINE) {
+        // A deadline in the past raises the interrupt immediately.
+        model_specific_register_write(MODEL_SPECIFIC_REGISTER_TSC_DEADLINE,
+                clock_convert_nanoseconds_to_timestamp(deadline));
+        return;
+    }
+
+    program_local_apic_timer(deadline);
+}
+
+static int handle_timer_interrupt(const struct interrupt_frame *const frame, void *const context)
+{
+    (void)frame;
+    (void)context;
+
+    struct clock_event_cpu_data *const cpu = &global_clock_event_data.cpus[cpu_local_index()];
+
+    // The event was canceled after the timer had already fired.
+    if (!cpu->is_armed) {
+        return INTERRUPT_HANDLED;
+    }
+
+    if (clock_get_nanoseconds() < cpu->deadline) {
+        program_hardware(cpu->deadline);
+        return INTERRUPT_HANDLED;
+    }
+
+    cpu->is_armed = false;
+
+    if (global_clock_event_data.handler != NULL) {
+        global_clock_event_data.handler();
+    }
+
+    return INTERRUPT_HANDLED;
+}
+
+/** Unmask the local APIC timer of the current processor in the mode of clock events. */
+static void set_timer_mode(void)
+{
+    if (global_clock_event_data.mode == CLOCK_EVENT_MODE_TSC_DEADLINE) {
+        local_apic_timer_set_mode(LOCAL_APIC_TIMER_MODE_TSC_DEADLINE, false);
+    } else {
+        local_apic_timer_set_mode(LOCAL_APIC_TIMER_MODE_ONESHOT, false);
+    }
+}
+
+int clock_event_initialize(void)
+{
+    global_clock_event_data.handler = NULL;
+    global_clock_event_data.frequency = 0;
+    global_clock_event_data.mult = 0;
+
+    for (uint64_t i = 0; i < CPU_MAX_NUMBER; ++i) {
+        global_clock_event_data.cpus[i].deadline = 0;
+        global_clock_event_data.cpus[i].is_armed = false;
+    }
+
+    if (cpuid_has_tsc_deadline()) {
+        global_clock_event_data.mode = CLOCK_EVENT_MODE_TSC_DEADLINE;
+    } else {
+        global_clock_event_data.mode = CLOCK_EVENT_MODE_LOCAL_APIC;
+        global_clock_event_data.frequency = calibrate_local_apic_timer();
+        global_clock_event_data.mult = clock_make_tick_mult(global_clock_event_data.frequency);
+    }
+
+    set_timer_mode();
+
+    return interrupt_register(LOCAL_APIC_TIMER_VECTOR, handle_timer_interrupt, NULL);
+}
+
+void clock_event_initialize_application_processor(void)
+{
+    set_timer_mode();
+}
+
+void clock_event_set_handler(clock_event_handler_t handler)
+{
+    global_clock_event_data.handler = handler;
+}
+
+void clock_event_program(uint64_t deadline)
+{
+    const uint64_t flags = interrupts_save_and_disable();
+
+    struct clock_event_cpu_data *const cpu = &global_clock_event_data.cpus[cpu_local_index()];
+    cpu->deadline = deadline;
+    cpu->is_armed = true;
+
+    program_hardware(deadline);
+
+    interrupts_restore(flags);
+}
+
+void clock_event_cancel(void)
+{
+    const uint64_t flags = interrupts_save_and_disable();
+
+    global_clock_event_data.cpus[cpu_local_index()].is_armed = false;
+
+    if (global_clock_event_data.mode == CLOCK_EVENT_MODE_TSC_DEADLINE) {
+        model_specific_register_write(MODEL_SPECIFIC_REGISTER_TSC_DEADLINE, 0);
+    } else {
+        local_apic_timer_set_count(0);
+    }
+
+    interrupts_restore(flags);
+}
+
+enum clock_event_mode clock_event_get_mode(void)
+{
+    return global_clock_event_data.mode;
+}
@@ -0,0 +1,53 @@
+#ifndef _TIME_CLOCK_EVENT_H
+#define _TIME_CLOCK_EVENT_H
+
+#include <stdint.h>
+
+enum clock_event_mode {
+    CLOCK_EVENT_MODE_LOCAL_APIC,
+    CLOCK_EVENT_MODE_TSC_DEADLINE
+};
+
+/**
+ * A function called on the expiry of a clock event.
+ *
+ * It runs in the interrupt context with interrupts disabled, on the processor that programmed the
+ * event.
+ */
+typedef void (*clock_event_handler_t)(void);
+
+/**
+ * Set up one-shot clock events on the local APIC timer.
+ *
+ * The TSC-deadline mode is used if the processor supports it. Otherwise the local APIC timer is
+ * calibrated against the monotonic clock and programmed with relative counts.
+ *
+ * Call this after `clock_initialize`.
+ *
+ * @return 0 on success, -1 if the timer interrupt can't be registered.
+ */
+int clock_event_initialize(void);
+
+/**
+ * Set the local APIC timer of an application processor in the mode chosen by
+ * `clock_event_initialize`.
+ *
+ * The local APIC timers of all processors are assumed to run at the same frequency.
+ */
+void clock_event_initialize_application_processor(void);
+
+void clock_event_set_handler(clock_event_handler_t handler);
+
+/**
+ * Raise a clock event on the current processor when the monotonic clock reaches `deadline`.
+ *
+ * This replaces the event previously programmed. The handler is called right away, from the
+ * interrupt, if `deadline` has already passed.
+ */
+void clock_event_program(uint64_t deadline);
+
+void clock_event_cancel(void);
+
+enum clock_event_mode clock_event_get_mode(void);
+
+#endif
@@ -0,0 +1,448 @@
+#include <stddef.h>
+#include <cpu/local.h>
+#include <interrupts/control_register.h>
+#include <kernel/idle.h>
+#include <sync/spinlock.h>
+
+#include "clock.h"
+#include "clock_event.h"
+#include "timer.h"
+
+/**
+ * Software timers on top of the one-shot clock events.
+ *
+ * Each processor keeps its pending timers in a hierarchical timing wheel. The wheel counts time
+ * in ticks of `TIMER_WHEEL_TICK_SHIFT` bits of nanoseconds. Level 0 has a slot for each of the
+ * next `TIMER_WHEEL_SLOT_NUMBER` ticks, and every level above has slots as long as a whole
+ * rotation of the level below. A timer goes to the lowest level whose range reaches its deadline,
+ * so adding and canceling take constant time. Whenever level 0 starts a new rotation, the next
+ * slot of level 1 is cascaded down, which in turn cascades level 2 when level 1 wraps, and so on.
+ *
+ * Timers are still run at their exact deadline rather than at the tick. Expired timers are taken
+ * out of the wheel in one pass and run as a batch. The clock event is only programmed for the
+ * earliest deadline, and canceled when none is left, so an idle processor isn't woken up by a
+ * periodic tick.
+ *
+ * The wheel is locked because another processor may cancel a timer in it. Callbacks run without
+ * the lock, so they may add and cancel timers.
+ */
+
+#define TIMER_WHEEL_TICK_SHIFT   (16)
+#define TIMER_WHEEL_LEVEL_BITS   (6)
+#define TIMER_WHEEL_SLOT_NUMBER  (1 << TIMER_WHEEL_LEVEL_BITS)
+#define TIMER_WHEEL_SLOT_MASK    (TIMER_WHEEL_SLOT_NUMBER - 1)
+/** 6 levels of 64 slots of 65.5 us reach 52 days. Timers further away wait in the last level. */
+#define TIMER_WHEEL_LEVEL_NUMBER (6)
+#define TIMER_WHEEL_MAX_TICKS    ((1ULL << (TIMER_WHEEL_LEVEL_BITS * TIMER_WHEEL_LEVEL_NUMBER)) - 1)
+
+/** `timer->slot` of a timer taken out of the wheel to be run. */
+#define TIMER_SLOT_EXPIRED (0xFFFF)
+
+struct timer_cpu_data {
+    struct spinlock lock;
+    /** The tick the wheel has been advanced to. Slots of earlier ticks are empty. */
+    uint64_t current_tick;
+    uint64_t pending_number;
+    /** The deadline the clock event is programmed for. */
+    uint64_t next_deadline;
+    /** A bit is set for every slot that is not empty. */
+    uint64_t slot_bitmaps[TIMER_WHEEL_LEVEL_NUMBER];
+    struct linked_list_node slots[TIMER_WHEEL_LEVEL_NUMBER][TIMER_WHEEL_SLOT_NUMBER];
+    /** Timers taken out of the wheel by the clock event and not run yet. */
+    struct linked_list_node expired_timers;
+    uint64_t expired_number;
+    uint64_t batch_number;
+} __attribute__((aligned(64)));
+
+static struct timer_cpu_data global_timer_cpu_data[CPU_MAX_NUMBER];
+
+static inline struct linked_list_node *get_slot(struct timer_cpu_data *const cpu, uint16_t slot)
+{
+    return &cpu->slots[slot / TIMER_WHEEL_SLOT_NUMBER][slot % TIMER_WHEEL_SLOT_NUMBER];
+}
+
+/** Return the index of the first bit set in `bitmap` from `start` on, wrapping around. */
+static inline uint64_t find_next_slot(uint64_t bitmap, uint64_t start)
+{
+    const uint64_t rotated = (bitmap >> start) | (start == 0 ? 0 : bitmap << (64 - start));
+
+    return (start + __builtin_ctzll(rotated)) & TIMER_WHEEL_SLOT_MASK;
+}
+
+/** Put `timer` in the slot its deadline falls in. Called with the lock held. */
+static void insert_timer(struct timer_cpu_data *const cpu, struct timer *const timer)
+{
+    uint64_t tick = timer->deadline >> TIMER_WHEEL_TICK_SHIFT;
+
+    // Timers already due wait in the current slot, which is checked on the next event.
+    if (tick < cpu->current_tick) {
+        tick = cpu->current_tick;
+    }
+    if (tick - cpu->current_tick > TIMER_WHEEL_MAX_TICKS) {
+        tick = cpu->current_tick + TIMER_WHEEL_MAX_TICKS;
+    }
+
+    const uint64_t delta = tick - cpu->current_tick;
+    uint64_t level = 0;
+
+    while (level < TIMER_WHEEL_LEVEL_NUMBER - 1
+            && delta >= 1ULL << (TIMER_WHEEL_LEVEL_BITS * (level + 1))) {
+        ++level;
+    }
+
+    const uint64_t index = (tick >> (TIMER_WHEEL_LEVEL_BITS * level)) & TIMER_WHEEL_SLOT_MASK;
+
+    timer->slot = (uint16_t)(level * TIMER_WHEEL_SLOT_NUMBER + index);
+    linked_list_append(&cpu->slots[level][index], &timer->node);
+    cpu->slot_bitmaps[level] |= 1ULL << index;
+}
+
+/** Take a pending timer out of its slot. Called with the lock held. */
+static void unlink_timer(struct timer_cpu_data *const cpu, struct timer *const timer)
+{
+    linked_list_remove(&timer->node);
+
+    if (timer->slot == TIMER_SLOT_EXPIRED) {
+        return;
+    }
+
+    --cpu->pending_number;
+
+    if (linked_list_is_empty(get_slot(cpu, timer->slot))) {
+        cpu->slot_bitmaps[timer->slot / TIMER_WHEEL_SLOT_NUMBER] &=
+            ~(1ULL << (timer->slot % TIMER_WHEEL_SLOT_NUMBER));
+    }
+}
+
+/** Spread the slots of the levels above over the levels below, as level 0 wrapped around. */
+static void cascade(struct timer_cpu_data *const cpu)
+{
+    for (uint64_t level = 1; level < TIMER_WHEEL_LEVEL_NUMBER; ++level) {
+        const uint64_t index =
+            (cpu->current_tick >> (TIMER_WHEEL_LEVEL_BITS * level)) & TIMER_WHEEL_SLOT_MASK;
+        struct linked_list_node *const slot = &cpu->slots[level][index];
+
+        while (!linked_list_is_empty(slot)) {
+            struct timer *const timer = container_of(slot->next, struct timer, node);
+
+            linked_list_remove(&timer->node);
+            insert_timer(cpu, timer);
+        }
+
+        cpu->slot_bitmaps[level] &= ~(1ULL << index);
+
+        if (index != 0) {
+            break;
+        }
+    }
+}
+
+/** Move the timers of the current slot due by `now` to the expired list. */
+static void expire_slot(struct timer_cpu_data *const cpu, uint64_t now)
+{
+    const uint64_t index = cpu->current_tick & TIMER_WHEEL_SLOT_MASK;
+    struct linked_list_node *const slot = &cpu->slots[0][index];
+    struct linked_list_node *cursor = slot->next;
+
+    while (cursor != slot) {
+        struct timer *const timer = container_of(cursor, struct timer, node);
+        cursor = cursor->next;
+
+        if (timer->deadline > now) {
+            continue;
+        }
+
+        unlink_timer(cpu, timer);
+        timer->slot = TIMER_SLOT_EXPIRED;
+        linked_list_append(&cpu->expired_timers, &timer->node);
+    }
+}
+
+/**
+ * Return the first tick after the current one where a slot of `level` is due, expired for level 0
+ * and cascaded for the levels above, or `UINT64_MAX` if the level is empty.
+ */
+static uint64_t find_next_slot_tick(const struct timer_cpu_data *const cpu, uint64_t level)
+{
+    if (cpu->slot_bitmaps[level] == 0) {
+        return UINT64_MAX;
+    }
+
+    const uint64_t shift = TIMER_WHEEL_LEVEL_BITS * level;
+    const uint64_t current_index = (cpu->current_tick >> shift) & TIMER_WHEEL_SLOT_MASK;
+    const uint64_t index = find_next_slot(cpu->slot_bitmaps[level],
+            (current_index + 1) & TIMER_WHEEL_SLOT_MASK);
+
+    // The current slot itself is either done already or a whole rotation ahead.
+    uint64_t distance = (index - current_index) & TIMER_WHEEL_SLOT_MASK;
+    if (distance == 0) {
+        distance = TIMER_WHEEL_SLOT_NUMBER;
+    }
+
+    return ((cpu->current_tick >> shift) + distance) << shift;
+}
+
+/**
+ * Advance the wheel to `now`, collecting the timers due.
+ *
+ * The wheel jumps from one slot in use to the next, looking them up in the bitmaps of every level,
+ * so catching up after a long idle time costs a step per slot in use rather than per tick. Slots
+ * cascaded on the way are empty, so skipping their cascade changes nothing. Called with the lock
+ * held.
+ */
+static void advance_wheel(struct timer_cpu_data *const cpu, uint64_t now)
+{
+    const uint64_t now_tick = now >> TIMER_WHEEL_TICK_SHIFT;
+
+    if (cpu->pending_number == 0) {
+        if (now_tick > cpu->current_tick) {
+            cpu->current_tick = now_tick;
+        }
+        return;
+    }
+
+    while (1) {
+        expire_slot(cpu, now);
+
+        if (cpu->current_tick >= now_tick) {
+            break;
+        }
+
+        uint64_t next_tick = now_tick;
+
+        for (uint64_t level = 0; level < TIMER_WHEEL_LEVEL_NUMBER; ++level) {
+            const uint64_t tick = find_next_slot_tick(cpu, level);
+
+            if (tick < next_tick) {
+                next_tick = tick;
+            }
+        }
+
+        cpu->current_tick = next_tick;
+
+        if ((cpu->current_tick & TIMER_WHEEL_SLOT_MASK) == 0) {
+            cascade(cpu);
+        }
+    }
+}
+
+/**
+ * Return the earliest deadline in the wheel, or `UINT64_MAX` if it's empty.
+ *
+ * Slots of a level cover increasing time from the current one on, so only the first slot in use
+ * of each level has to be looked into.
+ */
+static uint64_t find_next_deadline(struct timer_cpu_data *const cpu)
+{
+    uint64_t next_deadline = UINT64_MAX;
+
+    for (uint64_t level = 0; level < TIMER_WHEEL_LEVEL_NUMBER; ++level) {
+        if (cpu->slot_bitmaps[level] == 0) {
+            continue;
+        }
+
+        // The current slot of a higher level was cascaded already. What is there is a lap ahead.
+        const uint64_t current_index =
+            (cpu->current_tick >> (TIMER_WHEEL_LEVEL_BITS * level)) & TIMER_WHEEL_SLOT_MASK;
+        const uint64_t start = level == 0
+            ? current_index : (current_index + 1) & TIMER_WHEEL_SLOT_MASK;
+        const uint64_t index = find_next_slot(cpu->slot_bitmaps[level], start);
+
+        struct linked_list_node *cursor = NULL;
+        linked_list_for_each_node(cursor, &cpu->slots[level][index]) {
+            const uint64_t deadline = container_of(cursor, struct timer, node)->deadline;
+
+            if (deadline < next_deadline) {
+                next_deadline = deadline;
+            }
+        }
+    }
+
+    return next_deadline;
+}
+
+static void program_next_event(struct timer_cpu_data *const cpu)
+{
+    cpu->next_deadline = find_next_deadline(cpu);
+
+    if (cpu->next_deadline == UINT64_MAX) {
+        clock_event_cancel();
+        return;
+    }
+
+    clock_event_program(cpu->next_deadline);
+}
+
+static void handle_clock_event(void)
+{
+    struct timer_cpu_data *const cpu = &global_timer_cpu_data[cpu_local_index()];
+    const uint64_t now = clock_get_nanoseconds();
+
+    spinlock_lock(&cpu->lock);
+
+    advance_wheel(cpu, now);
+
+    if (!linked_list_is_empty(&cpu->expired_timers)) {
+        ++cpu->batch_number;
+    }
+
+    /*
+     * Expired timers stay pending until their callback is called, so they can still be canceled.
+     * Timers added by the callbacks go to the wheel and only run on a later event.
+     */
+    while (!linked_list_is_empty(&cpu->expired_timers)) {
+        struct timer *const timer = container_of(cpu->expired_timers.next, struct timer, node);
+
+        linked_list_remove(&timer->node);
+        timer->is_pending = false;
+        ++cpu->expired_number;
+
+        spinlock_unlock(&cpu->lock);
+        timer->function(timer->data);
+        spinlock_lock(&cpu->lock);
+    }
+
+    program_next_event(cpu);
+
+    spinlock_unlock(&cpu->lock);
+}
+
+void timer_initialize(void)
+{
+    for (uint64_t i = 0; i < CPU_MAX_NUMBER; ++i) {
+        struct timer_cpu_data *const cpu = &global_timer_cpu_data[i];
+
+        spinlock_initialize(&cpu->lock);
+        cpu->current_tick = clock_get_nanoseconds() >> TIMER_WHEEL_TICK_SHIFT;
+        cpu->pending_number = 0;
+        cpu->next_deadline = UINT64_MAX;
+
+        for (uint64_t level = 0; level < TIMER_WHEEL_LEVEL_NUMBER; ++level) {
+            cpu->slot_bitmaps[level] = 0;
+
+            for (uint64_t index = 0; index < TIMER_WHEEL_SLOT_NUMBER; ++index) {
+                linked_list_initialize(&cpu->slots[level][index]);
+            }
+        }
+
+        linked_list_initialize(&cpu->expired_timers);
+        cpu->expired_number = 0;
+        cpu->batch_number = 0;
+    }
+
+    clock_event_set_handler(handle_clock_event);
+}
+
+void timer_setup(struct timer *const timer, timer_function_t function, uint64_t data)
+{
+    timer->deadline = 0;
+    timer->function = function;
+    timer->data = data;
+    timer->cpu_index = 0;
+    timer->slot = 0;
+    timer->is_pending = false;
+}
+
+/** Take a pending timer out of the list it's in, which may be of another processor. */
+static int remove_timer(struct timer *const timer)
+{
+    struct timer_cpu_data *const cpu = &global_timer_cpu_data[timer->cpu_index];
+
+    spinlock_lock(&cpu->lock);
+
+    if (!timer->is_pending) {
+        spinlock_unlock(&cpu->lock);
+        return -1;
+    }
+
+    unlink_timer(cpu, timer);
+    timer->is_pending = false;
+
+    // The clock event is left as it is. If it was for this timer, it fires for nothing.
+    spinlock_unlock(&cpu->lock);
+
+    return 0;
+}
+
+void timer_add(struct timer *const timer, uint64_t deadline)
+{
+    const uint64_t flags = interrupts_save_and_disable();
+
+    remove_timer(timer);
+
+    struct timer_cpu_data *const cpu = &global_timer_cpu_data[cpu_local_index()];
+
+    spinlock_lock(&cpu->lock);
+
+    // An empty wheel isn't advanced, so it catches up before the new timer is placed.
+    if (cpu->pending_number == 0) {
+        advance_wheel(cpu, clock_get_nanoseconds());
+    }
+
+    timer->deadline = deadline;
+    timer->cpu_index = cpu_local_index();
+    timer->is_pending = true;
+
+    // Timers in the same slot expire in the order they were added.
+    insert_timer(cpu, timer);
+    ++cpu->pending_number;
+
+    if (deadline < cpu->next_deadline) {
+        cpu->next_deadline = deadline;
+        clock_event_program(deadline);
+    }
+
+    spinlock_unlock(&cpu->lock);
+
+    interrupts_restore(flags);
+}
+
+int timer_cancel(struct timer *const timer)
+{
+    const uint64_t flags = interrupts_save_and_disable();
+    const int result = remove_timer(timer);
+    interrupts_restore(flags);
+
+    return result;
+}
+
+uint64_t timer_get_next_deadline(uint32_t cpu_index)
+{
+    struct timer_cpu_data *const cpu = &global_timer_cpu_data[cpu_index];
+
+    const uint64_t flags = spinlock_lock_save(&cpu->lock);
+    const uint64_t next_deadline = find_next_deadline(cpu);
+    spinlock_unlock_restore(&cpu->lock, flags);
+
+    return next_deadline;
+}
+
+void timer_get_statistics(uint32_t cpu_index, struct timer_statistics *const out)
+{
+    const struct timer_cpu_data *const cpu = &global_timer_cpu_data[cpu_index];
+
+    out->pending_number = cpu->pending_number;
+    out->expired_number = cpu->expired_number;
+    out->batch_number = cpu->batch_number;
+}
+
+static void wake_sleeper(uint64_t data)
+{
+    *(volatile bool *)data = true;
+}
+
+static bool has_woken_up(void *const context)
+{
+    return *(volatile bool *)context;
+}
+
+void timer_sleep(uint64_t nanoseconds)
+{
+    volatile bool is_expired = false;
+    struct timer timer;
+
+    timer_setup(&timer, wake_sleeper, (uint64_t)&is_expired);
+    timer_add(&timer, clock_get_nanoseconds() + nanoseconds);
+
+    idle_wait_until(has_woken_up, (void *)&is_expired);
+}
@@ -0,0 +1,72 @@
+#ifndef _TIME_TIMER_H
+#define _TIME_TIMER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <general/linked_list.h>
+
+/**
+ * A function called when a timer expires.
+ *
+ * It runs in the interrupt context with interrupts disabled, on the processor that added the timer.
+ * It may add timers, including the one that just expired.
+ */
+typedef void (*timer_function_t)(uint64_t data);
+
+struct timer {
+    struct linked_list_node node;
+    uint64_t deadline;
+    timer_function_t function;
+    uint64_t data;
+    uint32_t cpu_index;
+    /** The slot of the timing wheel the timer is in. */
+    uint16_t slot;
+    bool is_pending;
+};
+
+struct timer_statistics {
+    uint64_t pending_number;
+    uint64_t expired_number;
+    /** Number of clock events that ran timers. */
+    uint64_t batch_number;
+};
+
+/**
+ * Start dispatching timers from clock events.
+ *
+ * Call this after `clock_event_initialize`.
+ */
+void timer_initialize(void);
+
+void timer_setup(struct timer *const timer, timer_function_t function, uint64_t data);
+
+/**
+ * Run the timer on the current processor when the monotonic clock reaches `deadline`.
+ *
+ * A pending timer is moved to the new deadline.
+ */
+void timer_add(struct timer *const timer, uint64_t deadline);
+
+/**
+ * Cancel a timer, which may be pending on another processor.
+ *
+ * A callback already running on another processor is not waited for.
+ *
+ * @return 0 if the timer was pending, -1 if it had already expired or was never added.
+ */
+int timer_cancel(struct timer *const timer);
+
+/**
+ * Return the earliest deadline of the timers pending on the processor `cpu_index`, or
+ * `UINT64_MAX` if there is none.
+ *
+ * The clock event is programmed for it, so the processor can sleep until then.
+ */
+uint64_t timer_get_next_deadline(uint32_t cpu_index);
+
+void timer_get_statistics(uint32_t cpu_index, struct timer_statistics *const out);
+
+/** Block the caller for at least `nanoseconds`, sleeping the processor in the meantime. */
+void timer_sleep(uint64_t nanoseconds);
+
+#endif
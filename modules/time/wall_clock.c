@@ -0,0 +1,139 @@
+#include <stddef.h>
+#include <drivers/rtc/rtc.h>
+
+#include "clock.h"
+#include "wall_clock.h"
+
+#define WALL_CLOCK_SECONDS_PER_DAY (86400)
+
+/**
+ * The wall clock is the monotonic clock shifted by `offset`, the wall clock time when the
+ * monotonic clock started. Reading it costs one RDTSC and a few arithmetic operations.
+ */
+struct wall_clock_data {
+    volatile uint64_t offset;
+    volatile bool is_synchronized;
+};
+
+static struct wall_clock_data global_wall_clock_data;
+
+/**
+ * Count days from 1970-01-01 to the date in the proleptic Gregorian calendar.
+ *
+ * Years are shifted to start on March so the leap day is the last day of a year. Then every 400
+ * years repeat the same 146097 days.
+ */
+static int64_t convert_date_to_days(int64_t year, uint64_t month, uint64_t day)
+{
+    year -= month <= 2;
+    const int64_t era = (year >= 0 ? year : year - 399) / 400;
+    const uint64_t year_of_era = year - era * 400;
+    const uint64_t day_of_year = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    const uint64_t day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100
+        + day_of_year;
+
+    return era * 146097 + (int64_t)day_of_era - 719468;
+}
+
+static void convert_days_to_date(int64_t days, struct wall_clock_date *const out)
+{
+    days += 719468;
+    const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    const uint64_t day_of_era = days - era * 146097;
+    const uint64_t year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524
+            - day_of_era / 146096) / 365;
+    const uint64_t day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4
+            - year_of_era / 100);
+    const uint64_t shifted_month = (5 * day_of_year + 2) / 153;
+    const uint64_t month = shifted_month < 10 ? shifted_month + 3 : shifted_month - 9;
+
+    out->year = (int64_t)year_of_era + era * 400 + (month <= 2);
+    out->month = month;
+    out->day = day_of_year - (153 * shifted_month + 2) / 5 + 1;
+}
+
+static int read_rtc_nanoseconds(uint64_t *const out)
+{
+    struct rtc_time time;
+
+    if (rtc_read(&time) != 0) {
+        return -1;
+    }
+
+    const int64_t days = convert_date_to_days(time.year, time.month, time.day);
+    const uint64_t seconds = days * WALL_CLOCK_SECONDS_PER_DAY + time.hour * 3600
+        + time.minute * 60 + time.second;
+
+    *out = seconds * CLOCK_NANOSECONDS_PER_SECOND;
+
+    return 0;
+}
+
+static void handle_rtc_update(void)
+{
+    uint64_t nanoseconds;
+
+    if (read_rtc_nanoseconds(&nanoseconds) == 0) {
+        global_wall_clock_data.offset = nanoseconds - clock_get_nanoseconds();
+        global_wall_clock_data.is_synchronized = true;
+    }
+
+    rtc_set_update_handler(NULL);
+}
+
+int wall_clock_initialize(void)
+{
+    uint64_t nanoseconds;
+
+    // Without the RTC, the clock counts from 1970-01-01 when the monotonic clock started.
+    global_wall_clock_data.offset = 0;
+    global_wall_clock_data.is_synchronized = false;
+
+    if (rtc_initialize() != 0) {
+        return -1;
+    }
+
+    const int result = read_rtc_nanoseconds(&nanoseconds);
+    if (result == 0) {
+        global_wall_clock_data.offset = nanoseconds - clock_get_nanoseconds();
+    }
+
+    // A failed read may be followed by good ones, so the clock is still set on the next update.
+    wall_clock_synchronize();
+
+    return result;
+}
+
+uint64_t wall_clock_get_nanoseconds(void)
+{
+    return global_wall_clock_data.offset + clock_get_nanoseconds();
+}
+
+void wall_clock_get_date(struct wall_clock_date *const out)
+{
+    wall_clock_convert_to_date(wall_clock_get_nanoseconds(), out);
+}
+
+void wall_clock_convert_to_date(uint64_t nanoseconds, struct wall_clock_date *const out)
+{
+    const uint64_t seconds = nanoseconds / CLOCK_NANOSECONDS_PER_SECOND;
+    const uint64_t second_of_day = seconds % WALL_CLOCK_SECONDS_PER_DAY;
+
+    convert_days_to_date(seconds / WALL_CLOCK_SECONDS_PER_DAY, out);
+
+    out->hour = second_of_day / 3600;
+    out->minute = second_of_day % 3600 / 60;
+    out->second = second_of_day % 60;
+    out->nanosecond = nanoseconds % CLOCK_NANOSECONDS_PER_SECOND;
+}
+
+void wall_clock_synchronize(void)
+{
+    global_wall_clock_data.is_synchronized = false;
+    rtc_set_update_handler(handle_rtc_update);
+}
+
+bool wall_clock_is_synchronized(void)
+{
+    return global_wall_clock_data.is_synchronized;
+}
@@ -0,0 +1,45 @@
+#ifndef _TIME_WALL_CLOCK_H
+#define _TIME_WALL_CLOCK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+struct wall_clock_date {
+    uint16_t year;
+    uint8_t month;
+    uint8_t day;
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t second;
+    uint32_t nanosecond;
+};
+
+/**
+ * Read the RTC and start the wall clock.
+ *
+ * The RTC only counts seconds, so the clock is refined on the next update of the RTC, which
+ * marks the exact start of a second. Call this after `clock_initialize`.
+ *
+ * @return 0 on success, -1 if the RTC can't be read. The clock still runs then, unsynchronized
+ *         and counting from 1970, and may be set on a later update of the RTC.
+ */
+int wall_clock_initialize(void);
+
+/**
+ * Return nanoseconds since 1970-01-01 00:00:00 UTC.
+ *
+ * This only reads the monotonic clock and adds an offset. The RTC is not accessed.
+ */
+uint64_t wall_clock_get_nanoseconds(void);
+
+void wall_clock_get_date(struct wall_clock_date *const out);
+
+void wall_clock_convert_to_date(uint64_t nanoseconds, struct wall_clock_date *const out);
+
+/** Read the RTC again on its next update. */
+void wall_clock_synchronize(void);
+
+/** Return whether the clock has been aligned to an update of the RTC. */
+bool wall_clock_is_synchronized(void);
+
+#endif
@@ -113,7 +113,8 @@ static EFI_STATUS get_graphic_frame_buffer_data(const EFI_GRAPHICS_OUTPUT_PROTOC
 {
     /* Unsupported pixel format. */
     if (graphics_output->Mode->Info->PixelFormat != PixelRedGreenBlueReserved8BitPerColor
-            && graphics_output->Mode->Info->PixelFormat != PixelBlueGreenRedReserved8BitPerColor) {
+            && graphics_output->Mode->Info->PixelFormat != PixelBlueGreenRedReserved8BitPerColor
+            && graphics_output->Mode->Info->PixelFormat != PixelBitMask) {
         return EFI_ABORTED;
     }
 
@@ -128,6 +129,7 @@ static EFI_STATUS get_graphic_frame_buffer_data(const EFI_GRAPHICS_OUTPUT_PROTOC
     buffer_data->width              = graphics_output->Mode->Info->HorizontalResolution;
     buffer_data->height             = graphics_output->Mode->Info->VerticalResolution;
     buffer_data->pixel_format       = graphics_output->Mode->Info->PixelFormat;
+    buffer_data->pixel_mask         = graphics_output->Mode->Info->PixelInformation;
     buffer_data->pixel_per_scanline = graphics_output->Mode->Info->PixelsPerScanLine;
 
     return EFI_SUCCESS;
@@ -316,6 +318,25 @@ static EFI_STATUS load_kernel_elf(struct boot_data *const boot_data,
     return 0;
 }
 
+/** Find the ACPI RSDP in the configuration table, preferring the ACPI 2.0 one. */
+static void get_acpi_rsdp_address(const EFI_SYSTEM_TABLE *const system_table,
+        struct boot_data *const boot_data)
+{
+    boot_data->acpi_rsdp_address = 0;
+
+    for (uint64_t i = 0; i < system_table->NumberOfTableEntries; ++i) {
+        EFI_CONFIGURATION_TABLE *const table = &system_table->ConfigurationTable[i];
+
+        if (CompareGuid(&table->VendorGuid, &Acpi20TableGuid) == 0) {
+            boot_data->acpi_rsdp_address = (address_t)table->VendorTable;
+            return;
+        }
+        if (CompareGuid(&table->VendorGuid, &AcpiTableGuid) == 0) {
+            boot_data->acpi_rsdp_address = (address_t)table->VendorTable;
+        }
+    }
+}
+
 static EFI_STATUS get_memory_map_data(struct boot_data *const boot_data,
         EFI_MEMORY_DESCRIPTOR *const descriptor_buffer)
 {
@@ -411,6 +432,9 @@ EFI_STATUS EFIAPI efi_main(EFI_HANDLE image_handle, EFI_SYSTEM_TABLE *system_tab
     Print(L"PSF1 Font Info:\n");
     Print(L"GlyphSize: %d\n", boot_data.psf1_data.header.glyph_size);
 
+    get_acpi_rsdp_address(system_table, &boot_data);
+    Print(L"ACPI RSDP: 0x%X\n", boot_data.acpi_rsdp_address);
+
     Print(L"Get memory map of UEFI system.\n");
     status = get_memory_map_data(&boot_data, descriptor_buffer);
     if (EFI_ERROR(status)) {
@@ -1,17 +1,36 @@
+#include <acpi/acpi.h>
+#include <cpu/local.h>
 #include <debug/assert.h>
+#include <drivers/serial/uart.h>
 #include <interrupts/initialize.h>
 #include <kernel/boot_data.h>
+#include <kernel/idle.h>
 #include <kernel/shell.h>
+#include <kernel/smp.h>
 #include <memory/frame_allocator.h>
 #include <memory/page.h>
 #include <memory/segment.h>
+#include <sync/lock_statistics.h>
+#include <sync/rcu.h>
+#include <task/thread.h>
+#include <time/clock.h>
+#include <time/clock_event.h>
+#include <time/timer.h>
+#include <time/wall_clock.h>
 
 int _start(const struct boot_data boot_data)
 {
+    // Per-processor data is reached through the GS base, so this goes before anything else.
+    cpu_local_initialize(0);
+    lock_statistics_initialize();
+    rcu_initialize();
+
     struct pixel_color black = { .red = 0x00, .green = 0x00, .blue = 0x00 };
     struct pixel_color white = { .red = 0xFF, .green = 0xFF, .blue = 0xFF };
     console_initialize(boot_data.frame_buffer_data, boot_data.psf1_data, white, black, 1);
 
+    uart_initialize();
+
     int result = frame_allocator_initialize(boot_data.memory_map_data);
     assert(result == 0, "Failed to initialize the page frame allocator.");
 
@@ -20,9 +39,43 @@ int _start(const struct boot_data boot_data)
     assert(result == 0, "Failed to initialize the page.");
     page_load(kernel_page_data);
 
+    result = console_enable_back_buffer();
+    assert(result == 0, "Failed to allocate the console back buffer.");
+
+    // Only SMP needs ACPI tables. Without them, the kernel runs on the bootstrap processor.
+    result = acpi_initialize(boot_data.acpi_rsdp_address);
+    if (result != 0) {
+        uart_print_string("Failed to find ACPI tables.\n");
+    }
+
     segment_initialize();
 
-    interrupts_initialize();
+    result = interrupts_initialize();
+    assert(result == 0, "Failed to initialize interrupts.");
+
+    result = clock_initialize();
+    assert(result == 0, "Failed to calibrate the clock.");
+
+    result = clock_event_initialize();
+    assert(result == 0, "Failed to initialize clock events.");
+
+    timer_initialize();
+    idle_initialize();
+
+    result = thread_initialize();
+    assert(result == 0, "Failed to initialize threads.");
+
+    result = smp_initialize();
+    if (result != 0) {
+        uart_print_format("Failed to start application processors. Running on %u processors.\n",
+                smp_get_cpu_number());
+    }
+
+    // The wall clock is optional. `date` shows it isn't synchronized.
+    result = wall_clock_initialize();
+    if (result != 0) {
+        uart_print_string("Failed to read the real time clock.\n");
+    }
 
     shell_start();
 